@@ -0,0 +1,74 @@
+#pragma once
+#include <stdint.h>
+#include <zmk_naginata/mejiro_stroke.h>
+
+/*
+ * Per-half kana table
+ *
+ * A half stroke has 4 consonant, 4 vowel and 3 particle bits, so every
+ * possible half is precomputed at build time by scripts/mejiro_kana_gen.c
+ * into mejiro_kana_table.h (mejiro_kana_pool / mejiro_kana_halves). The
+ * firmware only indexes that table; the rules themselves are in
+ * src/mejiro_kana_rules.c and are compiled for the host generator only.
+ *
+ * The same header carries the kana -> romaji trie built from
+ * src/mejiro_roma_rules.c: mejiro_roma_nodes is indexed by the first kana
+ * code, and a node's edges (mejiro_roma_edges, ended by code 0) hold the
+ * two-kana entries that start with it (きゃ, ふぁ, ...).
+ */
+
+#define MEJIRO_KANA_HALVES (1u << MJ_HALF_BITS)
+
+/* the particle bits add a second sound (ん/つ/く/っ/ち/き/ー) after the kana */
+#define MEJIRO_KANA_EXTRA (1u << 0)
+/* the half ends in っ, which is carried over to the next stroke */
+#define MEJIRO_KANA_SOKUON (1u << 1)
+/* vowel + particle form an English sound (~as, ~ation, ...) */
+#define MEJIRO_KANA_ENGLISH (1u << 2)
+/* vowel + particle form a minor diphthong (~あう, ~おい, ...) */
+#define MEJIRO_KANA_MINOR (1u << 3)
+
+typedef struct {
+    uint16_t kana; /* offset into mejiro_kana_pool (kana codes, NUL-terminated) */
+    uint8_t flags;
+} mejiro_kana_entry_t;
+
+typedef struct {
+    uint16_t roma; /* offset into mejiro_roma_pool, 0 = no entry */
+    uint8_t edge;  /* first edge in mejiro_roma_edges, 0 = none */
+} mejiro_roma_node_t;
+
+typedef struct {
+    uint8_t code;  /* second kana code, 0 ends the list */
+    uint16_t roma; /* offset into mejiro_roma_pool */
+} mejiro_roma_edge_t;
+
+/* longest kana of one half, without the second sound, plus NUL */
+#define MEJIRO_KANA_MAX 32
+
+/* Host-side rules used by the generator. */
+void mejiro_kana_rules_init(void);
+/* Kana (UTF-8) of one half without the second sound; returns MEJIRO_KANA_* flags. */
+uint8_t mejiro_kana_rules_convert(uint16_t half, char *out);
+
+/* Host-side kana -> romaji rules (UTF-8, NULL-terminated). */
+typedef struct {
+    const char *kana;
+    const char *roma;
+} mejiro_roma_rule_t;
+
+extern const mejiro_roma_rule_t mejiro_roma_rules[];
+
+/* IMEs for mejiro_roma_ime_rules, selected by the generator's profile argument */
+#define MEJIRO_ROMA_MSIME (1u << 0)
+#define MEJIRO_ROMA_GOOGLE (1u << 1)
+#define MEJIRO_ROMA_MACOS (1u << 2)
+
+/* A spelling that the given IMEs accept and that replaces the rule above. */
+typedef struct {
+    uint8_t ime;
+    const char *kana;
+    const char *roma;
+} mejiro_roma_ime_rule_t;
+
+extern const mejiro_roma_ime_rule_t mejiro_roma_ime_rules[];
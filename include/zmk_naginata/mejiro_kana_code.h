@@ -0,0 +1,71 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <zmk_naginata/mejiro_sb.h>
+
+/*
+ * One-byte kana code
+ *
+ * The transform works on strings of these codes, one byte per mora, and
+ * only turns them into romaji (or other output) at the output edge.
+ *
+ *   0x00        end of string
+ *   0x01-0x7F   ASCII, as is
+ *   0x80-0xFF   1 rrrr ccc: row (gyou) and column (dan) of the kana
+ *
+ *   row  0 あ  あ い う え お ー 、 。
+ *   row  1 か  row 2 さ  row 3 た  row 4 な  row 5 は  row 6 ま
+ *   row  7 や  や ゃ ゆ ゅ よ ょ   (dan = column & ~1, small = column & 1)
+ *   row  8 ら
+ *   row  9 わ  わ ゐ ゔ ゑ を ん
+ *   row 10 が  row 11 ざ  row 12 だ  row 13 ば  row 14 ぱ
+ *   row 15 小  ぁ ぃ ぅ ぇ ぉ っ ゎ
+ *
+ * The word tables (mejiro_word.h) are generated with their strings already
+ * in these codes; only command strings are UTF-8 and encoded when appended.
+ */
+
+typedef uint8_t mejiro_kana_t;
+
+enum {
+    MK_ROW_A, MK_ROW_K, MK_ROW_S, MK_ROW_T, MK_ROW_N, MK_ROW_H, MK_ROW_M, MK_ROW_Y,
+    MK_ROW_R, MK_ROW_W, MK_ROW_G, MK_ROW_Z, MK_ROW_D, MK_ROW_B, MK_ROW_P, MK_ROW_SMALL,
+};
+
+enum { MK_DAN_A, MK_DAN_I, MK_DAN_U, MK_DAN_E, MK_DAN_O };
+
+#define MK_KANA(row, col) ((mejiro_kana_t)(0x80 | ((row) << 3) | (col)))
+#define MK_IS_KANA(c) (((c) & 0x80) != 0)
+#define MK_ROW(c) (((c) >> 3) & 0xF)
+#define MK_COL(c) ((c) & 0x7)
+
+#define MK_CHOON MK_KANA(MK_ROW_A, 5)    /* ー */
+#define MK_TOUTEN MK_KANA(MK_ROW_A, 6)   /* 、 */
+#define MK_KUTEN MK_KANA(MK_ROW_A, 7)    /* 。 */
+#define MK_NN MK_KANA(MK_ROW_W, 5)       /* ん */
+#define MK_SOKUON MK_KANA(MK_ROW_SMALL, 5) /* っ */
+
+/* dan of a kana in rows 0-14 (0 = a ... 4 = o) */
+static inline uint8_t mejiro_kana_dan(mejiro_kana_t c) {
+    return MK_ROW(c) == MK_ROW_Y ? (MK_COL(c) & ~1u) : MK_COL(c);
+}
+
+/* Decode one UTF-8 character at *p and advance past it. Characters without
+ * a code are skipped and return 0. */
+mejiro_kana_t mejiro_kana_from_utf8(const char **p);
+
+/* Encode a UTF-8 string; returns the code count. out is NUL-terminated. */
+size_t mejiro_kana_encode(const char *utf8, char *out, size_t out_sz);
+
+/* Unicode code point of a code (ASCII as is), 0 if none. */
+uint16_t mejiro_kana_codepoint(mejiro_kana_t c);
+
+/* Append a UTF-8 string (a command string) to a builder of kana codes. */
+static inline void mejiro_kana_append(mejiro_sb_t *sb, const char *utf8) {
+    while (*utf8 != '\0') {
+        const mejiro_kana_t c = mejiro_kana_from_utf8(&utf8);
+        if (c != 0) {
+            mejiro_sb_push(sb, (char)c);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Bounded string builder for the Mejiro transform path
+ *
+ * Wraps a caller-owned char buffer with its length and capacity, so appends
+ * do not rescan the string and never write past the buffer. The text is
+ * always NUL-terminated. The text is romaji or one-byte kana codes
+ * (mejiro_kana_code.h), so an append that does not fit is simply cut and
+ * sets `truncated`, which the caller can check once at the end instead of
+ * after every step.
+ */
+
+typedef struct {
+    char *buf;
+    uint16_t len;
+    uint16_t cap; /* buffer size, including the NUL */
+    bool truncated;
+} mejiro_sb_t;
+
+static inline void mejiro_sb_init(mejiro_sb_t *sb, char *buf, size_t cap) {
+    sb->buf = buf;
+    sb->len = 0;
+    sb->cap = (uint16_t)cap;
+    sb->truncated = false;
+    buf[0] = '\0';
+}
+
+static inline void mejiro_sb_clear(mejiro_sb_t *sb) {
+    sb->len = 0;
+    sb->buf[0] = '\0';
+}
+
+static inline void mejiro_sb_append_n(mejiro_sb_t *sb, const char *s, size_t n) {
+    const size_t room = (size_t)sb->cap - 1 - sb->len;
+    if (n > room) {
+        n = room;
+        sb->truncated = true;
+    }
+    memcpy(sb->buf + sb->len, s, n);
+    sb->len = (uint16_t)(sb->len + n);
+    sb->buf[sb->len] = '\0';
+}
+
+static inline void mejiro_sb_append(mejiro_sb_t *sb, const char *s) {
+    mejiro_sb_append_n(sb, s, strlen(s));
+}
+
+static inline void mejiro_sb_push(mejiro_sb_t *sb, char c) {
+    if (sb->len + 1 >= sb->cap) {
+        sb->truncated = true;
+        return;
+    }
+    sb->buf[sb->len++] = c;
+    sb->buf[sb->len] = '\0';
+}
+
+static inline void mejiro_sb_set(mejiro_sb_t *sb, const char *s) {
+    mejiro_sb_clear(sb);
+    mejiro_sb_append(sb, s);
+}
+
+static inline void mejiro_sb_truncate(mejiro_sb_t *sb, size_t len) {
+    if (len < sb->len) {
+        sb->len = (uint16_t)len;
+        sb->buf[len] = '\0';
+    }
+}
+
+static inline bool mejiro_sb_equals(const mejiro_sb_t *sb, const char *s) {
+    return strcmp(sb->buf, s) == 0;
+}
+
+static inline bool mejiro_sb_ends_with(const mejiro_sb_t *sb, const char *s) {
+    const size_t n = strlen(s);
+    return n <= sb->len && memcmp(sb->buf + sb->len - n, s, n) == 0;
+}
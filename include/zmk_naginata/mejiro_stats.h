@@ -0,0 +1,22 @@
+#pragma once
+#include <stdint.h>
+
+/* Runtime counters of the Mejiro stroke pipeline (read with mejiro_stats_get). */
+struct mejiro_stats {
+    /* stroke queue: most strokes waiting at once / strokes dropped because it was full */
+    uint16_t stroke_queue_high_water;
+    uint32_t stroke_queue_overflows;
+    /* transforms served from the speculative precompute / transformed on commit */
+    uint32_t speculation_hits;
+    uint32_t speculation_misses;
+    /* committed strokes replayed from the compiled stroke cache / compiled on commit */
+    uint32_t cache_hits;
+    uint32_t cache_misses;
+    /* keys sent for converted strokes, and the kana they typed (keys / kana per backend) */
+    uint16_t last_stroke_keys;
+    uint32_t keys_emitted;
+    uint32_t kana_emitted;
+};
+
+void mejiro_stats_get(struct mejiro_stats *out);
+void mejiro_stats_reset(void);
@@ -0,0 +1,39 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <zmk_naginata/mejiro_stroke.h>
+
+/*
+ * Steno protocol output
+ *
+ * With CONFIG_NAGINATA_MEJIRO_STENO the finalized chord is not converted on
+ * the keyboard; it is written as one steno packet to the UART chosen as
+ * zmk,naginata-steno (a USB CDC-ACM port, or the pty of native_sim) and
+ * Plover with Plover_Mejiro does the conversion.
+ *
+ * Each Mejiro key has a fixed steno key (the tables in src/mejiro_steno.c);
+ * set Plover's machine keymap to match. TX Bolt has 23 keys, so Mejiro's #
+ * is sent on the unused sixth bit of the last group, which stock Plover
+ * ignores: use Gemini PR when # strokes are needed.
+ *
+ * The encoder and decoder also build on the host (scripts/mejiro_steno_decode.c).
+ */
+
+enum mejiro_steno_protocol {
+    MEJIRO_STENO_GEMINIPR,
+    MEJIRO_STENO_TXBOLT,
+};
+
+/* longest packet: Gemini PR is 6 bytes, TX Bolt up to 4 groups plus the 0 terminator */
+#define MEJIRO_STENO_PACKET_MAX 6
+
+/* Encode one stroke; returns the packet length. */
+size_t mejiro_steno_encode(enum mejiro_steno_protocol protocol, mejiro_stroke_t stroke,
+                           uint8_t out[MEJIRO_STENO_PACKET_MAX]);
+
+/* Decode one packet (TX Bolt: the groups of one stroke, terminator optional). */
+mejiro_stroke_t mejiro_steno_decode(enum mejiro_steno_protocol protocol, const uint8_t *packet,
+                                    size_t len);
+
+/* Write one stroke to the steno UART; 0 or a negative errno. Firmware only. */
+int mejiro_steno_send(mejiro_stroke_t stroke);
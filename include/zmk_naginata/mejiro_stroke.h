@@ -0,0 +1,69 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Packed Mejiro stroke
+ *
+ * A stroke is two 11-bit halves plus the # and * flags:
+ *
+ *   bit  0- 3  left consonant  S T K N
+ *   bit  4- 7  left vowel      Y I A U
+ *   bit  8-10  left particle   n t k
+ *   bit 11     #
+ *   bit 12-22  right half, same layout
+ *   bit 23     *
+ *
+ * The transform, command, abbreviation and verb lookups all work on this
+ * code. The "STKNYIAUntk#-STKNYIAUntk*" string form is only for logs and
+ * for resolving the string keys of the tables once at init.
+ */
+
+typedef uint32_t mejiro_stroke_t;
+
+/* consonant field */
+#define MJ_S 0x1u
+#define MJ_T 0x2u
+#define MJ_K 0x4u
+#define MJ_N 0x8u
+
+/* vowel field */
+#define MJ_Y 0x1u
+#define MJ_I 0x2u
+#define MJ_A 0x4u
+#define MJ_U 0x8u
+
+/* particle field */
+#define MJ_PN 0x1u
+#define MJ_PT 0x2u
+#define MJ_PK 0x4u
+
+#define MJ_HALF_BITS 11
+#define MJ_HALF_MASK 0x7FFu
+#define MJ_RIGHT_SHIFT 12
+#define MJ_HASH (1u << 11)
+#define MJ_STAR (1u << 23)
+#define MJ_STROKE_ALL 0xFFFFFFu
+
+#define MJ_HALF(conso, vowel, particle) ((conso) | ((vowel) << 4) | ((particle) << 8))
+#define MJ_HALF_CONSO(h) ((h) & 0xFu)
+#define MJ_HALF_VOWEL(h) (((h) >> 4) & 0xFu)
+#define MJ_HALF_PARTICLE(h) (((h) >> 8) & 0x7u)
+/* consonant and vowel only */
+#define MJ_HALF_KANA_MASK 0xFFu
+
+#define MJ_STROKE(left, right) ((mejiro_stroke_t)(left) | ((mejiro_stroke_t)(right) << MJ_RIGHT_SHIFT))
+#define MJ_LEFT(s) ((s) & MJ_HALF_MASK)
+#define MJ_RIGHT(s) (((s) >> MJ_RIGHT_SHIFT) & MJ_HALF_MASK)
+
+/* longest string form plus NUL */
+#define MEJIRO_STROKE_STR_MAX 26
+
+/* Render "STKNYIAUntk#-STKNYIAUntk*" style text; returns its length. */
+size_t mejiro_stroke_to_string(mejiro_stroke_t stroke, char *out, size_t out_sz);
+
+/* Parse the string form; characters outside the stroke alphabet are ignored. */
+mejiro_stroke_t mejiro_stroke_from_string(const char *s);
+
+/* Parse one half without the hyphen ("IAU", "STKNYU", ...). */
+uint16_t mejiro_half_from_string(const char *s);
@@ -0,0 +1,108 @@
+#pragma once
+#include <stdint.h>
+#include <zmk_naginata/mejiro_stroke.h>
+
+/*
+ * Word tables of the transform
+ *
+ * Conjugation endings, the verb dictionary, auxiliaries, particles and
+ * abbreviations are written in UTF-8 in src/mejiro_word_rules.c (the *_rules
+ * tables below), which only the host generator links. scripts/mejiro_kana_gen.c
+ * writes each of them into mejiro_kana_table.h under the name without _rules,
+ * same type and layout, with every string turned into kana codes
+ * (mejiro_kana_code.h). The firmware appends those strings as they are.
+ *
+ * Tables without a fixed size end with an entry whose string is NULL.
+ */
+
+// QMK mejiro_verb.h 由来の型定義
+typedef enum {
+    VERB_TYPE_GODAN,
+    VERB_TYPE_KAMI,
+    VERB_TYPE_SIMO,
+    VERB_TYPE_SAHEN,
+    VERB_TYPE_KAHEN,
+    VERB_TYPE_SPECIAL
+} verb_type_t;
+
+typedef enum {
+    CONJ_NAI,
+    CONJ_SHIEKI,
+    CONJ_UKEMI,
+    CONJ_MASU,
+    CONJ_JISHO,
+    CONJ_TE_TA,
+    CONJ_IKOU,
+    CONJ_KATEI,
+    CONJ_KANOU,
+    CONJ_MEIREI,
+} conj_form_t;
+
+#define MEJIRO_CONJ_FORMS 10
+
+typedef struct {
+    const char *stroke; /* consonant+vowel of both halves, resolved to verb_dict_codes at init */
+    const char *stem;
+    char gyou;
+    verb_type_t type;
+} verb_entry_t;
+
+// 略語のマッピング（ストローク → 出力）
+typedef struct {
+    const char *stroke;
+    const char *output;
+} abbreviation_entry_t;
+
+// 一般略語の後の助詞の組み合わせ → 語尾
+typedef struct {
+    uint8_t left_particle;
+    uint8_t right_particle;
+    const char *output;
+} abbreviation_ending_t;
+
+// 補助動詞・助動詞マップ
+typedef struct {
+    uint8_t left_particle;
+    uint8_t right_particle;
+    int conj_form;        // 活用形
+    const char *suffix;   // 接尾辞
+} auxiliary_map_t;
+
+// 左側補助動詞マップ: [活用形, 補助動詞の語幹, 活用段, 活用行]
+typedef struct {
+    uint8_t particle;
+    int conj_form;
+    const char *stem;
+    int verb_type;  // 1=五段, 2=上一段, 3=下一段
+    char gyou;
+} left_auxiliary_info_t;
+
+// 右側助動詞マップ（右助詞コードで引く）
+typedef struct {
+    int conj_form;
+    const char *suffix;
+} right_auxiliary_t;
+
+/* Host-side word tables (UTF-8), used by the generator. */
+extern const abbreviation_entry_t mejiro_user_abbreviations_rules[];
+extern const abbreviation_entry_t mejiro_abstract_abbreviations_rules[];
+extern const abbreviation_entry_t mejiro_abstract_left_rules[];
+extern const abbreviation_entry_t mejiro_abstract_right_rules[];
+extern const abbreviation_ending_t mejiro_abstract_endings_rules[];
+
+extern const char *const mejiro_godan_conjugate_rules[10][MEJIRO_CONJ_FORMS];
+extern const char *const mejiro_kami_conjugate_rules[10][MEJIRO_CONJ_FORMS];
+extern const char *const mejiro_simo_conjugate_rules[12][MEJIRO_CONJ_FORMS];
+extern const char *const mejiro_sahen_conjugate_rules[MEJIRO_CONJ_FORMS];
+extern const char *const mejiro_kahen_conjugate_rules[MEJIRO_CONJ_FORMS];
+extern const char *const mejiro_iku_conjugate_rules[MEJIRO_CONJ_FORMS];
+extern const char *const mejiro_aru_conjugate_rules[MEJIRO_CONJ_FORMS];
+extern const verb_entry_t mejiro_verb_dict_rules[];
+
+extern const char *const mejiro_desu_conjugate_rules[8];
+extern const char *const mejiro_second_sound_rules[8];
+extern const auxiliary_map_t mejiro_auxiliary_exception_rules[];
+extern const left_auxiliary_info_t mejiro_left_auxiliary_rules[];
+extern const right_auxiliary_t mejiro_right_auxiliary_rules[8];
+extern const char *const mejiro_l_particle_rules[8];
+extern const char *const mejiro_r_particle_rules[8];
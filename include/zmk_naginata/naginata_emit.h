@@ -0,0 +1,96 @@
+#pragma once
+#include <zephyr/kernel.h>
+
+/*
+ * Paced key emitter
+ *
+ * Synthesized key events are queued here and raised from a delayable work
+ * item on the system work queue, the same thread that handles the physical
+ * keys, so behavior callbacks return immediately while the output drains at
+ * the configured pace. Events keep their queue order, and timestamps are
+ * assigned when each event is raised (monotonic, never behind the last
+ * physical key event).
+ *
+ * Each event carries a pace class instead of a delay. The class is turned
+ * into milliseconds when the event is raised, using the profile of the IME
+ * state at that moment (LANG1 = on, LANG2 = off, as seen on the event bus).
+ * The Unicode input classes do not depend on the IME and use fixed Kconfig
+ * delays (CONFIG_NAGINATA_UNICODE_*_DELAY_MS).
+ *
+ * Navigation and edit commands can use the priority lane instead. It keeps
+ * the order: its events never overtake the events queued before them and go
+ * out right after the last of those, skipping only the pace delay after it.
+ * They are not paced themselves.
+ *
+ * A producer on another thread waits while a lane is full. On the system work
+ * queue, which raises the events, a full lane is drained inline instead,
+ * without the pace delay: producers there that can wait check
+ * naginata_emit_reserve first.
+ *
+ * Runs of distinct plain keys share reports: presses stay one report each,
+ * in order, and their releases go out together (CONFIG_NAGINATA_EMIT_PACK_KEYS).
+ */
+
+enum naginata_pace {
+    NAGINATA_PACE_NONE = 0,
+    NAGINATA_PACE_INTRA_KANA, /* between keys of one kana */
+    NAGINATA_PACE_INTER_KANA, /* after a kana and other IME-sensitive boundaries */
+    NAGINATA_PACE_HEX_DIGIT,  /* between hex digits of a Unicode code point (fixed) */
+    NAGINATA_PACE_SESSION,    /* after opening/closing an OS input mode (fixed) */
+};
+
+struct naginata_pace_profile {
+    uint16_t intra_kana_ms;
+    uint16_t inter_kana_ms;
+};
+
+void naginata_emit_init(void);
+
+/* Record the timestamp of a physical key event; synthesized events never go behind it. */
+void naginata_emit_sync_timestamp(int64_t ts);
+
+void naginata_emit_press(uint32_t keycode);
+void naginata_emit_release(uint32_t keycode);
+
+/* press + release, then wait for the pace class before the next queued event */
+void naginata_emit_tap(uint32_t keycode, enum naginata_pace pace);
+
+/* tap that completes `kana` kana of converted text (the points undo can cut at) */
+void naginata_emit_tap_kana(uint32_t keycode, enum naginata_pace pace, uint8_t kana);
+
+/* wait for the pace class before the next queued event */
+void naginata_emit_pause(enum naginata_pace pace);
+
+/* Priority lane (non-text keys only): raised as soon as the events queued before it are out. */
+void naginata_emit_priority(uint32_t keycode, bool pressed);
+
+/*
+ * Undo of queued output: the events pushed between entry_begin and entry_end
+ * form one entry (one undo history entry). While they are still the newest
+ * events, cancel_entry drops the kana of the entry that have not started and
+ * returns how many it dropped; kana end only at naginata_emit_tap_kana taps, and
+ * one that is partly sent is finished. Releases of keys pressed before the cut are kept.
+ */
+void naginata_emit_entry_begin(void);
+void naginata_emit_entry_end(void);
+uint16_t naginata_emit_cancel_entry(void);
+
+/* Run work on the system work queue (serialized with the output and the physical keys). */
+void naginata_emit_submit(struct k_work *work);
+
+/*
+ * Whether the paced lane has room for `ops` more events. When it has not,
+ * `resume` is submitted once the emitter has made that much room, so a
+ * producer on the system work queue waits without blocking it. One waiter.
+ */
+bool naginata_emit_reserve(uint16_t ops, struct k_work *resume);
+
+void naginata_emit_set_profile(bool ime_on, const struct naginata_pace_profile *profile);
+void naginata_emit_get_profile(bool ime_on, struct naginata_pace_profile *profile);
+bool naginata_emit_ime_on(void);
+
+/* HID reports sent for synthesized keys since boot (packed releases count once). */
+uint32_t naginata_emit_report_count(void);
+
+/* Step one delay of the current IME state's profile; the result is saved to settings (debounced). */
+void naginata_emit_adjust_profile(enum naginata_pace pace, int delta_ms);
@@ -7,6 +7,8 @@ void return_to_kana_input(void);
 void press_compose_key(void);
 void release_compose_key(void);
 void input_unicode_hex(int, int, int, int);
+/* UTF-8 string through the OS Unicode input, one session per call where the OS allows */
+void input_unicode_string(const char *utf8);
 
 void ng_T(void);
 void ng_Y(void);
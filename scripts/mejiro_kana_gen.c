@@ -0,0 +1,366 @@
+/*
+ * Host tool: precompute the kana of every Mejiro half stroke.
+ *
+ *   mejiro_kana_gen <out.h> [hepburn|msime|google|macos]
+ *
+ * Builds with the host compiler together with src/mejiro_kana_rules.c,
+ * src/mejiro_roma_rules.c, src/mejiro_word_rules.c, src/mejiro_kana_code.c
+ * and src/mejiro_stroke.c (see CMakeLists.txt) and writes mejiro_kana_pool,
+ * mejiro_kana_halves, the mejiro_roma_* trie and the word tables
+ * (mejiro_word.h) for behavior_naginata.c. The kana pool and the strings of
+ * the word tables hold one-byte kana codes (mejiro_kana_code.h), not UTF-8.
+ * The optional profile picks the IME whose shorter spellings the trie uses.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zmk_naginata/mejiro_kana.h>
+#include <zmk_naginata/mejiro_kana_code.h>
+#include <zmk_naginata/mejiro_word.h>
+
+#define POOL_MAX 0x10000
+#define ROMA_EDGES_MAX 256
+
+typedef struct {
+    char buf[POOL_MAX];
+    size_t len;
+} pool_t;
+
+static pool_t kana_pool;
+static pool_t roma_pool;
+
+/* offset of s in the pool, appending it if it is not there yet */
+static uint16_t pool_intern(pool_t *pool, const char *s) {
+    const size_t len = strlen(s);
+    size_t off = 0;
+
+    while (off < pool->len) {
+        if (strcmp(&pool->buf[off], s) == 0) {
+            return (uint16_t)off;
+        }
+        off += strlen(&pool->buf[off]) + 1;
+    }
+    if (pool->len + len + 1 > POOL_MAX) {
+        fprintf(stderr, "mejiro_kana_gen: string pool overflow\n");
+        exit(1);
+    }
+    memcpy(&pool->buf[pool->len], s, len + 1);
+    pool->len += len + 1;
+    return (uint16_t)off;
+}
+
+static void write_pool(FILE *out, const char *name, const pool_t *pool) {
+    fprintf(out, "static const char %s[%zu] =", name, pool->len);
+    for (size_t off = 0; off < pool->len; off += strlen(&pool->buf[off]) + 1) {
+        fprintf(out, "\n    \"");
+        for (const char *p = &pool->buf[off]; *p != '\0'; p++) {
+            fprintf(out, "\\%03o", (unsigned char)*p);
+        }
+        fprintf(out, "\\0\"");
+    }
+    fprintf(out, ";\n\n");
+}
+
+static mejiro_roma_node_t roma_nodes[256];
+static mejiro_roma_edge_t roma_edges[ROMA_EDGES_MAX];
+static size_t roma_edge_count;
+
+static mejiro_roma_edge_t roma_pairs[256][ROMA_EDGES_MAX];
+static size_t roma_pair_count[256];
+
+/* Add one kana -> romaji rule; a kana that already has a rule keeps it. */
+static void add_roma_rule(const char *kana, const char *roma) {
+    char codes[4];
+    const size_t n = mejiro_kana_encode(kana, codes, sizeof(codes));
+    const uint8_t first = (uint8_t)codes[0];
+
+    if (n == 1) {
+        if (roma_nodes[first].roma == 0) {
+            roma_nodes[first].roma = pool_intern(&roma_pool, roma);
+        }
+    } else if (n == 2) {
+        for (size_t i = 0; i < roma_pair_count[first]; i++) {
+            if (roma_pairs[first][i].code == (uint8_t)codes[1]) {
+                return;
+            }
+        }
+        if (roma_pair_count[first] + 1 >= ROMA_EDGES_MAX) {
+            fprintf(stderr, "mejiro_kana_gen: too many romaji edges\n");
+            exit(1);
+        }
+        roma_pairs[first][roma_pair_count[first]].code = (uint8_t)codes[1];
+        roma_pairs[first][roma_pair_count[first]].roma = pool_intern(&roma_pool, roma);
+        roma_pair_count[first]++;
+    } else if (n > 2) {
+        fprintf(stderr, "mejiro_kana_gen: romaji rule \"%s\" is longer than two kana\n", kana);
+        exit(1);
+    }
+}
+
+/* Build the two-level romaji trie: the selected IME's rules first, then the
+ * Hepburn table; on equal length the earlier rule wins. */
+static void build_roma_trie(uint8_t ime) {
+    pool_intern(&roma_pool, "");
+    for (const mejiro_roma_ime_rule_t *rule = mejiro_roma_ime_rules; rule->kana != NULL; rule++) {
+        if (rule->ime & ime) {
+            add_roma_rule(rule->kana, rule->roma);
+        }
+    }
+    for (const mejiro_roma_rule_t *rule = mejiro_roma_rules; rule->kana != NULL; rule++) {
+        add_roma_rule(rule->kana, rule->roma);
+    }
+
+    roma_edge_count = 1; /* edge 0 means "no edges" */
+    for (size_t c = 0; c < 256; c++) {
+        if (roma_pair_count[c] == 0) {
+            continue;
+        }
+        if (roma_edge_count + roma_pair_count[c] + 1 > ROMA_EDGES_MAX) {
+            fprintf(stderr, "mejiro_kana_gen: too many romaji edges\n");
+            exit(1);
+        }
+        roma_nodes[c].edge = (uint8_t)roma_edge_count;
+        memcpy(&roma_edges[roma_edge_count], roma_pairs[c],
+               roma_pair_count[c] * sizeof(roma_pairs[c][0]));
+        roma_edge_count += roma_pair_count[c] + 1; /* keep a zero terminator */
+    }
+}
+
+/* A string of the word tables as a C string of kana codes; NULL stays NULL. */
+static void write_kana(FILE *out, const char *utf8) {
+    if (utf8 == NULL) {
+        fprintf(out, "NULL");
+        return;
+    }
+    fprintf(out, "\"");
+    for (const char *p = utf8; *p != '\0';) {
+        const mejiro_kana_t c = mejiro_kana_from_utf8(&p);
+        if (c == 0) {
+            fprintf(stderr, "mejiro_kana_gen: \"%s\" has no kana code\n", utf8);
+            exit(1);
+        }
+        fprintf(out, "\\%03o", c);
+    }
+    fprintf(out, "\"");
+}
+
+static void write_stroke(FILE *out, const char *stroke) {
+    if (stroke == NULL) {
+        fprintf(out, "NULL");
+    } else {
+        fprintf(out, "\"%s\"", stroke);
+    }
+}
+
+static void write_gyou(FILE *out, char gyou) {
+    if (gyou == '\0') {
+        fprintf(out, "'\\0'");
+    } else {
+        fprintf(out, "'%c'", gyou);
+    }
+}
+
+/* name[cols], or name[rows][cols] when rows is not 0 */
+static void write_string_table(FILE *out, const char *name, const char *const *table,
+                               size_t rows, size_t cols) {
+    const size_t n = rows == 0 ? 1 : rows;
+
+    if (rows == 0) {
+        fprintf(out, "static const char *const %s[%zu] =", name, cols);
+    } else {
+        fprintf(out, "static const char *const %s[%zu][%zu] = {", name, rows, cols);
+    }
+    for (size_t r = 0; r < n; r++) {
+        fprintf(out, rows == 0 ? " {" : "\n    {");
+        for (size_t c = 0; c < cols; c++) {
+            fprintf(out, c == 0 ? "" : ", ");
+            write_kana(out, table[r * cols + c]);
+        }
+        fprintf(out, rows == 0 ? "}" : "},");
+    }
+    fprintf(out, rows == 0 ? ";\n\n" : "\n};\n\n");
+}
+
+static void write_abbreviations(FILE *out, const char *name, const abbreviation_entry_t *table) {
+    fprintf(out, "static const abbreviation_entry_t %s[] = {\n", name);
+    for (size_t i = 0;; i++) {
+        fprintf(out, "    {");
+        write_stroke(out, table[i].stroke);
+        fprintf(out, ", ");
+        write_kana(out, table[i].output);
+        fprintf(out, "},\n");
+        if (table[i].stroke == NULL) {
+            break;
+        }
+    }
+    fprintf(out, "};\n\n");
+}
+
+/* The word tables of mejiro_word.h, under the names without _rules. */
+static void write_words(FILE *out) {
+    write_abbreviations(out, "mejiro_user_abbreviations", mejiro_user_abbreviations_rules);
+    write_abbreviations(out, "mejiro_abstract_abbreviations",
+                        mejiro_abstract_abbreviations_rules);
+    write_abbreviations(out, "mejiro_abstract_left", mejiro_abstract_left_rules);
+    write_abbreviations(out, "mejiro_abstract_right", mejiro_abstract_right_rules);
+
+    fprintf(out, "static const abbreviation_ending_t mejiro_abstract_endings[] = {\n");
+    for (const abbreviation_ending_t *e = mejiro_abstract_endings_rules;; e++) {
+        fprintf(out, "    {%u, %u, ", e->left_particle, e->right_particle);
+        write_kana(out, e->output);
+        fprintf(out, "},\n");
+        if (e->output == NULL) {
+            break;
+        }
+    }
+    fprintf(out, "};\n\n");
+
+    write_string_table(out, "mejiro_godan_conjugate", &mejiro_godan_conjugate_rules[0][0], 10,
+                       MEJIRO_CONJ_FORMS);
+    write_string_table(out, "mejiro_kami_conjugate", &mejiro_kami_conjugate_rules[0][0], 10,
+                       MEJIRO_CONJ_FORMS);
+    write_string_table(out, "mejiro_simo_conjugate", &mejiro_simo_conjugate_rules[0][0], 12,
+                       MEJIRO_CONJ_FORMS);
+    write_string_table(out, "mejiro_sahen_conjugate", mejiro_sahen_conjugate_rules, 0,
+                       MEJIRO_CONJ_FORMS);
+    write_string_table(out, "mejiro_kahen_conjugate", mejiro_kahen_conjugate_rules, 0,
+                       MEJIRO_CONJ_FORMS);
+    write_string_table(out, "mejiro_iku_conjugate", mejiro_iku_conjugate_rules, 0,
+                       MEJIRO_CONJ_FORMS);
+    write_string_table(out, "mejiro_aru_conjugate", mejiro_aru_conjugate_rules, 0,
+                       MEJIRO_CONJ_FORMS);
+
+    fprintf(out, "static const verb_entry_t mejiro_verb_dict[] = {\n");
+    for (const verb_entry_t *v = mejiro_verb_dict_rules;; v++) {
+        fprintf(out, "    {");
+        write_stroke(out, v->stroke);
+        fprintf(out, ", ");
+        write_kana(out, v->stem);
+        fprintf(out, ", ");
+        write_gyou(out, v->gyou);
+        fprintf(out, ", %d},\n", (int)v->type);
+        if (v->stroke == NULL) {
+            break;
+        }
+    }
+    fprintf(out, "};\n\n");
+
+    write_string_table(out, "mejiro_desu_conjugate", mejiro_desu_conjugate_rules, 0, 8);
+    write_string_table(out, "mejiro_second_sound", mejiro_second_sound_rules, 0, 8);
+
+    fprintf(out, "static const auxiliary_map_t mejiro_auxiliary_exception[] = {\n");
+    for (const auxiliary_map_t *a = mejiro_auxiliary_exception_rules;; a++) {
+        fprintf(out, "    {%u, %u, %d, ", a->left_particle, a->right_particle, a->conj_form);
+        write_kana(out, a->suffix);
+        fprintf(out, "},\n");
+        if (a->suffix == NULL) {
+            break;
+        }
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const left_auxiliary_info_t mejiro_left_auxiliary[] = {\n");
+    for (const left_auxiliary_info_t *a = mejiro_left_auxiliary_rules;; a++) {
+        fprintf(out, "    {%u, %d, ", a->particle, a->conj_form);
+        write_kana(out, a->stem);
+        fprintf(out, ", %d, ", a->verb_type);
+        write_gyou(out, a->gyou);
+        fprintf(out, "},\n");
+        if (a->stem == NULL) {
+            break;
+        }
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const right_auxiliary_t mejiro_right_auxiliary[8] = {\n");
+    for (size_t i = 0; i < 8; i++) {
+        fprintf(out, "    {%d, ", mejiro_right_auxiliary_rules[i].conj_form);
+        write_kana(out, mejiro_right_auxiliary_rules[i].suffix);
+        fprintf(out, "},\n");
+    }
+    fprintf(out, "};\n\n");
+
+    write_string_table(out, "mejiro_l_particle", mejiro_l_particle_rules, 0, 8);
+    write_string_table(out, "mejiro_r_particle", mejiro_r_particle_rules, 0, 8);
+}
+
+static const struct {
+    const char *name;
+    uint8_t ime;
+} roma_profiles[] = {
+    {"hepburn", 0},
+    {"msime", MEJIRO_ROMA_MSIME},
+    {"google", MEJIRO_ROMA_GOOGLE},
+    {"macos", MEJIRO_ROMA_MACOS},
+};
+
+int main(int argc, char **argv) {
+    static mejiro_kana_entry_t halves[MEJIRO_KANA_HALVES];
+
+    const char *profile = argc > 2 ? argv[2] : "hepburn";
+    int ime = -1;
+
+    for (size_t i = 0; i < sizeof(roma_profiles) / sizeof(roma_profiles[0]); i++) {
+        if (strcmp(profile, roma_profiles[i].name) == 0) {
+            ime = roma_profiles[i].ime;
+        }
+    }
+    if (argc < 2 || argc > 3 || ime < 0) {
+        fprintf(stderr, "usage: %s <out.h> [hepburn|msime|google|macos]\n", argv[0]);
+        return 2;
+    }
+
+    mejiro_kana_rules_init();
+    pool_intern(&kana_pool, "");
+    for (uint16_t half = 0; half < MEJIRO_KANA_HALVES; half++) {
+        char kana[MEJIRO_KANA_MAX] = {0};
+        char codes[MEJIRO_KANA_MAX];
+        halves[half].flags = mejiro_kana_rules_convert(half, kana);
+        mejiro_kana_encode(kana, codes, sizeof(codes));
+        halves[half].kana = pool_intern(&kana_pool, codes);
+    }
+    build_roma_trie((uint8_t)ime);
+
+    FILE *out = fopen(argv[1], "w");
+    if (out == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    fprintf(out, "/* Generated by scripts/mejiro_kana_gen.c. Do not edit. */\n");
+    fprintf(out, "#pragma once\n\n");
+    write_pool(out, "mejiro_kana_pool", &kana_pool);
+
+    fprintf(out, "static const mejiro_kana_entry_t mejiro_kana_halves[%u] = {\n",
+            MEJIRO_KANA_HALVES);
+    for (uint16_t half = 0; half < MEJIRO_KANA_HALVES; half++) {
+        fprintf(out, "    [0x%03x] = {%u, 0x%x},\n", half, halves[half].kana,
+                halves[half].flags);
+    }
+    fprintf(out, "};\n\n");
+
+    /* every IME profile takes a single n for ん before a consonant */
+    fprintf(out, "#define MEJIRO_ROMA_SINGLE_N %d\n\n", ime != 0);
+    write_pool(out, "mejiro_roma_pool", &roma_pool);
+    fprintf(out, "static const mejiro_roma_node_t mejiro_roma_nodes[256] = {\n");
+    for (size_t c = 0; c < 256; c++) {
+        if (roma_nodes[c].roma != 0 || roma_nodes[c].edge != 0) {
+            fprintf(out, "    [0x%02zx] = {%u, %u},\n", c, roma_nodes[c].roma, roma_nodes[c].edge);
+        }
+    }
+    fprintf(out, "};\n\n");
+    fprintf(out, "static const mejiro_roma_edge_t mejiro_roma_edges[%zu] = {\n", roma_edge_count);
+    for (size_t i = 0; i < roma_edge_count; i++) {
+        fprintf(out, "    {0x%02x, %u},\n", roma_edges[i].code, roma_edges[i].roma);
+    }
+    fprintf(out, "};\n\n");
+    write_words(out);
+
+    if (fclose(out) != 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * Host tool: print the Mejiro strokes of a steno packet stream.
+ *
+ *   mejiro_steno_decode <geminipr|txbolt> [device]
+ *
+ * Reads the stream written by CONFIG_NAGINATA_MEJIRO_STENO from the device
+ * (the CDC-ACM port, or the pty native_sim prints at start) or stdin, and
+ * prints one "STKNYIAUntk#-STKNYIAUntk*" stroke per line. Builds with
+ * src/mejiro_steno.c and src/mejiro_stroke.c:
+ *
+ *   cc -std=c99 -Iinclude scripts/mejiro_steno_decode.c src/mejiro_steno.c \
+ *      src/mejiro_stroke.c -o mejiro_steno_decode
+ */
+#define _DEFAULT_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <zmk_naginata/mejiro_steno.h>
+
+static void print_stroke(enum mejiro_steno_protocol protocol, const uint8_t *packet, size_t len) {
+    char id[MEJIRO_STROKE_STR_MAX];
+
+    mejiro_stroke_to_string(mejiro_steno_decode(protocol, packet, len), id, sizeof(id));
+    printf("%s\n", id);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    enum mejiro_steno_protocol protocol;
+
+    if (argc >= 2 && strcmp(argv[1], "geminipr") == 0) {
+        protocol = MEJIRO_STENO_GEMINIPR;
+    } else if (argc >= 2 && strcmp(argv[1], "txbolt") == 0) {
+        protocol = MEJIRO_STENO_TXBOLT;
+    } else {
+        fprintf(stderr, "usage: %s <geminipr|txbolt> [device]\n", argv[0]);
+        return 2;
+    }
+
+    int fd = STDIN_FILENO;
+    if (argc > 2) {
+        fd = open(argv[2], O_RDONLY | O_NOCTTY);
+        if (fd < 0) {
+            perror(argv[2]);
+            return 1;
+        }
+    }
+    struct termios tio;
+    if (isatty(fd) && tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    uint8_t packet[MEJIRO_STENO_PACKET_MAX];
+    size_t len = 0;
+    uint8_t c;
+    while (read(fd, &c, 1) == 1) {
+        if (protocol == MEJIRO_STENO_GEMINIPR) {
+            /* a packet starts at the byte with the top bit set and is 6 bytes */
+            if (c & 0x80) {
+                len = 0;
+            } else if (len == 0) {
+                continue;
+            }
+            packet[len++] = c;
+            if (len == 6) {
+                print_stroke(protocol, packet, len);
+                len = 0;
+            }
+        } else {
+            /* a stroke ends at a 0 byte or when the group number does not increase */
+            if (len > 0 && (c == 0 || (c >> 6) <= (packet[len - 1] >> 6))) {
+                print_stroke(protocol, packet, len);
+                len = 0;
+            }
+            if (c != 0 && len < MEJIRO_STENO_PACKET_MAX) {
+                packet[len++] = c;
+            }
+        }
+    }
+    if (protocol == MEJIRO_STENO_TXBOLT && len > 0) {
+        print_stroke(protocol, packet, len);
+    }
+    return 0;
+}
@@ -12,6 +12,10 @@
 #include <drivers/behavior.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#if IS_ENABLED(CONFIG_NAGINATA_MEJIRO_BENCH)
+#include <zephyr/timing/timing.h>
+#endif
 
 /* C standard types (Zephyr headers often include these indirectly, but keep it explicit) */
 #include <stdbool.h>
@@ -24,6 +28,16 @@
 #include <zmk_naginata/nglist.h>
 #include <zmk_naginata/nglistarray.h>
 #include <zmk_naginata/naginata_func.h>
+#include <zmk_naginata/naginata_emit.h>
+#include <zmk_naginata/mejiro_stats.h>
+#include <zmk_naginata/mejiro_stroke.h>
+#include <zmk_naginata/mejiro_kana.h>
+#include <zmk_naginata/mejiro_kana_code.h>
+#include <zmk_naginata/mejiro_sb.h>
+#include <zmk_naginata/mejiro_steno.h>
+#include <zmk_naginata/mejiro_word.h>
+
+#include "mejiro_kana_table.h"
 
 
 /* QMK-style chord bit definitions used throughout the single-file port. */
@@ -66,7 +80,9 @@ enum mejiro_chord_bits {
  * Mejiro abbreviations/verbs (enabled)
  *
  *  - These are pure string transforms and do not depend on QMK.
- *  - Output is UTF-8 (Japanese), which ZMK will pass through to the host IME.
+ *  - The word tables are generated into mejiro_kana_table.h from
+ *    src/mejiro_word_rules.c with their strings as kana codes; output is kana
+ *    codes too (mejiro_kana_code.h).
  * -------------------------------------------------------------------------- */
 
 typedef struct {
@@ -79,148 +95,22 @@ typedef struct {
     bool success;
 } verb_result_t;
 
-// QMK mejiro_verb.h 由来の型定義
-typedef enum {
-    VERB_TYPE_GODAN,
-    VERB_TYPE_KAMI,
-    VERB_TYPE_SIMO,
-    VERB_TYPE_SAHEN,
-    VERB_TYPE_KAHEN,
-    VERB_TYPE_SPECIAL
-} verb_type_t;
-
-typedef enum {
-    CONJ_NAI,
-    CONJ_SHIEKI,
-    CONJ_UKEMI,
-    CONJ_MASU,
-    CONJ_JISHO,
-    CONJ_TE_TA,
-    CONJ_IKOU,
-    CONJ_KATEI,
-    CONJ_KANOU,
-    CONJ_MEIREI,
-} conj_form_t;
-
-typedef struct {
-    const char *stroke;
-    const char *stem;
-    char gyou;
-    verb_type_t type;
-} verb_entry_t;
-
-// ユーザー略語のマッピング（完全なストローク形式）
-typedef struct {
-    const char *stroke;
-    const char *output;
-} user_abbreviation_t;
-
-static const user_abbreviation_t user_abbreviations[] = {
-    {"A-SKNIA", "あめりか"},
-    {"KNUntk-KNU", "ぐーぐる"},
-    {"KAUn-TAntk", "こんぴゅーたー"},
-    {"SKNIA-SAUtk", "めそっど"},
-    {"TNIA-SNI", "でじたる"},
-    {"SU-STKNAU", "すまーとふぉん"},
-    {"SU-TKAU", "すまほ"},
-    {"STKU-STA", "ぷらすちっく"},
-    {"KI-TKNAU", "きーぼーど"},
-    {"In-STA", "いんふら"},
-    {"KAUn-TKNIn", "こんびに"},
-    {"SI-KNAUt", "しごと"},
-    {"SI-SU", "しすてむ"},
-    {"SAU-TKUt", "そふと"},
-    {"SAU-SKIA", "そふとうぇあ"},
-    {"TKA-SKIA", "はーどうぇあ"},
-    {"In-NIAtk", "いんたーねっと"},
-    {"In-STKNAU", "いんふぉめーしょん"},
-    {"KAU-SKNYU", "こみゅにけーしょん"},
-    {"SI-SKNYU", "しみゅれーしょん"},
-    {"IU-STU", "ういるす"},
-    {"KAU-IU", "ころなういるす"},
-    {"SIn-KNAt", "しんがた"},
-    {"A-STI", "ありがとう"},
-    {"AU-NIA", "おねがい"},
-    {"YAU-STAU", "よろしく"},
-    {"TA-TAU", "たとえば"},
-    {"KNU-TY", "ぐたいてきには"},
-    {NULL, NULL}
-};
-
-// 一般略語の完全一致マッピング
-typedef struct {
-    const char *stroke;
-    const char *output;
-} abstract_abbreviation_t;
-
-static const abstract_abbreviation_t abstract_abbreviations[] = {
-    {"A-TNA", "あれだけ"},
-    {"KAU-TNA", "これだけ"},
-    {"SAU-TNA", "それだけ"},
-    {"TNAU-TNA", "どれだけ"},
-    {"TNA-TNA", "だれだけ"},
-    {"A-IU", "ああいう"},
-    {"KAU-IU", "こういう"},
-    {"SAU-IU", "そういう"},
-    {"TNAU-IU", "どういう"},
-    {"NA-IU", "なんていう"},
-    {NULL, NULL}
-};
-
-// 一般略語の左側マッピング
-typedef struct {
-    const char *stroke;
-    const char *output;
-} abstract_left_t;
-
-static const abstract_left_t abstract_left[] = {
-    {"STN", ""},
-    {"IAU", "あの"},
-    {"KIAU", "この"},
-    {"SIAU", "その"},
-    {"TIAU", "との"},
-    {"TNIAU", "どの"},
-    {"NIAU", "なんの"},
-    {"IU", "いう"},
-    {"YIU", "ああいう"},
-    {"KIU", "こういう"},
-    {"SIU", "そういう"},
-    {"TIU", "という"},
-    {"TNIU", "どういう"},
-    {"NIU", "なんていう"},
-    {NULL, NULL}
-};
-
-// 一般略語の右側マッピング
-typedef struct {
-    const char *stroke;
-    const char *output;
-} abstract_right_t;
-
-static const abstract_right_t abstract_right[] = {
-    {"STN", ""},
-    {"KAU", "こと"},
-    {"STAU", "ころ"},
-    {"KI", "とき"},
-    {"TAU", "ところ"},
-    {"TKI", "ひと"},
-    {"TKA", "はなし"},
-    {"KA", "かんじ"},
-    {"TKIAU", "ほう"},
-    {"SKNAU", "もの"},
-    {"KNAU", "ものごと"},
-    {"SI", "しごと"},
-    {NULL, NULL}
-};
+/* Packed codes of the table strokes above, resolved once by mejiro_tables_init. */
+static mejiro_stroke_t user_abbreviation_codes[ARRAY_SIZE(mejiro_user_abbreviations)];
+static mejiro_stroke_t abstract_abbreviation_codes[ARRAY_SIZE(mejiro_abstract_abbreviations)];
+static uint16_t abstract_left_codes[ARRAY_SIZE(mejiro_abstract_left)];
+static uint16_t abstract_right_codes[ARRAY_SIZE(mejiro_abstract_right)];
 
-// ユーザー略語を検索（完全なストローク）
-abbreviation_result_t mejiro_user_abbreviation(const char *stroke) {
+// ユーザー略語を検索（完全なストローク、#と*を除く）
+abbreviation_result_t mejiro_user_abbreviation(mejiro_stroke_t stroke) {
     abbreviation_result_t result = {{0}, false};
     
-    for (size_t i = 0; user_abbreviations[i].stroke != NULL; i++) {
-        if (strcmp(stroke, user_abbreviations[i].stroke) == 0) {
-            strcpy(result.output, user_abbreviations[i].output);
-            result.success = true;
+    for (size_t i = 0; mejiro_user_abbreviations[i].stroke != NULL; i++) {
+        if (stroke == user_abbreviation_codes[i]) {
+            mejiro_sb_t out;
+            mejiro_sb_init(&out, result.output, sizeof(result.output));
+            mejiro_sb_append(&out, mejiro_user_abbreviations[i].output);
+            result.success = !out.truncated;
             return result;
         }
     }
@@ -228,53 +118,49 @@ abbreviation_result_t mejiro_user_abbreviation(const char *stroke) {
     return result;
 }
 
-// 一般略語を検索（完全なストローク）
-abbreviation_result_t mejiro_abstract_abbreviation(const char *stroke) {
+// 一般略語を検索（左右の子音+母音のみのストローク）
+abbreviation_result_t mejiro_abstract_abbreviation(mejiro_stroke_t stroke) {
     abbreviation_result_t result = {{0}, false};
     
     // 完全一致を先にチェック
-    for (size_t i = 0; abstract_abbreviations[i].stroke != NULL; i++) {
-        if (strcmp(stroke, abstract_abbreviations[i].stroke) == 0) {
-            strcpy(result.output, abstract_abbreviations[i].output);
-            result.success = true;
+    for (size_t i = 0; mejiro_abstract_abbreviations[i].stroke != NULL; i++) {
+        if (stroke == abstract_abbreviation_codes[i]) {
+            mejiro_sb_t out;
+            mejiro_sb_init(&out, result.output, sizeof(result.output));
+            mejiro_sb_append(&out, mejiro_abstract_abbreviations[i].output);
+            result.success = !out.truncated;
             return result;
         }
     }
     
     // 左右の組み合わせをチェック
-    // strokeを'-'で分割
-    char left_part[32] = {0};
-    char right_part[32] = {0};
-    const char *hyphen = strchr(stroke, '-');
-    if (hyphen != NULL) {
-        size_t left_len = hyphen - stroke;
-        strncpy(left_part, stroke, left_len);
-        left_part[left_len] = '\0';
-        strcpy(right_part, hyphen + 1);
-        
-        const char *left_output = NULL;
-        const char *right_output = NULL;
-        
-        for (size_t i = 0; abstract_left[i].stroke != NULL; i++) {
-            if (strcmp(left_part, abstract_left[i].stroke) == 0) {
-                left_output = abstract_left[i].output;
-                break;
-            }
-        }
-        
-        for (size_t i = 0; abstract_right[i].stroke != NULL; i++) {
-            if (strcmp(right_part, abstract_right[i].stroke) == 0) {
-                right_output = abstract_right[i].output;
-                break;
-            }
+    const uint16_t left_part = MJ_LEFT(stroke);
+    const uint16_t right_part = MJ_RIGHT(stroke);
+
+    const char *left_output = NULL;
+    const char *right_output = NULL;
+
+    for (size_t i = 0; mejiro_abstract_left[i].stroke != NULL; i++) {
+        if (left_part == abstract_left_codes[i]) {
+            left_output = mejiro_abstract_left[i].output;
+            break;
         }
-        
-        if (left_output != NULL && right_output != NULL) {
-            strcpy(result.output, left_output);
-            strcat(result.output, right_output);
-            result.success = true;
+    }
+
+    for (size_t i = 0; mejiro_abstract_right[i].stroke != NULL; i++) {
+        if (right_part == abstract_right_codes[i]) {
+            right_output = mejiro_abstract_right[i].output;
+            break;
         }
     }
+
+    if (left_output != NULL && right_output != NULL) {
+        mejiro_sb_t out;
+        mejiro_sb_init(&out, result.output, sizeof(result.output));
+        mejiro_sb_append(&out, left_output);
+        mejiro_sb_append(&out, right_output);
+        result.success = !out.truncated;
+    }
     
     return result;
 }
@@ -320,630 +206,184 @@ static int gyou_to_index_simo(char gyou) {
     }
 }
 
-// 仮名の先頭文字から行を判定
+// 仮名コードの行から動詞の行を引く（ぱ行・や行・小書きは対象外）
+static const char kana_row_gyou[16] = {
+    [MK_ROW_K] = 'k', [MK_ROW_G] = 'g', [MK_ROW_S] = 's', [MK_ROW_Z] = 'z',
+    [MK_ROW_T] = 't', [MK_ROW_D] = 'd', [MK_ROW_N] = 'n', [MK_ROW_H] = 'h',
+    [MK_ROW_B] = 'b', [MK_ROW_M] = 'm', [MK_ROW_R] = 'r',
+};
+
+// 仮名コード列の先頭文字から行を判定
 static char kana_to_gyou(const char *kana) {
-    if (kana == NULL || kana[0] == '\0') {
+    if (kana == NULL || !MK_IS_KANA(kana[0])) {
         return '\0';
     }
 
-    if (strncmp(kana, "か", 3) == 0 || strncmp(kana, "き", 3) == 0 || strncmp(kana, "く", 3) == 0 ||
-        strncmp(kana, "け", 3) == 0 || strncmp(kana, "こ", 3) == 0) {
-        return 'k';
-    }
-    if (strncmp(kana, "が", 3) == 0 || strncmp(kana, "ぎ", 3) == 0 || strncmp(kana, "ぐ", 3) == 0 ||
-        strncmp(kana, "げ", 3) == 0 || strncmp(kana, "ご", 3) == 0) {
-        return 'g';
-    }
-    if (strncmp(kana, "さ", 3) == 0 || strncmp(kana, "し", 3) == 0 || strncmp(kana, "す", 3) == 0 ||
-        strncmp(kana, "せ", 3) == 0 || strncmp(kana, "そ", 3) == 0) {
-        return 's';
-    }
-    if (strncmp(kana, "ざ", 3) == 0 || strncmp(kana, "じ", 3) == 0 || strncmp(kana, "ず", 3) == 0 ||
-        strncmp(kana, "ぜ", 3) == 0 || strncmp(kana, "ぞ", 3) == 0) {
-        return 'z';
-    }
-    if (strncmp(kana, "た", 3) == 0 || strncmp(kana, "ち", 3) == 0 || strncmp(kana, "つ", 3) == 0 ||
-        strncmp(kana, "て", 3) == 0 || strncmp(kana, "と", 3) == 0) {
-        return 't';
-    }
-    if (strncmp(kana, "だ", 3) == 0 || strncmp(kana, "ぢ", 3) == 0 || strncmp(kana, "づ", 3) == 0 ||
-        strncmp(kana, "で", 3) == 0 || strncmp(kana, "ど", 3) == 0) {
-        return 'd';
-    }
-    if (strncmp(kana, "な", 3) == 0 || strncmp(kana, "に", 3) == 0 || strncmp(kana, "ぬ", 3) == 0 ||
-        strncmp(kana, "ね", 3) == 0 || strncmp(kana, "の", 3) == 0) {
-        return 'n';
-    }
-    if (strncmp(kana, "は", 3) == 0 || strncmp(kana, "ひ", 3) == 0 || strncmp(kana, "ふ", 3) == 0 ||
-        strncmp(kana, "へ", 3) == 0 || strncmp(kana, "ほ", 3) == 0) {
-        return 'h';
-    }
-    if (strncmp(kana, "ば", 3) == 0 || strncmp(kana, "び", 3) == 0 || strncmp(kana, "ぶ", 3) == 0 ||
-        strncmp(kana, "べ", 3) == 0 || strncmp(kana, "ぼ", 3) == 0) {
-        return 'b';
-    }
-    if (strncmp(kana, "ま", 3) == 0 || strncmp(kana, "み", 3) == 0 || strncmp(kana, "む", 3) == 0 ||
-        strncmp(kana, "め", 3) == 0 || strncmp(kana, "も", 3) == 0) {
-        return 'm';
-    }
-    if (strncmp(kana, "ら", 3) == 0 || strncmp(kana, "り", 3) == 0 || strncmp(kana, "る", 3) == 0 ||
-        strncmp(kana, "れ", 3) == 0 || strncmp(kana, "ろ", 3) == 0) {
-        return 'r';
-    }
-    if (strncmp(kana, "わ", 3) == 0 || strncmp(kana, "あ", 3) == 0 || strncmp(kana, "い", 3) == 0 ||
-        strncmp(kana, "う", 3) == 0 || strncmp(kana, "え", 3) == 0 || strncmp(kana, "お", 3) == 0) {
+    const mejiro_kana_t c = (mejiro_kana_t)kana[0];
+    // あ行・わ は w行（ー、。 と ゐゔゑをん は除く）
+    if ((MK_ROW(c) == MK_ROW_A && MK_COL(c) <= MK_DAN_O) || c == MK_KANA(MK_ROW_W, 0)) {
         return 'w';
     }
-
-    return '\0';
-}
-
-// 五段活用テーブル
-// [行][活用形] = 語尾
-static const char *godan_conjugate[10][10] = {
-    // k行
-    {"か", "か", "か", "き", "く", "い", "こう", "け", "け", "け"},
-    // g行
-    {"が", "が", "が", "ぎ", "ぐ", "い", "ごう", "げ", "げ", "げ"},
-    // s行
-    {"さ", "さ", "さ", "し", "す", "し", "そう", "せ", "せ", "せ"},
-    // t行
-    {"た", "た", "た", "ち", "つ", "っ", "とう", "て", "て", "て"},
-    // n行
-    {"な", "な", "な", "に", "ぬ", "ん", "のう", "ね", "ね", "ね"},
-    // b行
-    {"ば", "ば", "ば", "び", "ぶ", "ん", "ぼう", "べ", "べ", "べ"},
-    // m行
-    {"ま", "ま", "ま", "み", "む", "ん", "もう", "め", "め", "め"},
-    // r行
-    {"ら", "ら", "ら", "り", "る", "っ", "ろう", "れ", "れ", "れ"},
-    // w行
-    {"わ", "わ", "わ", "い", "う", "っ", "おう", "え", "え", "え"},
-    // dummy
-    {"", "", "", "", "", "", "", "", "", ""}
-};
-
-// 上一段活用テーブル
-static const char *kami_conjugate[10][10] = {
-    // k行
-    {"き", "きさ", "きら", "き", "きる", "き", "きよう", "きれ", "きれ", "きろ"},
-    // g行
-    {"ぎ", "ぎさ", "ぎら", "ぎ", "ぎる", "ぎ", "ぎよう", "ぎれ", "ぎれ", "ぎろ"},
-    // z行
-    {"じ", "じさ", "じら", "じ", "じる", "じ", "じよう", "じれ", "じれ", "じろ"},
-    // t行
-    {"ち", "ちさ", "ちら", "ち", "ちる", "ち", "ちよう", "ちれ", "ちれ", "ちろ"},
-    // n行
-    {"に", "にさ", "にら", "に", "にる", "に", "によう", "にれ", "にれ", "にろ"},
-    // b行
-    {"び", "びさ", "びら", "び", "びる", "び", "びよう", "びれ", "びれ", "びろ"},
-    // m行
-    {"み", "みさ", "みら", "み", "みる", "み", "みよう", "みれ", "みれ", "みろ"},
-    // r行
-    {"り", "りさ", "りら", "り", "りる", "り", "りよう", "りれ", "りれ", "りろ"},
-    // w行
-    {"い", "いさ", "いら", "い", "いる", "い", "いよう", "いれ", "いれ", "いろ"},
-    // dummy
-    {"", "", "", "", "", "", "", "", "", ""}
-};
-
-// 下一段活用テーブル
-static const char *simo_conjugate[12][10] = {
-    // k行
-    {"け", "けさ", "けら", "け", "ける", "け", "けよう", "けれ", "けれ", "けろ"},
-    // g行
-    {"げ", "げさ", "げら", "げ", "げる", "げ", "げよう", "げれ", "げれ", "げろ"},
-    // s行
-    {"せ", "せさ", "せら", "せ", "せる", "せ", "せよう", "せれ", "せれ", "せろ"},
-    // z行
-    {"ぜ", "ぜさ", "ぜら", "ぜ", "ぜる", "ぜ", "ぜよう", "ぜれ", "ぜれ", "ぜろ"},
-    // t行
-    {"て", "てさ", "てら", "て", "てる", "て", "てよう", "てれ", "てれ", "てろ"},
-    // d行
-    {"で", "でさ", "でら", "で", "でる", "で", "でよう", "でれ", "でれ", "でろ"},
-    // n行
-    {"ね", "ねさ", "ねら", "ね", "ねる", "ね", "ねよう", "ねれ", "ねれ", "ねろ"},
-    // h行
-    {"へ", "へさ", "へら", "へ", "へる", "へ", "へよう", "へれ", "へれ", "へろ"},
-    // b行
-    {"べ", "べさ", "べら", "べ", "べる", "べ", "べよう", "べれ", "べれ", "べろ"},
-    // m行
-    {"め", "めさ", "めら", "め", "める", "め", "めよう", "めれ", "めれ", "めろ"},
-    // r行
-    {"れ", "れさ", "れら", "れ", "れる", "れ", "れよう", "れれ", "れれ", "れろ"},
-    // w行
-    {"え", "えさ", "えら", "え", "える", "え", "えよう", "えれ", "えれ", "えろ"}
-};
-
-// サ変活用
-static const char *sahen_conjugate[10] __attribute__((unused)) = {
-    "し", "さ", "さ", "し", "する", "し", "しよう", "すれ", "でき", "しろ"
-};
-// カ変活用
-static const char *kahen_conjugate[10] = {
-    "こ", "こさ", "こら", "き", "くる", "き", "こよう", "くれ", "これ", "こい"
-};
-// 行く（五段特殊）
-static const char *iku_conjugate[10] = {
-    "いか", "いか", "いか", "いき", "いく", "いっ", "いこう", "いけ", "いけ", "いけ"
-};
-// ある（五段特殊）
-static const char *aru_conjugate[10] = {
-    "", "あら", "あら", "あり", "ある", "あっ", "あろう", "あれ", "ありえ", "あれ"
-};
-
-// 主要な動詞辞書 (Plover_Mejiroより統合)
-static const verb_entry_t verb_dict[] = {
-    // 五段活用
-    // k行 13コ
-    {"A-STU", "ある", 'k', VERB_TYPE_GODAN},       // 歩く
-    {"I-TNA", "いただ", 'k', VERB_TYPE_GODAN},     // 頂く
-    {"U-KNAU", "うご", 'k', VERB_TYPE_GODAN},      // 動く
-    {"KA-YA", "かがや", 'k', VERB_TYPE_GODAN},     // 輝く
-    {"KI-KNA", "きがつ", 'k', VERB_TYPE_GODAN},    // 気が付く
-    {"KI-TNU", "きづ", 'k', VERB_TYPE_GODAN},      // 気付く
-    {"SI-KNAU", "しご", 'k', VERB_TYPE_GODAN},     // 扱く
-    {"TA-TA", "たた", 'k', VERB_TYPE_GODAN},       // 叩く
-    {"TU-TNU", "つづ", 'k', VERB_TYPE_GODAN},      // 続く
-    {"NAU-SNAU", "のぞ", 'k', VERB_TYPE_GODAN},    // 除く
-    {"TKA-STA", "はたら", 'k', VERB_TYPE_GODAN},   // 働く
-    {"TKI-STA", "ひら", 'k', VERB_TYPE_GODAN},     // 開く
-    {"SKNI-KNA", "みが", 'k', VERB_TYPE_GODAN},    // 磨く
-    // g行 7コ
-    {"I-SAU", "いそ", 'g', VERB_TYPE_GODAN},       // 急ぐ
-    {"KA-SIA", "かせ", 'g', VERB_TYPE_GODAN},      // 稼ぐ
-    {"KA-TU", "かつ", 'g', VERB_TYPE_GODAN},       // 担ぐ
-    {"SA-SA", "ささ", 'g', VERB_TYPE_GODAN},       // 捧ぐ
-    {"TU-NA", "つな", 'g', VERB_TYPE_GODAN},       // 繋ぐ
-    {"TKU-SA", "ふさ", 'g', VERB_TYPE_GODAN},      // 塞ぐ
-    {"TKU-SIA", "ふせ", 'g', VERB_TYPE_GODAN},     // 防ぐ
-    // s行 27コ
-    {"A-KA", "あか", 's', VERB_TYPE_GODAN},        // 明かす
-    {"I-KA", "いか", 's', VERB_TYPE_GODAN},        // 活かす
-    {"I-TA", "いた", 's', VERB_TYPE_GODAN},        // 致す
-    {"AU-TAU", "おと", 's', VERB_TYPE_GODAN},      // 落とす
-    {"KA-KA", "かか", 's', VERB_TYPE_GODAN},       // 欠かす
-    {"KA-KU", "かく", 's', VERB_TYPE_GODAN},       // 隠す
-    {"KU-STA", "くら", 's', VERB_TYPE_GODAN},      // 暮らす
-    {"KAU-STAU", "ころ", 's', VERB_TYPE_GODAN},    // 殺す
-    {"KAU-SKA", "こわ", 's', VERB_TYPE_GODAN},     // 壊す
-    {"SA-KNA", "さが", 's', VERB_TYPE_GODAN},      // 探す
-    {"SI-SKNIA", "しめ", 's', VERB_TYPE_GODAN},    // 示す
-    {"TA-AU", "たお", 's', VERB_TYPE_GODAN},       // 倒す
-    {"TNA-", "だ", 's', VERB_TYPE_GODAN},          // 出す
-    {"TU-TKNU", "つぶ", 's', VERB_TYPE_GODAN},     // 潰す
-    {"TIA-STA", "てら", 's', VERB_TYPE_GODAN},     // 照らす
-    {"NA-AU", "なお", 's', VERB_TYPE_GODAN},       // 直す
-    {"NI-KNA", "にが", 's', VERB_TYPE_GODAN},      // 逃がす
-    {"NAU-TKNA", "のば", 's', VERB_TYPE_GODAN},    // 伸ばす
-    {"TKA-NA", "はな", 's', VERB_TYPE_GODAN},      // 話す
-    {"TKA-KNA", "はが", 's', VERB_TYPE_GODAN},     // 剥がす
-    {"SKNA-KA", "まか", 's', VERB_TYPE_GODAN},     // 任す
-    {"SKNI-TA", "みた", 's', VERB_TYPE_GODAN},     // 満たす
-    {"SKNI-NA", "みな", 's', VERB_TYPE_GODAN},     // 見なす
-    {"SKNI-SKNA", "みまわ", 's', VERB_TYPE_GODAN}, // 見回す
-    {"SKNI-SKA", "みわた", 's', VERB_TYPE_GODAN},  // 見渡す
-    {"YU-STA", "ゆら", 's', VERB_TYPE_GODAN},      // 揺らす
-    {"SKA-TA", "わた", 's', VERB_TYPE_GODAN},      // 渡す
-    // t行 4コ
-    {"U-KNA", "うが", 't', VERB_TYPE_GODAN},       // 穿つ
-    {"SAU-TNA", "そだ", 't', VERB_TYPE_GODAN},     // 育つ
-    {"TA-SKNAU", "たも", 't', VERB_TYPE_GODAN},    // 保つ
-    {"SKNIA-TNA", "めだ", 't', VERB_TYPE_GODAN},   // 目立つ
-    // b行 10コ
-    {"A-SAU", "あそ", 'b', VERB_TYPE_GODAN},       // 遊ぶ
-    {"IA-STA", "えら", 'b', VERB_TYPE_GODAN},      // 選ぶ
-    {"AU-YAU", "およ", 'b', VERB_TYPE_GODAN},      // 及ぶ
-    {"KAU-STAU", "ころ", 'b', VERB_TYPE_GODAN},    // 転ぶ
-    {"NA-STA", "なら", 'b', VERB_TYPE_GODAN},      // 並ぶ
-    {"TKA-KAU", "はこ", 'b', VERB_TYPE_GODAN},     // 運ぶ
-    {"TKAU-STAU", "ほろ", 'b', VERB_TYPE_GODAN},   // 滅ぶ
-    {"SKNA-NA", "まな", 'b', VERB_TYPE_GODAN},     // 学ぶ
-    {"SKNU-SU", "むす", 'b', VERB_TYPE_GODAN},     // 結ぶ
-    {"YAU-STAU", "よろこ", 'b', VERB_TYPE_GODAN},  // 喜ぶ
-    // m行 19コ
-    {"I-NA", "いな", 'm', VERB_TYPE_GODAN},        // 否む
-    {"U-STA", "うらや", 'm', VERB_TYPE_GODAN},     // 羨む
-    {"KA-KNA", "かが", 'm', VERB_TYPE_GODAN},      // 屈む
-    {"KA-SU", "かす", 'm', VERB_TYPE_GODAN},       // 霞む
-    {"SI-SNU", "しず", 'm', VERB_TYPE_GODAN},      // 沈む
-    {"SU-SU", "すす", 'm', VERB_TYPE_GODAN},       // 進む
-    {"TA-NAU", "たの", 'm', VERB_TYPE_GODAN},      // 頼む
-    {"TIU-TKNA", "ついば", 'm', VERB_TYPE_GODAN},  // 啄む
-    {"TU-TU", "つつ", 'm', VERB_TYPE_GODAN},       // 包む
-    {"TU-SKNA", "つま", 'm', VERB_TYPE_GODAN},     // 摘む
-    {"NA-YA", "なや", 'm', VERB_TYPE_GODAN},       // 悩む
-    {"NU-SU", "ぬす", 'm', VERB_TYPE_GODAN},       // 盗む
-    {"NAU-SNAU", "のぞ", 'm', VERB_TYPE_GODAN},    // 望む
-    {"TKA-SA", "はさ", 'm', VERB_TYPE_GODAN},      // 挟む
-    {"TKA-STA", "はら", 'm', VERB_TYPE_GODAN},     // 孕む
-    {"TKI-KAU", "ひっこ", 'm', VERB_TYPE_GODAN},   // 引っ込む
-    {"TKU-KU", "ふく", 'm', VERB_TYPE_GODAN},      // 含む
-    {"TKAU-TKAU", "ほほえ", 'm', VERB_TYPE_GODAN}, // 微笑む
-    {"YA-SU", "やす", 'm', VERB_TYPE_GODAN},       // 休む
-    // r行 17コ
-    {"I-", "い", 'r', VERB_TYPE_GODAN},            // 要る
-    {"KA-KNI", "かぎ", 'r', VERB_TYPE_GODAN},      // 限る
-    {"KNA-TKNA", "がんば", 'r', VERB_TYPE_GODAN},  // 頑張る
-    {"KNA-", "がんば", 'r', VERB_TYPE_GODAN},      // 頑張る
-    {"KU-TNA", "くださ", 'r', VERB_TYPE_GODAN},    // 下さる
-    {"KIA-", "け", 'r', VERB_TYPE_GODAN},          // 蹴る
-    {"KAU-TAU", "ことな", 'r', VERB_TYPE_GODAN},   // 異なる
-    {"SYA-TKNIA", "しゃべ", 'r', VERB_TYPE_GODAN}, // しゃべる
-    {"SU-TKNIA", "すべ", 'r', VERB_TYPE_GODAN},    // 滑る
-    {"T-KA", "たすか", 'r', VERB_TYPE_GODAN},      // 助かる
-    {"TA-SNU", "たずさわ", 'r', VERB_TYPE_GODAN},  // 携わる
-    {"NA-", "な", 'r', VERB_TYPE_GODAN},           // なる
-    {"TKY-", "はい", 'r', VERB_TYPE_GODAN},        // 入る
-    {"TKA-SI", "はし", 'r', VERB_TYPE_GODAN},      // 走る
-    {"TKA-TKNA", "はばか", 'r', VERB_TYPE_GODAN},  // 憚る
-    {"YA-", "や", 'r', VERB_TYPE_GODAN},           // やる
-    {"-YA", "や", 'r', VERB_TYPE_GODAN},           // やる
-    {"SKA-", "わか", 'r', VERB_TYPE_GODAN},        // 分かる
-    // w行 41コ
-    {"-A", "あ", 'w', VERB_TYPE_GODAN},            // 会う
-    {"A-STA", "あら", 'w', VERB_TYPE_GODAN},       // 洗う
-    {"A-SAU", "あらそ", 'w', VERB_TYPE_GODAN},     // 争う
-    {"IU-", "い", 'w', VERB_TYPE_GODAN},           // 言う
-    {"I-SNA", "いざな", 'w', VERB_TYPE_GODAN},     // 誘う
-    {"I-SKA", "いわ", 'w', VERB_TYPE_GODAN},       // 祝う
-    {"U-SI", "うしな", 'w', VERB_TYPE_GODAN},      // 失う
-    {"U-TA", "うた", 'w', VERB_TYPE_GODAN},        // 歌う
-    {"U-KNA", "うたが", 'w', VERB_TYPE_GODAN},     // 疑う
-    {"U-YA", "うやま", 'w', VERB_TYPE_GODAN},      // 敬う
-    {"AU-KAU", "おこな", 'w', VERB_TYPE_GODAN},    // 行う
-    {"AU-SKNAU", "おも", 'w', VERB_TYPE_GODAN},    // 思う
-    {"AU-", "おも", 'w', VERB_TYPE_GODAN},         // 思う
-    {"KA-NA", "かな", 'w', VERB_TYPE_GODAN},       // 叶う
-    {"KA-SKNA", "かま", 'w', VERB_TYPE_GODAN},     // 構う
-    {"KU-STU", "くる", 'w', VERB_TYPE_GODAN},      // 狂う
-    {"SI-A", "しあ", 'w', VERB_TYPE_GODAN},        // 仕合う
-    {"SI-TA", "したが", 'w', VERB_TYPE_GODAN},     // 従う
-    {"SI-SKNA", "しま", 'w', VERB_TYPE_GODAN},     // 仕舞う
-    {"SAU-STAU", "そろ", 'w', VERB_TYPE_GODAN},    // 揃う
-    {"TA-TA", "たたか", 'w', VERB_TYPE_GODAN},     // 戦う
-    {"TI-KA", "ちか", 'w', VERB_TYPE_GODAN},       // 誓う
-    {"TI-KNA", "ちが", 'w', VERB_TYPE_GODAN},      // 違う
-    {"TU-KA", "つか", 'w', VERB_TYPE_GODAN},       // 使う
-    {"TU-TI", "つちか", 'w', VERB_TYPE_GODAN},     // 培う
-    {"TU-TNAU", "つど", 'w', VERB_TYPE_GODAN},     // 集う
-    {"TIA-STA", "てら", 'w', VERB_TYPE_GODAN},     // 衒う
-    {"TNIA-A", "であ", 'w', VERB_TYPE_GODAN},      // 出会う
-    {"TAU-NA", "ともな", 'w', VERB_TYPE_GODAN},    // 伴う
-    {"NA-STA", "なら", 'w', VERB_TYPE_GODAN},      // 習う
-    {"NI-A", "にあ", 'w', VERB_TYPE_GODAN},        // 似合う
-    {"NI-SKA", "にぎわ", 'w', VERB_TYPE_GODAN},    // 賑わう
-    {"NIA-KNA", "ねが", 'w', VERB_TYPE_GODAN},     // 願う
-    {"NAU-STAU", "のろ", 'w', VERB_TYPE_GODAN},    // 呪う
-    {"TKA-STA", "はら", 'w', VERB_TYPE_GODAN},     // 払う
-    {"TKI-STAU", "ひろ", 'w', VERB_TYPE_GODAN},    // 拾う
-    {"SKNA-TAU", "まと", 'w', VERB_TYPE_GODAN},    // 纏う
-    {"SKNI-A", "みあ", 'w', VERB_TYPE_GODAN},      // 見合う
-    {"SKNU-KA", "むか", 'w', VERB_TYPE_GODAN},     // 向かう
-    {"SKNAU-STA", "もら", 'w', VERB_TYPE_GODAN},   // 貰う
-    {"SKA-STA", "わら", 'w', VERB_TYPE_GODAN},     // 笑う
-    // 上一段活用
-    // k行 1コ
-    {"TN-KI", "で", 'k', VERB_TYPE_KAMI},          // 出来る
-    // z行 5コ
-    {"IA-SNI", "えん", 'z', VERB_TYPE_KAMI},       // 演じる
-    {"KA-SNI", "かん", 'z', VERB_TYPE_KAMI},       // 感じる
-    {"KI-SNI", "きん", 'z', VERB_TYPE_KAMI},       // 禁じる
-    {"SI-SNI", "しん", 'z', VERB_TYPE_KAMI},       // 信じる
-    {"TNA-SNI", "だん", 'z', VERB_TYPE_KAMI},      // 断じる
-    // m行 1コ
-    {"KA-SKNI", "かんが", 'm', VERB_TYPE_KAMI},    // 鑑みる
-    // 下一段活用
-    // k行 4コ
-    {"KI-SKAU", "きをつ", 'k', VERB_TYPE_SIMO},    // 気をつける
-    {"T-KIA", "たす", 'k', VERB_TYPE_SIMO},        // 助ける
-    {"TU-TN", "つづ", 'k', VERB_TYPE_SIMO},        // 続ける
-    {"TN-KIA", "つづ", 'k', VERB_TYPE_SIMO},       // 続ける
-    // g行 1コ
-    {"K-KNIA", "かか", 'g', VERB_TYPE_SIMO},       // 掲げる
-    // s行 2コ
-    {"A-SKA", "あわ", 's', VERB_TYPE_SIMO},       // 合わせる
-    {"SKNA-KA", "まか", 's', VERB_TYPE_SIMO},      // 任せる
-    // d行 1コ
-    {"TN-", "", 'd', VERB_TYPE_SIMO},              // 出る
-    // b行 2コ
-    {"KU-STA", "くら", 'b', VERB_TYPE_SIMO},       // 比べる
-    {"SI-STA", "しら", 'b', VERB_TYPE_SIMO},       // 調べる
-    // m行 4コ
-    {"SA-TNA", "さだ", 'm', VERB_TYPE_SIMO},       // 定める
-    {"TA-SI", "たしか", 'm', VERB_TYPE_SIMO},      // 確かめる
-    {"TKA-SNI", "はじ", 'm', VERB_TYPE_SIMO},      // 始める
-    {"SKNAU-TAU", "もと", 'm', VERB_TYPE_SIMO},    // 求める
-    // r行 5コ
-    {"U-SKNAU", "うも", 'r', VERB_TYPE_SIMO},      // 埋もれる
-    {"KAU-STIA", "こわ", 'r', VERB_TYPE_SIMO},     // 壊れる
-    {"NA-KNA", "なが", 'r', VERB_TYPE_SIMO},       // 流れる
-    {"TKA-SNU", "はず", 'r', VERB_TYPE_SIMO},      // 外れる
-    {"SKA-SU", "わす", 'r', VERB_TYPE_SIMO},       // 忘れる
-    // w行 10コ
-    {"AU-SA", "おさ", 'w', VERB_TYPE_SIMO},        // 抑える
-    {"AU-SI", "おし", 'w', VERB_TYPE_SIMO},        // 教える
-    {"AU-TKNAU", "おぼ", 'w', VERB_TYPE_SIMO},     // 覚える
-    {"KA-KNA", "かんが", 'w', VERB_TYPE_SIMO},     // 考える
-    {"KA-", "かんが", 'w', VERB_TYPE_SIMO},        // 考える
-    {"KI-TA", "きた", 'w', VERB_TYPE_SIMO},        // 鍛える
-    {"KU-SKA", "くわ", 'w', VERB_TYPE_SIMO},       // 加える
-    {"KAU-TA", "こた", 'w', VERB_TYPE_SIMO},       // 答える
-    {"SA-SA", "ささ", 'w', VERB_TYPE_SIMO},        // 支える
-    {"SKNA-KNA", "まちが", 'w', VERB_TYPE_SIMO},   // 間違える
-    // 特殊活用
-    {"I-K", "", '\0', VERB_TYPE_SPECIAL},          // 行く（特殊）
-    {"A-", "", '\0', VERB_TYPE_SPECIAL},           // ある（特殊）
-    {"K-", "", '\0', VERB_TYPE_KAHEN},             // 来る（カ変）
-};
-
-#define VERB_DICT_SIZE (sizeof(verb_dict) / sizeof(verb_dict[0]))
-
-// 「です」の活用マップ
-typedef struct {
-    const char *particle;  // right_particle
-    const char *output;    // 出力
-} desu_conjugate_t;
-
-static const desu_conjugate_t desu_conjugate[] = {
-    {"", "です"},
-    {"n", "でして"},
-    {"t", "でした"},
-    {"k", "でしょう"},
-    {"nt", "です."},
-    {"nk", "ですが"},
-    {"tk", "ですか?"},
-    {"ntk", "ですね"},
-    {NULL, NULL}
-};
-
-// 助詞の追加音（ん/つ/く/っ/ち/き/ー）を取得
-static const char *get_particle_extra(const char *particle) {
-    static const char *particle_key_list[] = {"", "n", "t", "k", "tk", "nt", "nk", "ntk"};
-    static const char *second_sound_list[] = {"", "ん", "つ", "く", "っ", "ち", "き", "ー"};
-
-    for (size_t i = 0; i < sizeof(particle_key_list) / sizeof(particle_key_list[0]); i++) {
-        if (strcmp(particle, particle_key_list[i]) == 0) {
-            return second_sound_list[i];
-        }
+    if (MK_COL(c) > MK_DAN_O) {
+        return '\0';
     }
-    return "";
+    return kana_row_gyou[MK_ROW(c)];
 }
 
-// 補助動詞・助動詞マップ
-typedef struct {
-    const char *pattern;  // left_particle-right_particle
-    int conj_form;        // 活用形
-    const char *suffix;   // 接尾辞
-} auxiliary_map_t;
-
-static const auxiliary_map_t auxiliary_exception[] = {
-    {"nt-", CONJ_MASU, "たい"}, // ～たい
-    {"nt-n", CONJ_MASU, "たくない"}, // ～たい+否定
-    {"nt-t", CONJ_MASU, "たかった"}, // ～たい+過去
-    {"nt-nt", CONJ_MASU, "たくなかった"}, // ～たい+否定+過去
-    {"nt-k", CONJ_TE_TA, "てほしい"}, // ～ほしい
-    {"nt-nk", CONJ_TE_TA, "てほしくない"}, // ～ほしい+否定
-    {"nt-tk", CONJ_TE_TA, "てほしかった"}, // ～ほしい+過去
-    {"nt-ntk", CONJ_TE_TA, "てほしくなかった"}, // ～ほしい+否定+過去
-    {"tk-", CONJ_KANOU, "る"},              // 可能
-    {"tk-n", CONJ_KANOU, "ない"},           // 可能+否定
-    {"tk-t", CONJ_KANOU, "た"},             // 可能+過去
-    {"tk-k", CONJ_KANOU, "ます"},           // 可能+丁寧
-    {"tk-nt", CONJ_KANOU, "なかった"},      // 可能+否定+過去
-    {"tk-nk", CONJ_KANOU, "ません"},        // 可能+否定+丁寧
-    {"tk-tk", CONJ_KANOU, "ました"},        // 可能+過去+丁寧
-    {"tk-ntk", CONJ_KANOU, "て"},           // 可能+て
-    {"ntk-", CONJ_MASU, ""},                // 連用
-    {"ntk-n", CONJ_NAI, "ず"},              // 否定
-    {"ntk-t", CONJ_KATEI, "ば"},            // 仮定
-    {"ntk-k", CONJ_MASU, "ましょう"},           // 提案
-    {"ntk-nt", CONJ_NAI, "なければ"},       // 否定+仮定
-    {"ntk-nk", CONJ_NAI, "なく"},           // 否定+連用
-    {"ntk-tk", CONJ_TE_TA, "てください"},   // 丁寧命令
-    {"ntk-ntk", CONJ_IKOU, ""},               // 意向
-    {"", -1, ""}  // 終端
-};
+static mejiro_stroke_t verb_dict_codes[ARRAY_SIZE(mejiro_verb_dict)];
 
-// 左側補助動詞マップ: [活用形, 補助動詞の語幹, 活用段, 活用行]
-typedef struct {
-    const char *particle;
-    int conj_form;
-    const char *stem;
-    int verb_type;  // 1=五段, 2=上一段, 3=下一段
-    char gyou;
-} left_auxiliary_info_t;
-
-static const left_auxiliary_info_t left_auxiliary[] = {
-    {"n", CONJ_TE_TA, "て", 2, 'w'},      // ～ている
-    {"t", CONJ_SHIEKI, "", 3, 's'},        // ～させる（使役）
-    {"k", CONJ_UKEMI, "", 3, 'r'},        // ～られる（受身）
-    {"nk", CONJ_TE_TA, "てしま", 1, 'w'}, // ～てしまう
-    {NULL, -1, "", 1, '\0'}
-};
+#define P_N MJ_PN
+#define P_T MJ_PT
+#define P_K MJ_PK
 
-// 右側助動詞マップ
-typedef struct {
-    const char *particle;
-    int conj_form;
-    const char *suffix;
-} right_auxiliary_t;
-
-static const right_auxiliary_t right_auxiliary[] = {
-    {"", CONJ_JISHO, ""},
-    {"n", CONJ_NAI, "ない"},
-    {"t", CONJ_TE_TA, "た"},
-    {"k", CONJ_MASU, "ます"},
-    {"nt", CONJ_NAI, "なかった"},
-    {"nk", CONJ_MASU, "ません"},
-    {"tk", CONJ_MASU, "ました"},
-    {"ntk", CONJ_TE_TA, "て"},
-    {NULL, -1, ""}
-};
+static const char *get_particle_extra(uint8_t particle) {
+    return mejiro_second_sound[particle & 0x7];
+}
 
 // 左側補助動詞情報を取得
-static const left_auxiliary_info_t *get_left_auxiliary(const char *particle) {
-    if (particle == NULL) return NULL;
-    for (int i = 0; left_auxiliary[i].particle != NULL; i++) {
-        if (strcmp(particle, left_auxiliary[i].particle) == 0) {
-            return &left_auxiliary[i];
+static const left_auxiliary_info_t *get_left_auxiliary(uint8_t particle) {
+    for (size_t i = 0; mejiro_left_auxiliary[i].stem != NULL; i++) {
+        if (particle == mejiro_left_auxiliary[i].particle) {
+            return &mejiro_left_auxiliary[i];
         }
     }
     return NULL;
 }
 
 // 右側補助動詞情報を取得
-static const right_auxiliary_t *get_right_auxiliary(const char *particle) {
-    if (particle == NULL) return NULL;
-    for (int i = 0; right_auxiliary[i].particle != NULL; i++) {
-        if (strcmp(particle, right_auxiliary[i].particle) == 0) {
-            return &right_auxiliary[i];
-        }
-    }
-    return NULL;
+static const right_auxiliary_t *get_right_auxiliary(uint8_t particle) {
+    return &mejiro_right_auxiliary[particle & 0x7];
 }
 
 // 「です」の活用を取得
-static const char *get_desu_conjugate(const char *particle) {
-    if (particle == NULL) return NULL;
-    for (int i = 0; desu_conjugate[i].particle != NULL; i++) {
-        if (strcmp(particle, desu_conjugate[i].particle) == 0) {
-            return desu_conjugate[i].output;
-        }
-    }
-    return NULL;
+static const char *get_desu_conjugate(uint8_t particle) {
+    return mejiro_desu_conjugate[particle & 0x7];
 }
 
 // 活用形と助動詞を取得
-static void get_conjugation_info(const char *left_particle, const char *right_particle,
-                                 int *conj_form, char *suffix) {
-    char pattern[32];
-    snprintf(pattern, sizeof(pattern), "%s-%s", left_particle, right_particle);
-
+static void get_conjugation_info(uint8_t left_particle, uint8_t right_particle,
+                                 int *conj_form, const char **suffix) {
     // 例外パターンをチェック
-    for (int i = 0; auxiliary_exception[i].conj_form != -1; i++) {
-        if (strcmp(pattern, auxiliary_exception[i].pattern) == 0) {
-            *conj_form = auxiliary_exception[i].conj_form;
-            strcpy(suffix, auxiliary_exception[i].suffix);
+    for (size_t i = 0; mejiro_auxiliary_exception[i].suffix != NULL; i++) {
+        if (left_particle == mejiro_auxiliary_exception[i].left_particle &&
+            right_particle == mejiro_auxiliary_exception[i].right_particle) {
+            *conj_form = mejiro_auxiliary_exception[i].conj_form;
+            *suffix = mejiro_auxiliary_exception[i].suffix;
             return;
         }
     }
 
     // 右側助動詞マップ
-    for (int i = 0; right_auxiliary[i].particle != NULL; i++) {
-        if (strcmp(right_particle, right_auxiliary[i].particle) == 0) {
-            *conj_form = right_auxiliary[i].conj_form;
-            strcpy(suffix, right_auxiliary[i].suffix);
-            return;
-        }
+    const right_auxiliary_t *right_aux = get_right_auxiliary(right_particle);
+    if (right_aux != NULL) {
+        *conj_form = right_aux->conj_form;
+        *suffix = right_aux->suffix;
+        return;
     }
 
     // デフォルト
     *conj_form = CONJ_JISHO;
-    suffix[0] = '\0';
+    *suffix = "";
 }
 
     // 左側補助動詞を付与する共通処理
-    static void append_left_auxiliary(char *out, const left_auxiliary_info_t *left_aux, const right_auxiliary_t *right_aux) {
+    static void append_left_auxiliary(mejiro_sb_t *out, const left_auxiliary_info_t *left_aux, const right_auxiliary_t *right_aux) {
         if (left_aux == NULL) return;
 
-        strcat(out, left_aux->stem);
+        mejiro_sb_append(out, left_aux->stem);
 
         int aux_conj = (right_aux != NULL) ? right_aux->conj_form : CONJ_JISHO;
         if (left_aux->verb_type == 1) {
             int idx_aux = gyou_to_index(left_aux->gyou);
-            strcat(out, godan_conjugate[idx_aux][aux_conj]);
+            mejiro_sb_append(out, mejiro_godan_conjugate[idx_aux][aux_conj]);
         } else if (left_aux->verb_type == 2) {
             int idx_aux = gyou_to_index(left_aux->gyou);
-            strcat(out, kami_conjugate[idx_aux][aux_conj]);
+            mejiro_sb_append(out, mejiro_kami_conjugate[idx_aux][aux_conj]);
         } else if (left_aux->verb_type == 3) {
             int idx_aux = gyou_to_index_simo(left_aux->gyou);
-            strcat(out, simo_conjugate[idx_aux][aux_conj]);
+            mejiro_sb_append(out, mejiro_simo_conjugate[idx_aux][aux_conj]);
         }
 
         if (right_aux != NULL) {
-            strcat(out, right_aux->suffix);
+            mejiro_sb_append(out, right_aux->suffix);
         }
     }
 
 // 撥音便（五段 g/n/b/m のて・た形）
-// stem_len: 語幹の長さ（バイト数）。
-static void apply_godan_te_ta_voicing(char *str, size_t stem_len) {
-    char *pos = str + stem_len;
-
-    // 語幹直後の「んて」 → 「んで」
-    if (strstr(pos, "んて") == pos) {
-        memcpy(pos, "んで", 6);
-    }
-    // 語幹直後の「いて」 → 「いで」
-    if (strstr(pos, "いて") == pos) {
-        memcpy(pos, "いで", 6);
+// stem_len: 語幹の長さ（仮名コード数）。
+static void apply_godan_te_ta_voicing(mejiro_sb_t *str, size_t stem_len) {
+    if (stem_len + 2 > str->len) {
+        return;
     }
+    const mejiro_kana_t first = (mejiro_kana_t)str->buf[stem_len];
+    const mejiro_kana_t second = (mejiro_kana_t)str->buf[stem_len + 1];
 
-    pos = str + stem_len;
-    // 語幹直後の「んた」 → 「んだ」
-    if (strstr(pos, "んた") == pos) {
-        memcpy(pos, "んだ", 6);
-    }
-    // 語幹直後の「いた」 → 「いだ」
-    if (strstr(pos, "いた") == pos) {
-        memcpy(pos, "いだ", 6);
+    // 語幹直後の「んて」「いて」「んた」「いた」 → 「んで」「いで」「んだ」「いだ」
+    if ((first == MK_NN || first == MK_KANA(MK_ROW_A, MK_DAN_I)) &&
+        (second == MK_KANA(MK_ROW_T, MK_DAN_E) || second == MK_KANA(MK_ROW_T, MK_DAN_A))) {
+        str->buf[stem_len + 1] = (char)MK_KANA(MK_ROW_D, MK_COL(second));
     }
 }
 
-static void apply_sahen_negative_zu(char *str, int conj_form, const char *suffix) {
-    if (conj_form != CONJ_NAI || strcmp(suffix, "ず") != 0) {
+static void apply_sahen_negative_zu(mejiro_sb_t *str, int conj_form, const char *suffix) {
+    // 接尾辞が「ず」だけのとき
+    if (conj_form != CONJ_NAI || (mejiro_kana_t)suffix[0] != MK_KANA(MK_ROW_Z, MK_DAN_U) ||
+        suffix[1] != '\0') {
         return;
     }
 
-    size_t len = strlen(str);
-    if (len >= 6 && strcmp(str + len - 6, "しず") == 0) {
-        memcpy(str + len - 6, "せず", 6);
+    // 「しず」 → 「せず」
+    if (str->len >= 2 && (mejiro_kana_t)str->buf[str->len - 2] == MK_KANA(MK_ROW_S, MK_DAN_I) &&
+        (mejiro_kana_t)str->buf[str->len - 1] == MK_KANA(MK_ROW_Z, MK_DAN_U)) {
+        str->buf[str->len - 2] = (char)MK_KANA(MK_ROW_S, MK_DAN_E);
     }
 }
 
 // メイン動詞活用関数
-verb_result_t mejiro_verb_conjugate(const char *left_conso, const char *left_vowel,
-                                    const char *left_particle,
-                                    const char *right_conso, const char *right_vowel,
-                                    const char *right_particle,
+// left/right: 各半分のストロークコード（子音・母音・助詞）
+// left_kana/right_kana と結果は仮名コード列
+verb_result_t mejiro_verb_conjugate(uint16_t left, uint16_t right,
                                     const char *left_kana, const char *right_kana) {
     verb_result_t result = {{0}, false};
+    mejiro_sb_t out;
+    mejiro_sb_init(&out, result.output, sizeof(result.output));
+
+    const uint8_t left_particle = MJ_HALF_PARTICLE(left);
+    const uint8_t right_conso = MJ_HALF_CONSO(right);
+    const uint8_t right_vowel = MJ_HALF_VOWEL(right);
+    const uint8_t right_particle = MJ_HALF_PARTICLE(right);
 
-    char stroke[64];
-    snprintf(stroke, sizeof(stroke), "%s%s-%s%s", left_conso, left_vowel, right_conso, right_vowel);
+    const mejiro_stroke_t stroke =
+        MJ_STROKE(left & MJ_HALF_KANA_MASK, right & MJ_HALF_KANA_MASK);
 
     const left_auxiliary_info_t *left_aux = get_left_auxiliary(left_particle);
     const right_auxiliary_t *right_aux = get_right_auxiliary(right_particle);
 
     int conj_form = CONJ_JISHO;
-    char suffix[64] = {0};
+    const char *suffix = "";
     if (left_aux != NULL) {
         conj_form = left_aux->conj_form;
-        suffix[0] = '\0';
     } else {
-        get_conjugation_info(left_particle, right_particle, &conj_form, suffix);
+        get_conjugation_info(left_particle, right_particle, &conj_form, &suffix);
     }
 
-    // 「です」処理: right_conso == 'TN' && strlen(right_vowel) == 0
-    if (strcmp(right_conso, "TN") == 0 && strlen(right_vowel) == 0) {
-        char base[128] = {0};
-        strcat(base, left_kana);
+    // 「です」処理: right_conso == 'TN' && right_vowel なし
+    if (right_conso == (MJ_T | MJ_N) && right_vowel == 0) {
+        mejiro_sb_set(&out, left_kana);
         // 左側の助詞追加音は含める（例: TAn-TN* → たんです）
-        strcat(base, get_particle_extra(left_particle));
+        mejiro_sb_append(&out, get_particle_extra(left_particle));
         // 右側の助詞追加音は含めない（例: -TNk* → でしょう）
 
-        strcpy(result.output, base);
         const char *desu_form = get_desu_conjugate(right_particle);
         if (desu_form != NULL) {
-            strcat(result.output, desu_form);
-            result.success = true;
+            mejiro_sb_append(&out, desu_form);
+            result.success = !out.truncated;
             return result;
         }
     }
 
-    // 「いう」処理: right_vowel == 'IU' && strlen(right_conso) == 0
-    if (strlen(right_conso) == 0 && strcmp(right_vowel, "IU") == 0) {
+    // 「いう」処理: right_vowel == 'IU' && right_conso なし
+    if (right_conso == 0 && right_vowel == (MJ_I | MJ_U)) {
         const right_auxiliary_t *iu_right_aux = get_right_auxiliary(right_particle);
         int iu_conj_form = CONJ_JISHO;
         const char *iu_suffix = "";
@@ -953,172 +393,182 @@ verb_result_t mejiro_verb_conjugate(const char *left_conso, const char *left_vow
             iu_suffix = iu_right_aux->suffix;
         }
 
-        strcpy(result.output, left_kana);
-        strcat(result.output, get_particle_extra(left_particle));
+        mejiro_sb_set(&out, left_kana);
+        mejiro_sb_append(&out, get_particle_extra(left_particle));
 
         int idx = gyou_to_index('w');
-        strcat(result.output, "い");
-        strcat(result.output, godan_conjugate[idx][iu_conj_form]);
-        strcat(result.output, iu_suffix);
-        result.success = true;
+        mejiro_sb_push(&out, (char)MK_KANA(MK_ROW_A, MK_DAN_I));
+        mejiro_sb_append(&out, mejiro_godan_conjugate[idx][iu_conj_form]);
+        mejiro_sb_append(&out, iu_suffix);
+        result.success = !out.truncated;
         return result;
     }
 
     const verb_entry_t *verb = NULL;
-    for (size_t i = 0; i < VERB_DICT_SIZE; i++) {
-        if (strcmp(stroke, verb_dict[i].stroke) == 0) {
-            verb = &verb_dict[i];
+    for (size_t i = 0; mejiro_verb_dict[i].stroke != NULL; i++) {
+        if (stroke == verb_dict_codes[i]) {
+            verb = &mejiro_verb_dict[i];
             break;
         }
     }
 
     // 辞書にある場合
     if (verb != NULL) {
+        size_t stem_len = 0;
         if (verb->type == VERB_TYPE_SPECIAL) {
-            if (strcmp(stroke, "I-K") == 0) {
-                strcpy(result.output, iku_conjugate[conj_form]);
-            } else if (strcmp(stroke, "A-") == 0) {
-                strcpy(result.output, aru_conjugate[conj_form]);
+            if (stroke == MJ_STROKE(MJ_HALF(0, MJ_I, 0), MJ_HALF(MJ_K, 0, 0))) {
+                mejiro_sb_set(&out, mejiro_iku_conjugate[conj_form]);
+            } else if (stroke == MJ_STROKE(MJ_HALF(0, MJ_A, 0), 0)) {
+                mejiro_sb_set(&out, mejiro_aru_conjugate[conj_form]);
             } else {
                 return result;
             }
         } else {
-            strcpy(result.output, verb->stem);
+            mejiro_sb_set(&out, verb->stem);
+            stem_len = out.len;
             if (verb->type == VERB_TYPE_GODAN) {
                 int idx = gyou_to_index(verb->gyou);
-                strcat(result.output, godan_conjugate[idx][conj_form]);
+                mejiro_sb_append(&out, mejiro_godan_conjugate[idx][conj_form]);
             } else if (verb->type == VERB_TYPE_KAMI) {
                 int idx = gyou_to_index(verb->gyou);
-                strcat(result.output, kami_conjugate[idx][conj_form]);
+                mejiro_sb_append(&out, mejiro_kami_conjugate[idx][conj_form]);
             } else if (verb->type == VERB_TYPE_SIMO) {
                 int idx = gyou_to_index_simo(verb->gyou);
-                strcat(result.output, simo_conjugate[idx][conj_form]);
+                mejiro_sb_append(&out, mejiro_simo_conjugate[idx][conj_form]);
             } else if (verb->type == VERB_TYPE_KAHEN) {
-                strcat(result.output, kahen_conjugate[conj_form]);
+                mejiro_sb_append(&out, mejiro_kahen_conjugate[conj_form]);
             }
         }
 
         if (left_aux != NULL) {
-            append_left_auxiliary(result.output, left_aux, right_aux);
+            append_left_auxiliary(&out, left_aux, right_aux);
         } else {
-            strcat(result.output, suffix);
+            mejiro_sb_append(&out, suffix);
         }
         if (conj_form == CONJ_TE_TA) {
             if (verb != NULL && verb->type == VERB_TYPE_GODAN && (verb->gyou == 'g' || verb->gyou == 'n' || verb->gyou == 'b' || verb->gyou == 'm')) {
-                apply_godan_te_ta_voicing(result.output, strlen(verb->stem));
+                apply_godan_te_ta_voicing(&out, stem_len);
             }
         }
 
         // 「ある」で「ず」単体になった場合を「あらず」に変換
-        if (verb != NULL && verb->type == VERB_TYPE_SPECIAL && strcmp(stroke, "A-") == 0 && strcmp(result.output, "ず") == 0) {
-            strcpy(result.output, "あらず");
+        if (verb != NULL && verb->type == VERB_TYPE_SPECIAL && stroke == MJ_STROKE(MJ_HALF(0, MJ_A, 0), 0) && out.len == 1 && (mejiro_kana_t)out.buf[0] == MK_KANA(MK_ROW_Z, MK_DAN_U)) {
+            mejiro_sb_clear(&out);
+            mejiro_sb_push(&out, (char)MK_KANA(MK_ROW_A, MK_DAN_A));
+            mejiro_sb_push(&out, (char)MK_KANA(MK_ROW_R, MK_DAN_A));
+            mejiro_sb_push(&out, (char)MK_KANA(MK_ROW_Z, MK_DAN_U));
         }
 
-        result.success = true;
+        result.success = !out.truncated;
         return result;
     }
 
     // 辞書に無い場合、入力パターンから動詞を推論
-    if (strlen(right_kana) == 0) {
-        if (strlen(left_kana) > 0) {
-            strcpy(result.output, left_kana);
+    if (right_kana[0] == '\0') {
+        if (left_kana[0] != '\0') {
+            mejiro_sb_set(&out, left_kana);
         } else {
-            result.output[0] = '\0';
+            mejiro_sb_clear(&out);
         }
-        strcat(result.output, sahen_conjugate[conj_form]);
+        mejiro_sb_append(&out, mejiro_sahen_conjugate[conj_form]);
         if (left_aux != NULL) {
-            append_left_auxiliary(result.output, left_aux, right_aux);
+            append_left_auxiliary(&out, left_aux, right_aux);
         } else {
-            strcat(result.output, suffix);
+            mejiro_sb_append(&out, suffix);
         }
-        apply_sahen_negative_zu(result.output, conj_form, suffix);
-        result.success = true;
+        apply_sahen_negative_zu(&out, conj_form, suffix);
+        result.success = !out.truncated;
         return result;
     }
 
-    if (strlen(right_conso) > 0 && strlen(right_vowel) == 0 && strlen(right_kana) > 0) {
+    if (right_conso != 0 && right_vowel == 0 && right_kana[0] != '\0') {
         char gyou = kana_to_gyou(right_kana);
         if (gyou != '\0' && (gyou == 'k' || gyou == 'g' || gyou == 's' || gyou == 't' ||
                               gyou == 'n' || gyou == 'b' || gyou == 'm' || gyou == 'r' || gyou == 'w')) {
-            if (strlen(left_kana) > 0) {
-                strcpy(result.output, left_kana);
+            if (left_kana[0] != '\0') {
+                mejiro_sb_set(&out, left_kana);
             } else {
-                result.output[0] = '\0';
+                mejiro_sb_clear(&out);
             }
             int idx = gyou_to_index(gyou);
-            strcat(result.output, godan_conjugate[idx][conj_form]);
+            mejiro_sb_append(&out, mejiro_godan_conjugate[idx][conj_form]);
             if (left_aux != NULL) {
-                append_left_auxiliary(result.output, left_aux, right_aux);
+                append_left_auxiliary(&out, left_aux, right_aux);
             } else {
-                strcat(result.output, suffix);
+                mejiro_sb_append(&out, suffix);
             }
             if (conj_form == CONJ_TE_TA && (gyou == 'g' || gyou == 'n' || gyou == 'b' || gyou == 'm')) {
-                apply_godan_te_ta_voicing(result.output, strlen(left_kana));
+                apply_godan_te_ta_voicing(&out, strlen(left_kana));
             }
-            result.success = true;
+            result.success = !out.truncated;
             return result;
         }
     }
 
-    if (strcmp(right_vowel, "I") == 0) {
+    if (right_vowel == MJ_I) {
         char gyou = kana_to_gyou(right_kana);
         int idx = gyou_to_index(gyou);
-        if (gyou != '\0' && idx < 9 && kami_conjugate[idx][CONJ_JISHO][0] != '\0') {
-            if (strlen(left_kana) > 0) {
-                strcpy(result.output, left_kana);
+        if (gyou != '\0' && idx < 9 && mejiro_kami_conjugate[idx][CONJ_JISHO][0] != '\0') {
+            if (left_kana[0] != '\0') {
+                mejiro_sb_set(&out, left_kana);
             } else {
-                result.output[0] = '\0';
+                mejiro_sb_clear(&out);
             }
-            strcat(result.output, kami_conjugate[idx][conj_form]);
+            mejiro_sb_append(&out, mejiro_kami_conjugate[idx][conj_form]);
             if (left_aux != NULL) {
-                append_left_auxiliary(result.output, left_aux, right_aux);
+                append_left_auxiliary(&out, left_aux, right_aux);
             } else {
-                strcat(result.output, suffix);
+                mejiro_sb_append(&out, suffix);
             }
-            result.success = true;
+            result.success = !out.truncated;
             return result;
         }
     }
 
-    if (strcmp(right_vowel, "IA") == 0) {
+    if (right_vowel == (MJ_I | MJ_A)) {
         char gyou = kana_to_gyou(right_kana);
         int idx = gyou_to_index_simo(gyou);
-        if (gyou != '\0' && idx < 12 && simo_conjugate[idx][CONJ_JISHO][0] != '\0') {
-            if (strlen(left_kana) > 0) {
-                strcpy(result.output, left_kana);
+        if (gyou != '\0' && idx < 12 && mejiro_simo_conjugate[idx][CONJ_JISHO][0] != '\0') {
+            if (left_kana[0] != '\0') {
+                mejiro_sb_set(&out, left_kana);
             } else {
-                result.output[0] = '\0';
+                mejiro_sb_clear(&out);
             }
-            strcat(result.output, simo_conjugate[idx][conj_form]);
+            mejiro_sb_append(&out, mejiro_simo_conjugate[idx][conj_form]);
             if (left_aux != NULL) {
-                append_left_auxiliary(result.output, left_aux, right_aux);
+                append_left_auxiliary(&out, left_aux, right_aux);
             } else {
-                strcat(result.output, suffix);
+                mejiro_sb_append(&out, suffix);
             }
-            result.success = true;
+            result.success = !out.truncated;
             return result;
         }
     }
 
-    if (strlen(right_conso) > 0 || strlen(right_vowel) > 0) {
-        if (strlen(left_kana) > 0) {
-            strcpy(result.output, left_kana);
-            strcat(result.output, right_kana);
+    if (right_conso != 0 || right_vowel != 0) {
+        if (left_kana[0] != '\0') {
+            mejiro_sb_set(&out, left_kana);
+            mejiro_sb_append(&out, right_kana);
         } else {
-            strcpy(result.output, right_kana);
+            mejiro_sb_set(&out, right_kana);
         }
         int idx = gyou_to_index('r');
-        strcat(result.output, godan_conjugate[idx][conj_form]);
-        char *gozari_pos = strstr(result.output, "ござり");
-        if (gozari_pos) {
-            memcpy(gozari_pos + 6, "い", 3);
+        mejiro_sb_append(&out, mejiro_godan_conjugate[idx][conj_form]);
+        // 「ござり」 → 「ござい」
+        for (size_t i = 0; i + 2 < out.len; i++) {
+            if ((mejiro_kana_t)out.buf[i] == MK_KANA(MK_ROW_G, MK_DAN_O) &&
+                (mejiro_kana_t)out.buf[i + 1] == MK_KANA(MK_ROW_Z, MK_DAN_A) &&
+                (mejiro_kana_t)out.buf[i + 2] == MK_KANA(MK_ROW_R, MK_DAN_I)) {
+                out.buf[i + 2] = (char)MK_KANA(MK_ROW_A, MK_DAN_I);
+                break;
+            }
         }
         if (left_aux != NULL) {
-            append_left_auxiliary(result.output, left_aux, right_aux);
+            append_left_auxiliary(&out, left_aux, right_aux);
         } else {
-            strcat(result.output, suffix);
+            mejiro_sb_append(&out, suffix);
         }
-        result.success = true;
+        result.success = !out.truncated;
         return result;
     }
 
@@ -1127,15 +577,6 @@ verb_result_t mejiro_verb_conjugate(const char *left_conso, const char *left_vow
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 extern int64_t timestamp;
-static int64_t mejiro_synth_timestamp = 0;
-
-static inline int64_t next_mejiro_synth_timestamp(void) {
-    if (mejiro_synth_timestamp < timestamp) {
-        mejiro_synth_timestamp = timestamp;
-    }
-    mejiro_synth_timestamp++;
-    return mejiro_synth_timestamp;
-}
 
 #ifndef NONE
 #define NONE 0
@@ -1146,6 +587,13 @@ static NGListArray nginput;
 static uint32_t pressed_keys = 0UL;
 static int8_t n_pressed_keys = 0;
 static uint32_t chord_keys = 0UL;
+/* First-up mode: commit on the first release. The keys still held move to
+ * committed_keys and their releases are ignored. With rollover, new presses
+ * meanwhile start the next chord; without it they are ignored until all keys are up.
+ */
+static bool first_up_mode = false;
+static bool rollover_mode = false;
+static uint32_t committed_keys = 0UL;
 
 #define NG_WINDOWS 0
 #define NG_MACOS 1
@@ -1159,37 +607,51 @@ typedef union {
 
 extern user_config_t naginata_config;
 
-static inline void tap_key(uint32_t keycode) {
-    int64_t ts_press = next_mejiro_synth_timestamp();
-    int64_t ts_release = next_mejiro_synth_timestamp();
-    (void)raise_zmk_keycode_state_changed_from_encoded(keycode, true, ts_press);
-    (void)raise_zmk_keycode_state_changed_from_encoded(keycode, false, ts_release);
-}
-
-static inline void press_key(uint32_t keycode) {
-    (void)raise_zmk_keycode_state_changed_from_encoded(keycode, true, next_mejiro_synth_timestamp());
-}
-
-static inline void release_key(uint32_t keycode) {
-    (void)raise_zmk_keycode_state_changed_from_encoded(keycode, false, next_mejiro_synth_timestamp());
-}
+static inline void tap_key(uint32_t keycode) { naginata_emit_tap(keycode, NAGINATA_PACE_NONE); }
 
-static inline void mod_tap(uint32_t mod_keycode, uint32_t keycode) {
-    press_key(mod_keycode);
-    tap_key(keycode);
-    release_key(mod_keycode);
-}
+static inline void press_key(uint32_t keycode) { naginata_emit_press(keycode); }
 
-#ifndef MEJIRO_ROMA_KEY_DELAY_MS
-#define MEJIRO_ROMA_KEY_DELAY_MS 25
-#endif
+static inline void release_key(uint32_t keycode) { naginata_emit_release(keycode); }
 
-static void send_mejiro_roma(const char *output);
+/* Romaji pacing.
+ * kana_to_roma_zmk tags every output char with the boundary that follows it.
+ * Keys inside one kana ("k" of "ka") only need the short intra-kana delay;
+ * kana ends, the first "n" of ん and sokuon get the inter-kana delay.
+ * The delays themselves come from the emitter's profile for the IME state.
+ */
+#define MEJIRO_PACE_KANA_END 0x01
+#define MEJIRO_PACE_AMBIG_N 0x02
+#define MEJIRO_PACE_SOKUON 0x04
+/* with KANA_END: how many kana end at this char (きょ = 2, a doubled っ adds 1) */
+#define MEJIRO_PACE_KANA(n) ((uint8_t)((n) << 3))
+#define MEJIRO_PACE_KANA_COUNT(p) ((p) >> 3)
+
+/* One key of a compiled romaji burst: keyboard page usage, shift and pace class. */
+typedef struct {
+    uint8_t usage;
+    uint8_t flags;
+} mejiro_key_t;
+
+#define MEJIRO_KEY_PACE_MASK 0x03
+#define MEJIRO_KEY_END_N 0x04 /* second n of a ん that ends the stroke (romaji) */
+#define MEJIRO_KEY_KANA_MASK 0x18 /* kana completed by this key, 0-3 (undo cut points) */
+#define MEJIRO_KEY_KANA(n) ((uint8_t)(MIN((n), 3) << 3))
+#define MEJIRO_KEY_KANA_COUNT(f) (((f) & MEJIRO_KEY_KANA_MASK) >> 3)
+#define MEJIRO_KEY_ALT 0x20
+#define MEJIRO_KEY_CTRL 0x40
+#define MEJIRO_KEY_SHIFT 0x80
+#define MEJIRO_KEY_MODS (MEJIRO_KEY_ALT | MEJIRO_KEY_CTRL | MEJIRO_KEY_SHIFT)
+
+static void send_mejiro_keys(const mejiro_key_t *keys, size_t n, uint8_t times);
+static void send_mejiro_priority_keys(const mejiro_key_t *keys, size_t n, uint8_t times);
+static void mejiro_flush_staged(const mejiro_key_t *next, uint16_t next_count);
+static void mejiro_speculate(uint32_t chord);
+static void mejiro_tables_init(void);
 static void send_mejiro_command_string(const char *s);
+static void mejiro_toggle_output_mode(void);
 void mejiro_clear_pending_tsu_zmk(void);
 static uint32_t keycode_from_ascii_basic(char c);
-static uint32_t keycode_from_ascii_letter(char c);
-static void apply_sahen_negative_zu(char *str, int conj_form, const char *suffix);
+static void apply_sahen_negative_zu(mejiro_sb_t *str, int conj_form, const char *suffix);
 
 /* --------------------------------------------------------------------------
  * Mejiro command table (ZMK port)
@@ -1198,7 +660,10 @@ static void apply_sahen_negative_zu(char *str, int conj_form, const char *suffix
  * Here we keep the same stroke strings and send the equivalent ZMK keycodes.
  * -------------------------------------------------------------------------- */
 
-static char g_mejiro_last_output[256];
+static mejiro_key_t g_mejiro_last_keys[256];
+static uint16_t g_mejiro_last_key_count = 0;
+/* keys of the stroke being committed */
+static mejiro_key_t mejiro_burst[256];
 static uint16_t g_mejiro_history_len[32];
 static uint8_t g_mejiro_history_count = 0;
 static uint16_t g_mejiro_last_units = 0;
@@ -1227,10 +692,16 @@ typedef enum {
     MJ_CMD_STRING,
     MJ_CMD_REPEAT,
     MJ_CMD_UNDO,
+    MJ_CMD_PACE_UP,     /* keycode = enum naginata_pace to step */
+    MJ_CMD_PACE_DOWN,
+    MJ_CMD_PACE_REPORT,
+    MJ_CMD_OUTPUT_MODE, /* toggle romaji / JIS kana-input output */
+    MJ_CMD_REPEAT_COUNT, /* the next stroke is sent one more time */
+    MJ_CMD_UNICODE,     /* string = UTF-8, one OS Unicode input session (input_unicode_string) */
 } mj_cmd_kind_t;
 
 typedef struct {
-    const char *stroke;
+    const char *stroke; /* resolved to mejiro_command_codes at init */
     mj_cmd_kind_t kind;
     uint32_t keycode;
     uint32_t mod;
@@ -1255,6 +726,29 @@ static const mj_cmd_t mejiro_commands_zmk[] = {
     {"#-t",    MJ_CMD_KEY,      MJ_KC(HID_USAGE_KEY_KEYBOARD_LANG1), 0, 0, NULL},
     {"#-k",    MJ_CMD_KEY,      MJ_KC(HID_USAGE_KEY_KEYBOARD_LANG2), 0, 0, NULL},
 
+    /*
+     * pacing calibration (current IME state): Y/N inter-kana +/-, K/A intra-kana +/-, I types "intra/inter".
+     * Right consonant/vowel + t has no output of its own, so # (send twice) shadows nothing here.
+     */
+    {"#-Yt",   MJ_CMD_PACE_UP,     NAGINATA_PACE_INTER_KANA, 0, 0, NULL},
+    {"#-Nt",   MJ_CMD_PACE_DOWN,   NAGINATA_PACE_INTER_KANA, 0, 0, NULL},
+    {"#-Kt",   MJ_CMD_PACE_UP,     NAGINATA_PACE_INTRA_KANA, 0, 0, NULL},
+    {"#-At",   MJ_CMD_PACE_DOWN,   NAGINATA_PACE_INTRA_KANA, 0, 0, NULL},
+    {"#-It",   MJ_CMD_PACE_REPORT, 0, 0, 0, NULL},
+
+    /* output backend: romaji <-> JIS kana input (switch the IME's input method to match); -Tt alone sends nothing */
+    {"#-Tt",   MJ_CMD_OUTPUT_MODE, 0, 0, 0, NULL},
+
+    /*
+     * repeat modifier: each one sends the next stroke once more (# strokes: x3, x4, ...).
+     * Not #-S*: -S* is the SQT proxy's stroke and # has to double it.
+     */
+    {"#-St",   MJ_CMD_REPEAT_COUNT, 0, 0, 0, NULL},
+
+    /* symbols with no romaji spelling, through the OS Unicode input; # + right keys + t as above */
+    {"#-IAUt", MJ_CMD_UNICODE,  0, 0, 0, "……"},
+    {"#-TKNYt",MJ_CMD_UNICODE,  0, 0, 0, "――"},
+
     {"-AU",    MJ_CMD_KEY,      MJ_KC(HID_USAGE_KEY_KEYBOARD_DELETE_BACKSPACE), 0, 0, NULL},
     {"-IU",    MJ_CMD_KEY,      MJ_KC(HID_USAGE_KEY_KEYBOARD_DELETE_FORWARD), 0, 0, NULL},
     {"-S",     MJ_CMD_KEY,      MJ_KC(HID_USAGE_KEY_KEYBOARD_ESCAPE), 0, 0, NULL},
@@ -1323,120 +817,135 @@ static const mj_cmd_t mejiro_commands_zmk[] = {
     {"n-nk",   MJ_CMD_STRING,   0, 0, 0, "!"},
 };
 
-static bool handle_mejiro_command(const char *stroke) {
-    if (!stroke || stroke[0] == '\0') {
-        return false;
-    }
+static mejiro_stroke_t mejiro_command_codes[ARRAY_SIZE(mejiro_commands_zmk)];
+static uint16_t mejiro_compile_command(const mj_cmd_t *cmd, mejiro_key_t *keys, size_t max_keys);
 
+static const mj_cmd_t *mejiro_find_command(mejiro_stroke_t stroke) {
     for (size_t i = 0; i < ARRAY_SIZE(mejiro_commands_zmk); i++) {
-        if (strcmp(mejiro_commands_zmk[i].stroke, stroke) != 0) {
-            continue;
+        if (mejiro_command_codes[i] == stroke) {
+            return &mejiro_commands_zmk[i];
         }
+    }
+    return NULL;
+}
 
-        switch (mejiro_commands_zmk[i].kind) {
-        case MJ_CMD_REPEAT:
-            if (g_mejiro_last_output[0] != '\0') {
-                send_mejiro_roma(g_mejiro_last_output);
-                mejiro_history_push(g_mejiro_last_units > 0 ? g_mejiro_last_units
-                                                           : (uint16_t)strlen(g_mejiro_last_output));
-            }
-            return true;
+/* Step a pacing delay (or not, for REPORT) and type back the current "intra/inter" values. */
+static void mejiro_pace_command(const mj_cmd_t *cmd) {
+    if (cmd->kind == MJ_CMD_PACE_UP) {
+        naginata_emit_adjust_profile((enum naginata_pace)cmd->keycode, CONFIG_NAGINATA_PACE_STEP_MS);
+    } else if (cmd->kind == MJ_CMD_PACE_DOWN) {
+        naginata_emit_adjust_profile((enum naginata_pace)cmd->keycode, -CONFIG_NAGINATA_PACE_STEP_MS);
+    }
+
+    struct naginata_pace_profile profile;
+    naginata_emit_get_profile(naginata_emit_ime_on(), &profile);
+
+    char report[16];
+    snprintf(report, sizeof(report), "%u/%u", profile.intra_kana_ms, profile.inter_kana_ms);
+    send_mejiro_command_string(report);
+}
+
+/*
+ * Cursor movement and deletion have no IME timing constraint, so they use the
+ * emitter's priority lane: still after the text queued before them, but not
+ * behind its pacing delays. Enter, Space (conversion), LANG and F7/F8 act on
+ * the IME's last input and stay paced.
+ */
+static bool mejiro_command_priority(const mj_cmd_t *cmd) {
+    if (cmd->kind != MJ_CMD_KEY && cmd->kind != MJ_CMD_MOD_KEY) {
+        return false;
+    }
+    switch (ZMK_HID_USAGE_ID(cmd->keycode)) {
+    case HID_USAGE_KEY_KEYBOARD_LEFTARROW:
+    case HID_USAGE_KEY_KEYBOARD_RIGHTARROW:
+    case HID_USAGE_KEY_KEYBOARD_UPARROW:
+    case HID_USAGE_KEY_KEYBOARD_DOWNARROW:
+    case HID_USAGE_KEY_KEYBOARD_HOME:
+    case HID_USAGE_KEY_KEYBOARD_END:
+    case HID_USAGE_KEY_KEYBOARD_DELETE_BACKSPACE:
+    case HID_USAGE_KEY_KEYBOARD_DELETE_FORWARD:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Run a table command `times` times (undo pops `times` entries; pace and mode commands run once). */
+static void mejiro_run_command(const mj_cmd_t *cmd, uint8_t times) {
+    switch (cmd->kind) {
+    case MJ_CMD_REPEAT:
+        if (g_mejiro_last_units > 0) {
+            naginata_emit_entry_begin();
+            send_mejiro_keys(g_mejiro_last_keys, g_mejiro_last_key_count, times);
+            naginata_emit_entry_end();
+            mejiro_history_push((uint16_t)(g_mejiro_last_units * times));
+        }
+        return;
 
-        case MJ_CMD_UNDO: {
+    case MJ_CMD_UNDO:
+        for (uint8_t r = 0; r < times; r++) {
             uint16_t n = mejiro_history_pop();
+            /* kana of the newest entry still in the emitter queue are dropped, not erased */
+            if (r == 0) {
+                n -= MIN(n, naginata_emit_cancel_entry());
+            }
             for (uint16_t k = 0; k < n; k++) {
                 tap_key(MJ_KC(HID_USAGE_KEY_KEYBOARD_DELETE_BACKSPACE));
             }
-            mejiro_clear_pending_tsu_zmk();
-            return true;
         }
+        mejiro_clear_pending_tsu_zmk();
+        return;
 
-        case MJ_CMD_KEY:
-            tap_key(mejiro_commands_zmk[i].keycode);
-            if (mejiro_commands_zmk[i].keycode == MJ_KC(HID_USAGE_KEY_KEYBOARD_DELETE_BACKSPACE) ||
-                mejiro_commands_zmk[i].keycode == MJ_KC(HID_USAGE_KEY_KEYBOARD_DELETE_FORWARD)) {
-                mejiro_clear_pending_tsu_zmk();
-            }
-            return true;
-
-        case MJ_CMD_MOD_KEY:
-            press_key(mejiro_commands_zmk[i].mod);
-            tap_key(mejiro_commands_zmk[i].keycode);
-            release_key(mejiro_commands_zmk[i].mod);
-            return true;
-
-        case MJ_CMD_MOD2_KEY:
-            press_key(mejiro_commands_zmk[i].mod);
-            press_key(mejiro_commands_zmk[i].mod2);
-            tap_key(mejiro_commands_zmk[i].keycode);
-            release_key(mejiro_commands_zmk[i].mod2);
-            release_key(mejiro_commands_zmk[i].mod);
-            return true;
-
-        case MJ_CMD_STRING:
-            send_mejiro_command_string(mejiro_commands_zmk[i].string);
-            return true;
-
-        default:
-            return true;
+    case MJ_CMD_KEY:
+    case MJ_CMD_MOD_KEY:
+    case MJ_CMD_MOD2_KEY:
+    case MJ_CMD_STRING: {
+        mejiro_key_t keys[64];
+        const uint16_t n = mejiro_compile_command(cmd, keys, ARRAY_SIZE(keys));
+        if (mejiro_command_priority(cmd)) {
+            send_mejiro_priority_keys(keys, n, times);
+        } else {
+            send_mejiro_keys(keys, n, times);
+        }
+        if (cmd->keycode == MJ_KC(HID_USAGE_KEY_KEYBOARD_DELETE_BACKSPACE) ||
+            cmd->keycode == MJ_KC(HID_USAGE_KEY_KEYBOARD_DELETE_FORWARD)) {
+            mejiro_clear_pending_tsu_zmk();
         }
+        return;
     }
 
-    return false;
-}
-
-
-static uint32_t keycode_from_ascii_letter(char c) {
-    if (c >= 'a' && c <= 'z') {
-        c = (char)(c - 'a' + 'A');
-    }
-    switch (c) {
-    case 'A': return A; case 'B': return B; case 'C': return C; case 'D': return D; case 'E': return E;
-    case 'F': return F; case 'G': return G; case 'H': return H; case 'I': return I; case 'J': return J;
-    case 'K': return K; case 'L': return L; case 'M': return M; case 'N': return N; case 'O': return O;
-    case 'P': return P; case 'Q': return Q; case 'R': return R; case 'S': return S; case 'T': return T;
-    case 'U': return U; case 'V': return V; case 'W': return W; case 'X': return X; case 'Y': return Y;
-    case 'Z': return Z;
-    default:  return NONE;
-    }
-}
+    case MJ_CMD_PACE_UP:
+    case MJ_CMD_PACE_DOWN:
+    case MJ_CMD_PACE_REPORT:
+        mejiro_pace_command(cmd);
+        return;
 
-static void send_ascii_letters_only(const char *s) {
-    for (const char *p = s; *p; p++) {
-        const char c = *p;
+    case MJ_CMD_OUTPUT_MODE:
+        mejiro_toggle_output_mode();
+        return;
 
-        /* Keep debug visibility for stroke symbols too (#, *, -). */
-        if (c == '#' || c == '*' || c == '-') {
-            switch (c) {
-        case '#': tap_key(Q); break;
-        case '*': tap_key(P); break;
-        case '-': tap_key(MINUS); break;
-        default: break;
-        }
-            continue;
+    case MJ_CMD_UNICODE:
+        for (uint8_t r = 0; r < times; r++) {
+            input_unicode_string(cmd->string);
         }
+        return;
 
-        uint32_t kc = keycode_from_ascii_letter(c);
-        if (kc != NONE) {
-            tap_key(kc);
-        }
+    default:
+        return;
     }
 }
 
-static void send_mejiro_output(const char *mejiro_id);
-static bool mejiro_contains_hash_local(const char *s);
-static void mejiro_remove_hash_local(const char *src, char *dst, size_t dst_sz);
-static bool execute_mejiro_command_exact_local(const char *stroke, bool doubled);
-static void process_mejiro_stroke_local(const char *stroke);
+static void send_mejiro_output(mejiro_stroke_t stroke, uint8_t times);
+static void process_mejiro_stroke_local(mejiro_stroke_t stroke);
 
 
 
-// Build "Mejiro stroke" (letters-only) from ng chord bits.
-// Output format (letters only):
-//   [Q?] <Lconso STKN> <Lvowel YIAU> <Lparticle ntk> X <Rconso STKN> <Rvowel YIAU> <Rparticle ntk> [P?]
-static void build_mejiro_id(uint32_t chord, char *out, size_t out_sz) {
-    size_t n = 0;
-    #define APP(ch) do { if (n + 1 < out_sz) out[n++] = (ch); } while (0)
+// Build the packed Mejiro stroke (see mejiro_stroke.h) from ng chord bits.
+// Bit layout per half: <conso STKN> <vowel YIAU> <particle ntk>, plus '#'(Q) and '*'(P).
+static mejiro_stroke_t build_mejiro_stroke(uint32_t chord) {
+    uint16_t left = 0;
+    uint16_t right = 0;
+    mejiro_stroke_t flags = 0;
 
     /*
      * Proxy key IDs for hard chords.
@@ -1446,9 +955,8 @@ static void build_mejiro_id(uint32_t chord, char *out, size_t out_sz) {
      *   DOT    -> -ntk
      *   SLASH  -> -nk
      *
-     * Safety rule:
-     *   when a proxy is active, suppress the overlapping physical keys on the
-     *   same side so we never generate duplicates like SS*, nnk, nntk, **, etc.
+     * When a proxy is active, the overlapping physical keys on the same side
+     * are suppressed, as in the QMK version.
      */
     const bool proxy_s_star    = (chord & B_SQT) != 0;
     const bool proxy_ntk_left  = (chord & B_Z) != 0;
@@ -1457,56 +965,52 @@ static void build_mejiro_id(uint32_t chord, char *out, size_t out_sz) {
     const bool proxy_nk_right  = (chord & B_DOT) != 0;
 
     // --- Left: consonants STKN (A,W,S,D) + vowels YIAU (E,R,F,(T|G)) + particles ntk (C,V,B) + optional '#'(Q)
-    if (chord & B_A) APP('S');   // A左S
-    if (chord & B_W) APP('T');   // W左T
-    if (chord & B_S) APP('K');   // S左K
-    if (chord & B_D) APP('N');   // D左N
-
-    if (chord & B_E) APP('Y');   // E左Y
-    if (chord & B_R) APP('I');   // R左I
-    if (chord & B_F) APP('A');   // F左A
-    if (chord & (B_T | B_G)) APP('U'); // T左U, G左U
+    if (chord & B_A) left |= MJ_HALF(MJ_S, 0, 0);   // A左S
+    if (chord & B_W) left |= MJ_HALF(MJ_T, 0, 0);   // W左T
+    if (chord & B_S) left |= MJ_HALF(MJ_K, 0, 0);   // S左K
+    if (chord & B_D) left |= MJ_HALF(MJ_N, 0, 0);   // D左N
 
-    // Left particles must come BEFORE '#', same as QMK: n t k #
-    if ((chord & B_C) && !proxy_ntk_left && !proxy_nk_left) APP('n');
-    if ((chord & B_V) && !proxy_ntk_left) APP('t');
-    if ((chord & B_B) && !proxy_ntk_left && !proxy_nk_left) APP('k');
+    if (chord & B_E) left |= MJ_HALF(0, MJ_Y, 0);   // E左Y
+    if (chord & B_R) left |= MJ_HALF(0, MJ_I, 0);   // R左I
+    if (chord & B_F) left |= MJ_HALF(0, MJ_A, 0);   // F左A
+    if (chord & (B_T | B_G)) left |= MJ_HALF(0, MJ_U, 0); // T左U, G左U
 
-    if (proxy_ntk_left) { APP('n'); APP('t'); APP('k'); }
-    else if (proxy_nk_left) { APP('n'); APP('k'); }
+    // Left particles ntk
+    if ((chord & B_C) && !proxy_ntk_left && !proxy_nk_left) left |= MJ_HALF(0, 0, MJ_PN);
+    if ((chord & B_V) && !proxy_ntk_left) left |= MJ_HALF(0, 0, MJ_PT);
+    if ((chord & B_B) && !proxy_ntk_left && !proxy_nk_left) left |= MJ_HALF(0, 0, MJ_PK);
 
-    if (chord & B_Q) APP('#');   // Q左# must be last on left side
+    if (proxy_ntk_left) left |= MJ_HALF(0, 0, MJ_PN | MJ_PT | MJ_PK);
+    else if (proxy_nk_left) left |= MJ_HALF(0, 0, MJ_PN | MJ_PK);
 
-    APP('-');
+    if (chord & B_Q) flags |= MJ_HASH;   // Q左#
 
     // --- Right: consonants STKN (SEMI,O,L,K) + vowels YIAU (I,U,J,(H|Y)) + particles ntk (COMMA,M,N) + optional '*'
-    // Right consonant S must be inserted in the consonant block, not at the end.
-    if ((chord & B_SEMI) && !proxy_s_star) APP('S'); // SEMI右S
-    if (proxy_s_star) APP('S');                      // SQT proxy gives right S
+    if ((chord & B_SEMI) && !proxy_s_star) right |= MJ_HALF(MJ_S, 0, 0); // SEMI右S
+    if (proxy_s_star) right |= MJ_HALF(MJ_S, 0, 0);                      // SQT proxy gives right S
 
-    if (chord & B_O) APP('T');    // O右T
-    if (chord & B_L) APP('K');    // L右K
-    if (chord & B_K) APP('N');    // K右N
+    if (chord & B_O) right |= MJ_HALF(MJ_T, 0, 0);    // O右T
+    if (chord & B_L) right |= MJ_HALF(MJ_K, 0, 0);    // L右K
+    if (chord & B_K) right |= MJ_HALF(MJ_N, 0, 0);    // K右N
 
-    if (chord & B_I) APP('Y');    // I右Y
-    if (chord & B_U) APP('I');    // U右I
-    if (chord & B_J) APP('A');    // J右A
-    if (chord & (B_H | B_Y)) APP('U'); // H右U, Y右U
+    if (chord & B_I) right |= MJ_HALF(0, MJ_Y, 0);    // I右Y
+    if (chord & B_U) right |= MJ_HALF(0, MJ_I, 0);    // U右I
+    if (chord & B_J) right |= MJ_HALF(0, MJ_A, 0);    // J右A
+    if (chord & (B_H | B_Y)) right |= MJ_HALF(0, MJ_U, 0); // H右U, Y右U
 
-    // Right particles must come BEFORE '*', same as QMK: n t k *
-    if ((chord & B_COMMA) && !proxy_ntk_right && !proxy_nk_right) APP('n');
-    if ((chord & B_M) && !proxy_ntk_right) APP('t');
-    if ((chord & B_N) && !proxy_ntk_right && !proxy_nk_right) APP('k');
+    // Right particles ntk
+    if ((chord & B_COMMA) && !proxy_ntk_right && !proxy_nk_right) right |= MJ_HALF(0, 0, MJ_PN);
+    if ((chord & B_M) && !proxy_ntk_right) right |= MJ_HALF(0, 0, MJ_PT);
+    if ((chord & B_N) && !proxy_ntk_right && !proxy_nk_right) right |= MJ_HALF(0, 0, MJ_PK);
 
-    if (proxy_ntk_right) { APP('n'); APP('t'); APP('k'); }
-    else if (proxy_nk_right) { APP('n'); APP('k'); }
+    if (proxy_ntk_right) right |= MJ_HALF(0, 0, MJ_PN | MJ_PT | MJ_PK);
+    else if (proxy_nk_right) right |= MJ_HALF(0, 0, MJ_PN | MJ_PK);
 
-    // Right '*' must be last on right side
-    if ((chord & B_P) && !proxy_s_star) APP('*');
-    if (proxy_s_star) APP('*');
+    // Right '*'
+    if ((chord & B_P) && !proxy_s_star) flags |= MJ_STAR;
+    if (proxy_s_star) flags |= MJ_STAR;
 
-    out[n] = 0;
-    #undef APP
+    return MJ_STROKE(left, right) | flags;
 }
 
 
@@ -2154,12 +1658,115 @@ static inline uint32_t naginata_bit_for_keycode(uint32_t keycode) {
 static inline void naginata_clear_stroke_state(void) {
     pressed_keys = 0UL;
     chord_keys = 0UL;
+    committed_keys = 0UL;
     n_pressed_keys = 0;
     while (nginput.size > 0) {
         removeFromListArrayAt(&nginput, 0);
     }
 }
 
+/* --------------------------------------------------------------------------
+ * Stroke queue
+ *
+ * Finalized chords are queued here and converted/sent from a work item on the
+ * system work queue, so chord capture never waits for the previous output to
+ * drain. A stroke stays queued until the emitter has room for its output
+ * (CONFIG_NAGINATA_EMIT_STROKE_ROOM); the emitter runs the work again once it
+ * has, so nothing on the work queue sleeps on a full output queue. When the
+ * stroke queue is full on that same queue, the oldest stroke is converted
+ * inline if there is room, else the new one is dropped; from other threads
+ * the release callback waits up to CONFIG_NAGINATA_STROKE_QUEUE_TIMEOUT_MS for
+ * a free slot. A dropped stroke counts as an overflow.
+ * -------------------------------------------------------------------------- */
+
+K_MSGQ_DEFINE(mejiro_stroke_msgq, sizeof(uint32_t), CONFIG_NAGINATA_STROKE_QUEUE_SIZE, 4);
+
+static struct mejiro_stats g_mejiro_stats;
+static struct k_spinlock g_mejiro_stats_lock;
+
+void mejiro_stats_get(struct mejiro_stats *out) {
+    k_spinlock_key_t key = k_spin_lock(&g_mejiro_stats_lock);
+    *out = g_mejiro_stats;
+    k_spin_unlock(&g_mejiro_stats_lock, key);
+}
+
+/* Count the keys and kana of one emitted stroke. */
+static void mejiro_stats_count_output(uint16_t keys, uint16_t kana) {
+    k_spinlock_key_t key = k_spin_lock(&g_mejiro_stats_lock);
+    g_mejiro_stats.last_stroke_keys = keys;
+    g_mejiro_stats.keys_emitted += keys;
+    g_mejiro_stats.kana_emitted += kana;
+    k_spin_unlock(&g_mejiro_stats_lock, key);
+}
+
+void mejiro_stats_reset(void) {
+    k_spinlock_key_t key = k_spin_lock(&g_mejiro_stats_lock);
+    memset(&g_mejiro_stats, 0, sizeof(g_mejiro_stats));
+    k_spin_unlock(&g_mejiro_stats_lock, key);
+}
+
+static void mejiro_stroke_work_handler(struct k_work *work) {
+    uint32_t chord;
+
+#if !IS_ENABLED(CONFIG_NAGINATA_MEJIRO_STENO)
+    /* backpressure: the stroke waits in the queue, the emitter submits this again */
+    if (k_msgq_num_used_get(&mejiro_stroke_msgq) > 0 &&
+        !naginata_emit_reserve(CONFIG_NAGINATA_EMIT_STROKE_ROOM, work)) {
+        return;
+    }
+#endif
+
+    /* one stroke per run, so queued key events can drain in between */
+    if (k_msgq_get(&mejiro_stroke_msgq, &chord, K_NO_WAIT) != 0) {
+        return;
+    }
+
+#if IS_ENABLED(CONFIG_NAGINATA_MEJIRO_STENO)
+    /* Plover converts: the raw chord goes out as one steno packet, unpaced */
+    const int err = mejiro_steno_send(build_mejiro_stroke(chord));
+    if (err < 0) {
+        LOG_WRN("mejiro steno packet not sent (err %d)", err);
+    }
+#else
+    process_mejiro_stroke_local(build_mejiro_stroke(chord));
+#endif
+
+    if (k_msgq_num_used_get(&mejiro_stroke_msgq) > 0) {
+        naginata_emit_submit(work);
+    } else {
+        /* nothing queued behind it: a held stroke goes out as is */
+        mejiro_flush_staged(NULL, 0);
+    }
+}
+
+static K_WORK_DEFINE(mejiro_stroke_work, mejiro_stroke_work_handler);
+
+static void mejiro_stroke_enqueue(uint32_t chord) {
+    const bool on_work_q = k_current_get() == k_work_queue_thread_get(&k_sys_work_q);
+
+    if (on_work_q && k_msgq_num_free_get(&mejiro_stroke_msgq) == 0) {
+        /* the work that empties the queue cannot run while this waits */
+        mejiro_stroke_work_handler(&mejiro_stroke_work);
+    }
+    if (k_msgq_put(&mejiro_stroke_msgq, &chord,
+                   on_work_q ? K_NO_WAIT : K_MSEC(CONFIG_NAGINATA_STROKE_QUEUE_TIMEOUT_MS)) != 0) {
+        LOG_WRN("mejiro stroke queue full, stroke dropped");
+        k_spinlock_key_t key = k_spin_lock(&g_mejiro_stats_lock);
+        g_mejiro_stats.stroke_queue_overflows++;
+        k_spin_unlock(&g_mejiro_stats_lock, key);
+        return;
+    }
+
+    const uint16_t used = (uint16_t)k_msgq_num_used_get(&mejiro_stroke_msgq);
+    k_spinlock_key_t key = k_spin_lock(&g_mejiro_stats_lock);
+    if (used > g_mejiro_stats.stroke_queue_high_water) {
+        g_mejiro_stats.stroke_queue_high_water = used;
+    }
+    k_spin_unlock(&g_mejiro_stats_lock, key);
+
+    naginata_emit_submit(&mejiro_stroke_work);
+}
+
 bool naginata_press(struct zmk_behavior_binding *binding, struct zmk_behavior_binding_event event) {
     LOG_DBG(">NAGINATA PRESS");
 
@@ -2172,16 +1779,24 @@ bool naginata_press(struct zmk_behavior_binding *binding, struct zmk_behavior_bi
     }
 
     /* Mejiro path: keep exactly one state machine.
-     * - pressed_keys: keys currently held
+     * - pressed_keys: keys of the open chord currently held
      * - chord_keys: full union collected for this stroke
-     * - finalize only on full release
+     * - committed_keys: keys of committed chords still held (first-up)
+     * - finalize on full release, or on the first release in first-up mode
      */
+    if ((committed_keys & bit) != 0UL || (committed_keys != 0UL && !rollover_mode)) {
+        /* first-up: stroke already committed, wait for full release */
+        LOG_DBG("<NAGINATA PRESS (suppressed)");
+        return true;
+    }
+
     if ((pressed_keys & bit) == 0UL) {
         n_pressed_keys++;
     }
 
     pressed_keys |= bit;
     chord_keys |= bit;
+    mejiro_speculate(chord_keys);
 
     LOG_DBG("<NAGINATA PRESS");
 
@@ -2200,17 +1815,26 @@ bool naginata_release(struct zmk_behavior_binding *binding,
         return true;
     }
 
-    if ((pressed_keys & bit) != 0UL) {
+    if ((committed_keys & bit) != 0UL) {
+        /* key of an already committed chord */
+        committed_keys &= ~bit;
+    } else if ((pressed_keys & bit) != 0UL) {
         pressed_keys &= ~bit;
         if (n_pressed_keys > 0) {
             n_pressed_keys--;
         }
+
+        if (chord_keys != 0UL && (pressed_keys == 0UL || first_up_mode)) {
+            /* in first-up mode the first release after the peak commits */
+            mejiro_stroke_enqueue(chord_keys);
+            committed_keys |= pressed_keys;
+            pressed_keys = 0UL;
+            chord_keys = 0UL;
+            n_pressed_keys = 0;
+        }
     }
 
-    if (pressed_keys == 0UL && chord_keys != 0UL) {
-        char stroke[64];
-        build_mejiro_id(chord_keys, stroke, sizeof(stroke));
-        process_mejiro_stroke_local(stroke);
+    if (pressed_keys == 0UL && committed_keys == 0UL) {
         naginata_clear_stroke_state();
     }
 
@@ -2221,12 +1845,38 @@ bool naginata_release(struct zmk_behavior_binding *binding,
 
 // 薙刀式
 
+struct behavior_naginata_config {
+    struct naginata_pace_profile ime_on;
+    struct naginata_pace_profile ime_off;
+    bool first_up;
+    bool rollover;
+};
+
+#if IS_ENABLED(CONFIG_NAGINATA_MEJIRO_BENCH)
+static void mejiro_bench_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(mejiro_bench_work, mejiro_bench_work_handler);
+#endif
+
 static int behavior_naginata_init(const struct device *dev) {
     LOG_DBG("NAGINATA INIT");
+    const struct behavior_naginata_config *cfg = dev->config;
 
     initializeListArray(&nginput);
     naginata_clear_stroke_state();
+    mejiro_tables_init();
+    first_up_mode = cfg->first_up;
+    /* without first-up a chord is committed only once every key is up */
+    rollover_mode = cfg->rollover && first_up_mode;
+    if (cfg->rollover && !first_up_mode) {
+        LOG_WRN("naginata rollover needs first-up, ignored");
+    }
+    naginata_emit_set_profile(true, &cfg->ime_on);
+    naginata_emit_set_profile(false, &cfg->ime_off);
+    naginata_emit_init();
     naginata_config.os =  NG_MACOS;
+#if IS_ENABLED(CONFIG_NAGINATA_MEJIRO_BENCH)
+    k_work_schedule(&mejiro_bench_work, K_SECONDS(CONFIG_NAGINATA_MEJIRO_BENCH_DELAY_S));
+#endif
 
     return 0;
 };
@@ -2255,7 +1905,7 @@ static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
     }
 
     timestamp = event.timestamp;
-    mejiro_synth_timestamp = event.timestamp;
+    naginata_emit_sync_timestamp(event.timestamp);
     naginata_press(binding, event);
 
     return ZMK_BEHAVIOR_OPAQUE;
@@ -2266,7 +1916,7 @@ static int on_keymap_binding_released(struct zmk_behavior_binding *binding,
     LOG_DBG("position %d keycode 0x%02X", event.position, binding->param1);
 
     timestamp = event.timestamp;
-    mejiro_synth_timestamp = event.timestamp;
+    naginata_emit_sync_timestamp(event.timestamp);
     naginata_release(binding, event);
 
     return ZMK_BEHAVIOR_OPAQUE;
@@ -2276,8 +1926,25 @@ static const struct behavior_driver_api behavior_naginata_driver_api = {
     .binding_pressed = on_keymap_binding_pressed, .binding_released = on_keymap_binding_released};
 
 #define KP_INST(n)                                                                                 \
-    BEHAVIOR_DT_INST_DEFINE(n, behavior_naginata_init, NULL, NULL, NULL, POST_KERNEL,              \
-                            CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &behavior_naginata_driver_api);
+    static const struct behavior_naginata_config behavior_naginata_config_##n = {                  \
+        .ime_on =                                                                                  \
+            {                                                                                      \
+                .intra_kana_ms = DT_INST_PROP_OR(n, ime_on_intra_kana_delay_ms,                    \
+                                                 CONFIG_NAGINATA_ROMA_INTRA_KANA_DELAY_MS),        \
+                .inter_kana_ms = DT_INST_PROP_OR(n, ime_on_inter_kana_delay_ms,                    \
+                                                 CONFIG_NAGINATA_ROMA_INTER_KANA_DELAY_MS),        \
+            },                                                                                     \
+        .ime_off =                                                                                 \
+            {                                                                                      \
+                .intra_kana_ms = DT_INST_PROP_OR(n, ime_off_intra_kana_delay_ms, 0),               \
+                .inter_kana_ms = DT_INST_PROP_OR(n, ime_off_inter_kana_delay_ms, 0),               \
+            },                                                                                     \
+        .first_up = DT_INST_PROP(n, first_up) || IS_ENABLED(CONFIG_NAGINATA_FIRST_UP),             \
+        .rollover = DT_INST_PROP(n, rollover) || IS_ENABLED(CONFIG_NAGINATA_ROLLOVER),             \
+    };                                                                                             \
+    BEHAVIOR_DT_INST_DEFINE(n, behavior_naginata_init, NULL, NULL, &behavior_naginata_config_##n,  \
+                            POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,                      \
+                            &behavior_naginata_driver_api);
 
 DT_INST_FOREACH_STATUS_OKAY(KP_INST)
 
@@ -2289,7 +1956,7 @@ DT_INST_FOREACH_STATUS_OKAY(KP_INST)
 //  - Commands/abbrev/verb are currently stubbed (incremental integration)
 // ================================
 typedef struct {
-    char output[128];
+    char kana[128]; /* kana codes (mejiro_kana_code.h); keys are chosen at the output edge */
     size_t kana_length;
     bool success;
 } mejiro_result_t_zmk;
@@ -2303,157 +1970,52 @@ typedef struct {
 
 // Stubs: (next step we can wire real tables)
 
-static void kana_to_roma_zmk(const char *kana_input, char *roma_output, size_t output_size);
-static mejiro_result_t_zmk mejiro_transform_zmk(const char *mejiro_id);
+static void kana_to_roma_zmk(const char *kana_input, char *roma_output, uint8_t *pace,
+                             size_t output_size);
+static mejiro_result_t_zmk mejiro_transform_zmk(mejiro_stroke_t stroke);
+static mejiro_result_t_zmk mejiro_transform_speculated(mejiro_stroke_t stroke);
+static uint16_t mejiro_compile_stroke(mejiro_stroke_t stroke, uint16_t *units);
+static void mejiro_set_last_keys(uint16_t n, uint16_t units);
 
-static bool mejiro_contains_hash_local(const char *s) {
-    return s && strchr(s, '#') != NULL;
-}
+/* extra sends for the next stroke, added by #-St */
+static uint8_t g_mejiro_repeat_extra = 0;
+
+static void process_mejiro_stroke_local(mejiro_stroke_t stroke) {
+    const mj_cmd_t *cmd = mejiro_find_command(stroke);
 
-static void mejiro_remove_hash_local(const char *src, char *dst, size_t dst_sz) {
-    if (!dst || dst_sz == 0) {
+    if (cmd != NULL && cmd->kind == MJ_CMD_REPEAT_COUNT) {
+        /* a plain stroke is sent 1 + extra times; # strokes are capped where they are sent */
+        if (g_mejiro_repeat_extra + 1 < CONFIG_NAGINATA_MEJIRO_REPEAT_MAX) {
+            g_mejiro_repeat_extra++;
+        }
         return;
     }
-    if (!src) {
-        dst[0] = '\0';
+    const uint8_t extra = g_mejiro_repeat_extra;
+    g_mejiro_repeat_extra = 0;
+
+    /* exact commands, including explicit # commands */
+    if (cmd != NULL) {
+        mejiro_flush_staged(NULL, 0);
+        mejiro_run_command(cmd, 1 + extra);
         return;
     }
 
-    size_t j = 0;
-    for (size_t i = 0; src[i] != '\0' && j + 1 < dst_sz; i++) {
-        if (src[i] != '#') {
-            dst[j++] = src[i];
-        }
+    if ((stroke & MJ_HASH) == 0) {
+        send_mejiro_output(stroke, 1 + extra);
+        return;
     }
-    dst[j] = '\0';
-}
 
-static bool execute_mejiro_command_exact_local(const char *stroke, bool doubled) {
-    if (!stroke || stroke[0] == '\0') {
-        return false;
+    /* # sends the hashless stroke twice: compiled once, replayed (undo is not doubled) */
+    const mejiro_stroke_t hashless = stroke & ~MJ_HASH;
+    const uint8_t doubled = MIN(2 + extra, CONFIG_NAGINATA_MEJIRO_REPEAT_MAX);
+    cmd = mejiro_find_command(hashless);
+    if (cmd != NULL) {
+        mejiro_flush_staged(NULL, 0);
+        mejiro_run_command(cmd, cmd->kind == MJ_CMD_UNDO ? 1 + extra : doubled);
+        return;
     }
-
-    for (size_t i = 0; i < ARRAY_SIZE(mejiro_commands_zmk); i++) {
-        if (strcmp(mejiro_commands_zmk[i].stroke, stroke) != 0) {
-            continue;
-        }
-
-        switch (mejiro_commands_zmk[i].kind) {
-        case MJ_CMD_REPEAT:
-            if (g_mejiro_last_output[0] != '\0') {
-                send_mejiro_roma(g_mejiro_last_output);
-                if (doubled) {
-                    send_mejiro_roma(g_mejiro_last_output);
-                }
-                uint16_t units = g_mejiro_last_units > 0 ? g_mejiro_last_units
-                                                         : (uint16_t)strlen(g_mejiro_last_output);
-                if (doubled) {
-                    units = (uint16_t)(units * 2);
-                }
-                mejiro_history_push(units);
-            }
-            return true;
-
-        case MJ_CMD_UNDO: {
-            uint16_t n = mejiro_history_pop();
-            for (uint16_t k = 0; k < n; k++) {
-                tap_key(MJ_KC(HID_USAGE_KEY_KEYBOARD_DELETE_BACKSPACE));
-            }
-            mejiro_clear_pending_tsu_zmk();
-            return true;
-        }
-
-        case MJ_CMD_KEY:
-            tap_key(mejiro_commands_zmk[i].keycode);
-            if (doubled) {
-                tap_key(mejiro_commands_zmk[i].keycode);
-            }
-            if (mejiro_commands_zmk[i].keycode == MJ_KC(HID_USAGE_KEY_KEYBOARD_DELETE_BACKSPACE) ||
-                mejiro_commands_zmk[i].keycode == MJ_KC(HID_USAGE_KEY_KEYBOARD_DELETE_FORWARD)) {
-                mejiro_clear_pending_tsu_zmk();
-            }
-            return true;
-
-        case MJ_CMD_MOD_KEY:
-            press_key(mejiro_commands_zmk[i].mod);
-            tap_key(mejiro_commands_zmk[i].keycode);
-            if (doubled) {
-                tap_key(mejiro_commands_zmk[i].keycode);
-            }
-            release_key(mejiro_commands_zmk[i].mod);
-            return true;
-
-        case MJ_CMD_MOD2_KEY:
-            press_key(mejiro_commands_zmk[i].mod);
-            press_key(mejiro_commands_zmk[i].mod2);
-            tap_key(mejiro_commands_zmk[i].keycode);
-            if (doubled) {
-                tap_key(mejiro_commands_zmk[i].keycode);
-            }
-            release_key(mejiro_commands_zmk[i].mod2);
-            release_key(mejiro_commands_zmk[i].mod);
-            return true;
-
-        case MJ_CMD_STRING:
-            send_mejiro_command_string(mejiro_commands_zmk[i].string);
-            if (doubled) {
-                send_mejiro_command_string(mejiro_commands_zmk[i].string);
-            }
-            return true;
-
-        default:
-            return true;
-        }
-    }
-
-    return false;
-}
-
-static void process_mejiro_stroke_local(const char *stroke) {
-    if (!stroke || stroke[0] == '\0') {
-        return;
-    }
-
-    /* exact commands, including explicit # commands, preserve original behavior */
-    if (handle_mejiro_command(stroke)) {
-        return;
-    }
-
-    /* no # => preserve original behavior exactly */
-    if (!mejiro_contains_hash_local(stroke)) {
-        send_mejiro_output(stroke);
-        return;
-    }
-
-    char hashless[64] = {0};
-    mejiro_remove_hash_local(stroke, hashless, sizeof(hashless));
-    if (hashless[0] == '\0') {
-        return;
-    }
-
-    /* second exact command-table pass on hashless stroke */
-    if (execute_mejiro_command_exact_local(hashless, true)) {
-        return;
-    }
-
-    /* normal transform exactly once; duplicate only final emitted output */
-    mejiro_result_t_zmk result = mejiro_transform_zmk(hashless);
-    if (!result.success || result.output[0] == '\0') {
-        return;
-    }
-
-    send_mejiro_roma(result.output);
-    send_mejiro_roma(result.output);
-
-    strncpy(g_mejiro_last_output, result.output, sizeof(g_mejiro_last_output) - 1);
-    g_mejiro_last_output[sizeof(g_mejiro_last_output) - 1] = '\0';
-
-    uint16_t units =
-        (uint16_t)(result.kana_length > 0 ? result.kana_length : strlen(result.output));
-    units = (uint16_t)(units * 2);
-    g_mejiro_last_units = units;
-    mejiro_history_push(units);
-}
+    send_mejiro_output(hashless, doubled);
+}
 
 
 /*
@@ -2481,8 +2043,8 @@ static void process_mejiro_stroke_local(const char *stroke) {
 #endif
 
 
-// 前回の母音を保存（省略時に使用）
-static char last_vowel_stroke[8] = "A";  // デフォルトは"A"
+// 前回の母音を保存（省略時に使用、母音コード）
+static uint8_t last_vowel_stroke = MJ_A;  // デフォルトは"A"
 
 // 「っ」の持ち越し状態
 static bool pending_tsu = false;
@@ -2492,759 +2054,435 @@ void mejiro_clear_pending_tsu_zmk(void) {
     pending_tsu = false;
 }
 
-// ひらがな→ヘボン式ローマ字変換テーブル
+/* --------------------------------------------------------------------------
+ * Speculative transform
+ *
+ * Each press asks the system work queue to transform the chord collected so
+ * far. The transform runs against a snapshot of last_vowel_stroke/pending_tsu,
+ * which are restored afterwards. When the committed stroke reaches the
+ * transform with the same code and the same prior state, the stored result and
+ * post-state are used instead of transforming again.
+ * Runs on the system work queue, the only place the transform state is touched.
+ * -------------------------------------------------------------------------- */
+
 typedef struct {
-    const char *kana;
-    const char *roma;
-} kana_roma_t;
-
-static const kana_roma_t kana_roma_table[] = {
-    // 基本五十音
-    {"あ", "a"}, {"い", "i"}, {"う", "u"}, {"え", "e"}, {"お", "o"},
-    {"か", "ka"}, {"き", "ki"}, {"く", "ku"}, {"け", "ke"}, {"こ", "ko"},
-    {"さ", "sa"}, {"し", "shi"}, {"す", "su"}, {"せ", "se"}, {"そ", "so"},
-    {"た", "ta"}, {"ち", "chi"}, {"つ", "tsu"}, {"て", "te"}, {"と", "to"},
-    {"な", "na"}, {"に", "ni"}, {"ぬ", "nu"}, {"ね", "ne"}, {"の", "no"},
-    {"は", "ha"}, {"ひ", "hi"}, {"ふ", "fu"}, {"へ", "he"}, {"ほ", "ho"},
-    {"ま", "ma"}, {"み", "mi"}, {"む", "mu"}, {"め", "me"}, {"も", "mo"},
-    {"や", "ya"}, {"ゆ", "yu"}, {"よ", "yo"},
-    {"ら", "ra"}, {"り", "ri"}, {"る", "ru"}, {"れ", "re"}, {"ろ", "ro"},
-    {"わ", "wa"}, {"ゐ", "wi"}, {"ゑ", "we"}, {"を", "wo"}, {"ん", "nn"},
+    uint8_t last_vowel;
+    bool pending_tsu;
+} mejiro_transform_state_t;
+
+static struct {
+    bool valid;
+    mejiro_stroke_t stroke;
+    mejiro_transform_state_t before;
+    mejiro_transform_state_t after;
+    mejiro_result_t_zmk result;
+} mejiro_spec;
+
+static atomic_t mejiro_spec_chord = ATOMIC_INIT(0);
+
+static void mejiro_transform_state_get(mejiro_transform_state_t *st) {
+    st->last_vowel = last_vowel_stroke;
+    st->pending_tsu = pending_tsu;
+}
 
-    // 濁音
-    {"が", "ga"}, {"ぎ", "gi"}, {"ぐ", "gu"}, {"げ", "ge"}, {"ご", "go"},
-    {"ざ", "za"}, {"じ", "ji"}, {"ず", "zu"}, {"ぜ", "ze"}, {"ぞ", "zo"},
-    {"だ", "da"}, {"ぢ", "di"}, {"づ", "du"}, {"で", "de"}, {"ど", "do"},
-    {"ば", "ba"}, {"び", "bi"}, {"ぶ", "bu"}, {"べ", "be"}, {"ぼ", "bo"},
+static void mejiro_transform_state_set(const mejiro_transform_state_t *st) {
+    last_vowel_stroke = st->last_vowel;
+    pending_tsu = st->pending_tsu;
+}
 
-    // 半濁音
-    {"ぱ", "pa"}, {"ぴ", "pi"}, {"ぷ", "pu"}, {"ぺ", "pe"}, {"ぽ", "po"},
-
-    // 拗音(きゃ系)
-    {"きゃ", "kya"}, {"きゅ", "kyu"}, {"きょ", "kyo"},
-    {"しゃ", "sha"}, {"しゅ", "shu"}, {"しょ", "sho"},
-    {"ちゃ", "cha"}, {"ちゅ", "chu"}, {"ちょ", "cho"},
-    {"にゃ", "nya"}, {"にゅ", "nyu"}, {"にょ", "nyo"},
-    {"ひゃ", "hya"}, {"ひゅ", "hyu"}, {"ひょ", "hyo"},
-    {"みゃ", "mya"}, {"みゅ", "myu"}, {"みょ", "myo"},
-    {"りゃ", "rya"}, {"りゅ", "ryu"}, {"りょ", "ryo"},
-    {"ぎゃ", "gya"}, {"ぎゅ", "gyu"}, {"ぎょ", "gyo"},
-    {"じゃ", "ja"}, {"じゅ", "ju"}, {"じょ", "jo"},
-    {"ぢゃ", "dya"}, {"ぢゅ", "dyu"}, {"ぢょ", "dyo"},
-    {"びゃ", "bya"}, {"びゅ", "byu"}, {"びょ", "byo"},
-    {"ぴゃ", "pya"}, {"ぴゅ", "pyu"}, {"ぴょ", "pyo"},
-
-    // 特殊音
-    {"ゔ", "vu"},    {"ゔぁ", "va"},  {"ゔぃ", "vi"}, {"ゔぇ", "ve"}, {"ゔぉ", "vo"},
-    {"ゔゅ", "vyu"},
-    {"うぁ", "wha"}, {"うぃ", "wi"},  {"うぇ", "we"}, {"うぉ", "who"},
-    {"ふぁ", "fa"},  {"ふぃ", "fi"},  {"ふぇ", "fe"}, {"ふぉ", "fo"},
-    {"ふゃ", "fya"}, {"ふゅ", "fyu"}, {"ふょ", "fyo"},
-    {"くぁ", "kwa"},  {"くぃ", "kwi"},  {"くぇ", "kwe"}, {"くぉ", "kwo"},
-    {"いぇ", "ye"}, {"しぇ", "she"}, {"じぇ", "je"}, {"ちぇ", "che"},
-    {"てぃ", "thi"}, {"でぃ", "dhi"}, {"でゅ", "dhu"},
-    {"とぅ", "twu"}, {"どぅ", "dwu"},
-
-    // 小書き文字
-    {"ぁ", "xa"}, {"ぃ", "xi"}, {"ぅ", "xu"}, {"ぇ", "xe"}, {"ぉ", "xo"},
-    {"ゃ", "xya"}, {"ゅ", "xyu"}, {"ょ", "xyo"},
-    {"っ", "xtu"}, {"ゎ", "xwa"},
-
-    // 長音符
-    {"ー", "-"},
-
-    // 句読点
-    {"、", ","}, {"。", "."}, {"!", "!"}, {"!", "!"}, {"?", "?"}, {"?", "?"},
-
-    {NULL, NULL}
-};
+/* --------------------------------------------------------------------------
+ * Compiled stroke cache
+ *
+ * The keys a committed stroke emits depend only on the stroke code and
+ * last_vowel_stroke/pending_tsu, so the compiled key sequence is kept here
+ * together with the post-state and the undo units. A hit replays the keys
+ * without running the transform, kana_to_roma_zmk or the keycode lookup.
+ * Replacement is CLOCK (second chance). Emitter thread only.
+ * -------------------------------------------------------------------------- */
 
-static size_t utf8_char_count(const char *s) {
-    size_t count = 0;
-    while (*s) {
-        unsigned char c = (unsigned char)*s;
-        if ((c & 0xC0) != 0x80) {
-            count++;
+#if CONFIG_NAGINATA_MEJIRO_CACHE_SIZE > 0
+typedef struct {
+    bool valid;
+    bool referenced;
+    mejiro_stroke_t stroke;
+    mejiro_transform_state_t before;
+    mejiro_transform_state_t after;
+    uint16_t units; /* 0 when the stroke emits nothing */
+    uint8_t key_count;
+    mejiro_key_t keys[CONFIG_NAGINATA_MEJIRO_CACHE_KEYS];
+} mejiro_cache_entry_t;
+
+static mejiro_cache_entry_t mejiro_cache[CONFIG_NAGINATA_MEJIRO_CACHE_SIZE];
+static size_t mejiro_cache_hand;
+
+static mejiro_cache_entry_t *mejiro_cache_find(mejiro_stroke_t stroke,
+                                               const mejiro_transform_state_t *st) {
+    for (size_t i = 0; i < ARRAY_SIZE(mejiro_cache); i++) {
+        mejiro_cache_entry_t *e = &mejiro_cache[i];
+        if (e->valid && e->stroke == stroke && e->before.last_vowel == st->last_vowel &&
+            e->before.pending_tsu == st->pending_tsu) {
+            return e;
         }
-        s++;
     }
-    return count;
+    return NULL;
 }
 
-// ひらがなをヘボン式ローマ字に変換（最長一致 + 促音対応）
-void kana_to_roma_zmk(const char *kana_input, char *roma_output, size_t output_size) {
-    roma_output[0] = '\0';
-    const char *p = kana_input;
-
-    while (*p && strlen(roma_output) < output_size - 10) {
-        // 促音（小さい「っ」）の処理：次の音の頭子音を重ねる
-        if (strncmp(p, "っ", 3) == 0) {
-            // 次のエントリを最長一致で先読み
-            const kana_roma_t *best = NULL;
-            size_t best_len = 0;
-            for (const kana_roma_t *entry = kana_roma_table; entry->kana != NULL; entry++) {
-                size_t kana_len = strlen(entry->kana);
-                if (kana_len > best_len && strncmp(p + 3, entry->kana, kana_len) == 0) {
-                    best = entry;
-                    best_len = kana_len;
-                }
-            }
-            if (best && best->roma && best->roma[0] != '\0') {
-                char c = best->roma[0];
-                // 母音頭の場合は重ねられないので「xtu」を出力
-                if (c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u') {
-                    strcat(roma_output, "xtu");
-                } else {
-                    // 子音頭の場合は子音を重ねる
-                    size_t len = strlen(roma_output);
-                    if (len < output_size - 2) {
-                        roma_output[len] = c;
-                        roma_output[len + 1] = '\0';
-                    }
-                }
-            } else {
-                // 次の文字がない場合も「xtu」を出力
-                strcat(roma_output, "xtu");
-            }
-            p += 3; // 「っ」を消費して続行
-            continue;
-        }
+static void mejiro_cache_insert(mejiro_stroke_t stroke, const mejiro_transform_state_t *before,
+                                uint16_t n, uint16_t units) {
+    if (n > CONFIG_NAGINATA_MEJIRO_CACHE_KEYS) {
+        return;
+    }
 
-        // 最長一致検索（拗音などを優先）
-        const kana_roma_t *best = NULL;
-        size_t best_len = 0;
-        for (const kana_roma_t *entry = kana_roma_table; entry->kana != NULL; entry++) {
-            size_t kana_len = strlen(entry->kana);
-            if (kana_len > best_len && strncmp(p, entry->kana, kana_len) == 0) {
-                best = entry;
-                best_len = kana_len;
-            }
+    mejiro_cache_entry_t *e;
+    for (;;) {
+        e = &mejiro_cache[mejiro_cache_hand];
+        mejiro_cache_hand = (mejiro_cache_hand + 1) % ARRAY_SIZE(mejiro_cache);
+        if (!e->valid || !e->referenced) {
+            break;
         }
+        e->referenced = false;
+    }
 
-        if (best) {
-            strcat(roma_output, best->roma);
-            p += best_len;
-            continue;
-        }
+    e->valid = true;
+    e->referenced = false;
+    e->stroke = stroke;
+    e->before = *before;
+    mejiro_transform_state_get(&e->after);
+    e->units = units;
+    e->key_count = (uint8_t)n;
+    memcpy(e->keys, mejiro_burst, n * sizeof(mejiro_burst[0]));
+}
+#endif
 
-        if ((unsigned char)*p < 128) {
-            size_t len = strlen(roma_output);
-            roma_output[len] = *p;
-            roma_output[len + 1] = '\0';
-            p++;
-        } else {
-            p++;
-        }
+static void mejiro_spec_work_handler(struct k_work *work) {
+    const uint32_t chord = (uint32_t)atomic_get(&mejiro_spec_chord);
+    if (chord == 0UL) {
+        return;
     }
-}
 
-// 子音ストローク→ローマ字マッピング
-typedef struct {
-    const char *stroke;
-    const char *roma;
-} conso_map_t;
-
-static const conso_map_t conso_table[] = {
-    {"", ""}, {"S", "s"}, {"T", "t"}, {"K", "k"}, {"N", "n"},
-    {"ST", "r"}, {"SK", "w"}, {"TK", "h"},
-    {"SN", "z"}, {"TN", "d"}, {"KN", "g"}, {"TKN", "b"},
-    {"STK", "p"}, {"STN", "l"}, {"SKN", "m"}, {"STKN", "f"}
-};
+    const mejiro_stroke_t stroke = build_mejiro_stroke(chord);
 
-// 母音ストローク→ローマ字マッピング
-typedef struct {
-    const char *stroke;
-    const char *roma;
-    uint8_t index;
-} vowel_map_t;
-
-static const vowel_map_t vowel_table[] = {
-    {"A", "a", 0}, {"I", "i", 1}, {"U", "u", 2}, {"IA", "e", 3}, {"AU", "o", 4},
-    {"YA", "ya", 5}, {"YU", "yu", 6}, {"YAU", "yo", 7}
-};
+    /* same routing as process_mejiro_stroke_local; commands are never speculated */
+    if (mejiro_find_command(stroke) != NULL) {
+        return;
+    }
+    const mejiro_stroke_t id = stroke & ~MJ_HASH;
+    if (id != stroke && mejiro_find_command(id) != NULL) {
+        return;
+    }
 
-// 行段→ひらがなマッピング
-static const char *kana_table[][8] = {
-    {"あ", "い", "う", "え", "お", "や", "ゆ", "よ"},     // ""
-    {"か", "き", "く", "け", "こ", "きゃ", "きゅ", "きょ"}, // k
-    {"さ", "し", "す", "せ", "そ", "しゃ", "しゅ", "しょ"}, // s
-    {"た", "ち", "つ", "て", "と", "ちゃ", "ちゅ", "ちょ"}, // t
-    {"な", "に", "ぬ", "ね", "の", "にゃ", "にゅ", "にょ"}, // n
-    {"は", "ひ", "ふ", "へ", "ほ", "ひゃ", "ひゅ", "ひょ"}, // h
-    {"ま", "み", "む", "め", "も", "みゃ", "みゅ", "みょ"}, // m
-    {"ら", "り", "る", "れ", "ろ", "りゃ", "りゅ", "りょ"}, // r
-    {"わ", "うぃ", "ゔ", "うぇ", "うぉ", "わ", "ゔゅ", "を"}, // w
-    {"が", "ぎ", "ぐ", "げ", "ご", "ぎゃ", "ぎゅ", "ぎょ"}, // g
-    {"ざ", "じ", "ず", "ぜ", "ぞ", "じゃ", "じゅ", "じょ"}, // z
-    {"だ", "ぢ", "づ", "で", "ど", "ぢゃ", "ぢゅ", "ぢょ"}, // d
-    {"ば", "び", "ぶ", "べ", "ぼ", "びゃ", "びゅ", "びょ"}, // b
-    {"ぱ", "ぴ", "ぷ", "ぺ", "ぽ", "ぴゃ", "ぴゅ", "ぴょ"}, // p
-    {"ふぁ", "ふぃ", "ふゅ", "ふぇ", "ふぉ", "ふゃ", "ふゅ", "ふょ"}, // f
-    {"ぁ", "ぃ", "ぅ", "ぇ", "ぉ", "ゃ", "ゅ", "ょ"}      // l
-};
+    if (mejiro_spec.valid && mejiro_spec.stroke == id) {
+        return;
+    }
+#if CONFIG_NAGINATA_MEJIRO_CACHE_SIZE > 0
+    mejiro_transform_state_t now;
+    mejiro_transform_state_get(&now);
+    if (mejiro_cache_find(id, &now) != NULL) {
+        return;
+    }
+#endif
 
-static const char *roma_order[] = {"", "k", "s", "t", "n", "h", "m", "r", "w", "g", "z", "d", "b", "p", "f", "l"};
+    mejiro_transform_state_get(&mejiro_spec.before);
+    mejiro_spec.result = mejiro_transform_zmk(id);
+    mejiro_transform_state_get(&mejiro_spec.after);
+    mejiro_transform_state_set(&mejiro_spec.before);
 
-// 二重母音マッピング
-typedef struct {
-    const char *stroke;
-    const char *first_vowel;
-    const char *suffix;
-} diphthong_map_t;
-
-static const diphthong_map_t diphthong_table[] = {
-    {"Y", "a", "い"},
-    {"YI", "yo", "う"},
-    {"YIA", "e", "い"},
-    {"YIU", "yu", "う"},
-    {"YIAU", "u", "う"},
-    {"IU", "u", "い"},
-    {"IAU", "o", "う"}
-};
+    mejiro_spec.stroke = id;
+    mejiro_spec.valid = true;
+}
 
-// 複雑二重母音マッピング（親指を使う外来音）
-typedef struct {
-    const char *stroke;  // 母音+助詞ストローク
-    const char *first_vowel;
-    const char *suffix;
-} minor_diphthong_map_t;
-
-static const minor_diphthong_map_t minor_diphthong_table[] = {
-    {"IAUtk", "a", "う"},   // ~あう
-    {"YItk", "i", "い"},    // ~いい
-    {"YIUtk", "o", "い"},   // ~おい
-    {"YIAtk", "a", "え"},   // ~あえ
-    {"YIAUtk", "o", "お"},  // ~おお
-};
+static K_WORK_DEFINE(mejiro_spec_work, mejiro_spec_work_handler);
 
-// 英語音マッピング（親指を使う外来音）
-typedef struct {
-    const char *stroke;  // 母音+助詞ストローク
-    const char *first_vowel;
-    const char *suffix;
-} english_diphthong_map_t;
-
-static const english_diphthong_map_t english_diphthong_table[] = {
-
-// |V/C | t | k |  nt   | nk | ntk|
-// |----|---|---|-------|----|----|
-// |IAU |~as|~al|~ation |~ind|~arn|
-// |YI  |~is|~il|~ition |~ing|~een|
-// |YIU |~us|~ul|~usion |~and|~oom|
-// |YIA |~es|~el|~ention|~end|~ain|
-// |YIAU|~os|~ol|~otion |~ong|~orn|
-
-    // t
-    {"IAUt", "a", "す"},
-    {"YIt", "i", "す"},
-    {"YIUt", "u", "す"},
-    {"YIAt", "e", "す"},
-    {"YIAUt", "o", "す"},
-
-    // k
-    {"IAUk", "a", "る"},
-    {"YIk", "i", "る"},
-    {"YIUk", "u", "る"},
-    {"YIAk", "e", "る"},
-    {"YIAUk", "o", "る"},
-
-    // nt
-    {"IAUnt", "e", "ーしょん"},
-    {"YInt", "i", "しょん"},
-    {"YIUnt", "u", "しょん"},
-    {"YIAnt", "e", "んしょん"},
-    {"YIAUnt", "o", "ーしょん"},
-
-    // nk
-    {"IAUnk", "a", "いんど"},
-    {"YInk", "i", "んぐ"},
-    {"YIUnk", "a", "んど"},
-    {"YIAnk", "e", "んど"},
-    {"YIAUnk", "o", "んぐ"},
-
-    // ntk
-    {"IAUntk", "a", "ーん"},
-    {"YIntk", "i", "ーん"},
-    {"YIUntk", "u", "ーん"},
-    {"YIAntk", "e", "ーん"},
-    {"YIAUntk", "o", "ーん"},
-};
+static void mejiro_speculate(uint32_t chord) {
+    if (IS_ENABLED(CONFIG_NAGINATA_MEJIRO_STENO)) {
+        return;
+    }
+    atomic_set(&mejiro_spec_chord, (atomic_val_t)chord);
+    naginata_emit_submit(&mejiro_spec_work);
+}
 
-// 例外的なかなのマッピング
-typedef struct {
-    const char *stroke;  // 子音+母音ストローク
-    const char *kana;
-} exception_kana_t;
-
-static const exception_kana_t exception_kana_table[] = {
-    // F
-    {"STKNU", "ゔ"},
-    {"STKNYA", "ゔぁ"},
-    {"STKNYI", "ゔぃ"},
-    {"STKNYU", "ふゅ"},
-    {"STKNYIU", "ゔぇ"},
-    {"STKNYAU", "ゔぉ"},
-    {"STKNYIAU", "じぇい"},
-    {"STKNIAU", "じぇ"},
-    {"STKNIU", "ゔゅ"},
-
-    // W
-    {"SKU", "ゎ"},
-    {"SKYA", "うぁ"},
-    {"SKYI", "ゐ"},
-    {"SKYU", "ゆい"},
-    {"SKYIU", "ゑ"},
-    {"SKYAU", "を"},
-    {"SKYIAU", "ちぇい"},
-    {"SKIAU", "ちぇ"},
-    {"SKIU", "いう"},
-
-    // D
-    {"TNYA", "てぃ"},
-    {"TNYI", "とぅ"},
-    {"TNYU", "でゅ"},
-    {"TNYIU", "どぅ"},
-    {"TNYAU", "でぃ"},
-    {"TNYIAU", "いぇ"},
-    {"TNIU", "てゅ"},
-
-    // X
-    {"STNYA", "すた"},
-    {"STNYI", "すち"},
-    {"STNYU", "すてぃ"},
-    {"STNYIU", "すて"},
-    {"STNYAU", "すと"},
-    {"STNYIAU", "しぇい"},
-    {"STNIAU", "しぇ"},
-    {"STNIU", "くす"},
-    {"STNY", "すたい"},
-    {"STNYIA", "すてい"},
-    {NULL, NULL}
-};
+static mejiro_result_t_zmk mejiro_transform_speculated(mejiro_stroke_t stroke) {
+    mejiro_transform_state_t now;
+    mejiro_transform_state_get(&now);
 
-// 追加音リスト
-static const char *second_sound_list[] = {"", "ん", "つ", "く", "っ", "ち", "き", "ー"};
-static const char *particle_key_list[] = {"", "n", "t", "k", "tk", "nt", "nk", "ntk"};
-
-// 左側助詞
-static const char *l_particle[] = {"", "、", "に", "の", "で", "と", "を", "へ"};
-// 右側助詞
-static const char *r_particle[] = {"", "、", "は", "が", "も", "は、", "が、", "も、"};
-
-// メジロIDをパース（左側・右側に分離）
-static void parse_mejiro_id(const char *id, char *left, char *right) {
-    const char *hyphen = strchr(id, '-');
-    if (hyphen == NULL) {
-        strcpy(left, id);
-        right[0] = '\0';
+    const bool hit = mejiro_spec.valid && mejiro_spec.stroke == stroke &&
+                     mejiro_spec.before.last_vowel == now.last_vowel &&
+                     mejiro_spec.before.pending_tsu == now.pending_tsu;
+    mejiro_spec.valid = false;
+
+    k_spinlock_key_t key = k_spin_lock(&g_mejiro_stats_lock);
+    if (hit) {
+        g_mejiro_stats.speculation_hits++;
     } else {
-        size_t left_len = hyphen - id;
-        strncpy(left, id, left_len);
-        left[left_len] = '\0';
-        strcpy(right, hyphen + 1);
+        g_mejiro_stats.speculation_misses++;
     }
-}
+    k_spin_unlock(&g_mejiro_stats_lock, key);
 
-// 子音ストロークからローマ字を取得
-static const char *get_conso_roma(const char *stroke) {
-    for (uint8_t i = 0; i < sizeof(conso_table)/sizeof(conso_table[0]); i++) {
-        if (strcmp(stroke, conso_table[i].stroke) == 0) {
-            return conso_table[i].roma;
-        }
+    if (!hit) {
+        return mejiro_transform_zmk(stroke);
     }
-    return NULL;
+
+    mejiro_transform_state_set(&mejiro_spec.after);
+    return mejiro_spec.result;
 }
 
-// 母音ストロークから母音インデックスを取得
-static int get_vowel_index(const char *stroke) {
-    // 二重母音チェック
-    for (uint8_t i = 0; i < sizeof(diphthong_table)/sizeof(diphthong_table[0]); i++) {
-        if (strcmp(stroke, diphthong_table[i].stroke) == 0) {
-            // first_vowelから基本母音インデックスを取得
-            for (uint8_t j = 0; j < sizeof(vowel_table)/sizeof(vowel_table[0]); j++) {
-                if (strcmp(vowel_table[j].roma, diphthong_table[i].first_vowel) == 0) {
-                    return vowel_table[j].index;
-                }
-            }
-        }
-    }
+static uint16_t mejiro_compile_kana(const char *kana, mejiro_key_t *keys, size_t max_keys);
 
-    // 基本母音チェック
-    for (uint8_t i = 0; i < sizeof(vowel_table)/sizeof(vowel_table[0]); i++) {
-        if (strcmp(stroke, vowel_table[i].stroke) == 0) {
-            return vowel_table[i].index;
-        }
-    }
-    return -1;
-}
+/* Compile a committed stroke into mejiro_burst. Returns the key count and sets
+ * *units to its undo units (0 when the stroke emits nothing). */
+static uint16_t mejiro_compile_stroke(mejiro_stroke_t stroke, uint16_t *units) {
+    mejiro_transform_state_t before;
+    mejiro_transform_state_get(&before);
 
-// ローマ字からkana_tableのインデックスを取得
-static int get_roma_index(const char *roma) {
-    for (uint8_t i = 0; i < sizeof(roma_order)/sizeof(roma_order[0]); i++) {
-        if (strcmp(roma, roma_order[i]) == 0) {
-            return i;
-        }
-    }
-    return -1;
-}
+#if CONFIG_NAGINATA_MEJIRO_CACHE_SIZE > 0
+    mejiro_cache_entry_t *e = mejiro_cache_find(stroke, &before);
 
-// 二重母音のsuffixを取得
-static const char *get_diphthong_suffix(const char *stroke) {
-    for (uint8_t i = 0; i < sizeof(diphthong_table)/sizeof(diphthong_table[0]); i++) {
-        if (strcmp(stroke, diphthong_table[i].stroke) == 0) {
-            return diphthong_table[i].suffix;
-        }
+    k_spinlock_key_t key = k_spin_lock(&g_mejiro_stats_lock);
+    if (e != NULL) {
+        g_mejiro_stats.cache_hits++;
+    } else {
+        g_mejiro_stats.cache_misses++;
     }
-    return "";
-}
+    k_spin_unlock(&g_mejiro_stats_lock, key);
 
-// 英語音をチェック（母音+助詞ストローク）
-static bool check_english_diphthong(const char *vowel_particle, const char **first_vowel, const char **suffix) {
-    for (uint8_t i = 0; i < sizeof(english_diphthong_table)/sizeof(english_diphthong_table[0]); i++) {
-        if (strcmp(vowel_particle, english_diphthong_table[i].stroke) == 0) {
-            *first_vowel = english_diphthong_table[i].first_vowel;
-            *suffix = english_diphthong_table[i].suffix;
-            return true;
-        }
+    if (e != NULL) {
+        e->referenced = true;
+        mejiro_transform_state_set(&e->after);
+        memcpy(mejiro_burst, e->keys, e->key_count * sizeof(e->keys[0]));
+        *units = e->units;
+        return e->key_count;
     }
-    return false;
-}
+#endif
 
-// マイナー二重母音をチェック（母音+助詞ストローク）
-static bool check_minor_diphthong(const char *vowel_particle, const char **first_vowel, const char **suffix) {
-    for (uint8_t i = 0; i < sizeof(minor_diphthong_table)/sizeof(minor_diphthong_table[0]); i++) {
-        if (strcmp(vowel_particle, minor_diphthong_table[i].stroke) == 0) {
-            *first_vowel = minor_diphthong_table[i].first_vowel;
-            *suffix = minor_diphthong_table[i].suffix;
-            return true;
-        }
+    const mejiro_result_t_zmk result = mejiro_transform_speculated(stroke);
+    uint16_t n = 0;
+    *units = 0;
+    if (result.success && result.kana[0] != '\0') {
+        n = mejiro_compile_kana(result.kana, mejiro_burst, ARRAY_SIZE(mejiro_burst));
+        *units = (uint16_t)result.kana_length;
     }
-    return false;
-}
 
-// 例外的なかなをチェック（子音+母音ストローク）
-static const char *check_exception_kana(const char *conso_vowel) {
-    for (uint8_t i = 0; exception_kana_table[i].stroke != NULL; i++) {
-        if (strcmp(conso_vowel, exception_kana_table[i].stroke) == 0) {
-            return exception_kana_table[i].kana;
-        }
-    }
-    return NULL;
+#if CONFIG_NAGINATA_MEJIRO_CACHE_SIZE > 0
+    mejiro_cache_insert(stroke, &before, n, *units);
+#endif
+    return n;
 }
 
-// 追加音を取得
-static const char *get_second_sound(const char *particle) {
-    for (uint8_t i = 0; i < sizeof(particle_key_list)/sizeof(particle_key_list[0]); i++) {
-        if (strcmp(particle, particle_key_list[i]) == 0) {
-            return second_sound_list[i];
+
+// 仮名コード列 p の先頭に最長一致するローマ字（無ければ NULL）
+// 一文字目でノードを引き、二文字目は拗音などの枝だけを見る
+static const char *kana_roma_lookup(const char *p, size_t *match_len) {
+    const mejiro_roma_node_t *node = &mejiro_roma_nodes[(uint8_t)p[0]];
+
+    if (node->edge != 0 && p[1] != '\0') {
+        for (const mejiro_roma_edge_t *e = &mejiro_roma_edges[node->edge]; e->code != 0; e++) {
+            if (e->code == (uint8_t)p[1]) {
+                *match_len = 2;
+                return &mejiro_roma_pool[e->roma];
+            }
         }
     }
-    return "";
+    if (node->roma == 0) {
+        return NULL;
+    }
+    *match_len = 1;
+    return &mejiro_roma_pool[node->roma];
 }
 
-
-// 子音・母音・助詞から、かな文字列を生成する共通関数
-// include_extra_sound: 追加音を含めるかどうか（左+助詞パターンではfalse）
-static void convert_to_kana(const char *conso, const char *vowel, const char *particle_str,
-                           bool include_extra_sound, char *out) {
-    out[0] = '\0';
-
-    if (strlen(conso) > 0 && strlen(vowel) == 0 && strcmp(conso, "STN") == 0) {
-        if (include_extra_sound) {
-            const char *extra = get_second_sound(particle_str);
-            strcpy(out, extra);
-        } else {
-            out[0] = '\0';
-        }
+// ローマ字を追加し、最後の文字の後の区切り種別を pace に記録する
+static void roma_append(mejiro_sb_t *roma_output, uint8_t *pace, const char *roma, uint8_t end_flags) {
+    const size_t start = roma_output->len;
+    mejiro_sb_append(roma_output, roma);
+    if (roma_output->len == start) {
         return;
     }
+    memset(pace + start, 0, roma_output->len - start);
+    pace[roma_output->len - 1] = end_flags;
+}
 
-    char conso_vowel[32];
-    strcpy(conso_vowel, conso);
-    strcat(conso_vowel, vowel);
-    const char *exception_kana = check_exception_kana(conso_vowel);
-    bool prefer_exception = (strcmp(particle_str, "n") == 0 ||
-                             strcmp(particle_str, "tk") == 0 ||
-                             strcmp(particle_str, "ntk") == 0);
-    if (prefer_exception && exception_kana != NULL) {
-        strcpy(out, exception_kana);
-
-        if (strcmp(particle_str, "tk") == 0) {
-            if (strcmp(conso_vowel, "SKIAU") == 0) {
-                strcpy(out, "ちぇ");
-            } else if (strcmp(conso_vowel, "STKNIAU") == 0) {
-                strcpy(out, "じぇ");
-            } else if (strcmp(conso_vowel, "STNIAU") == 0) {
-                strcpy(out, "しぇ");
-            } else if (strcmp(conso_vowel, "TNYIAU") == 0) {
-                strcpy(out, "いぇ");
-            }
-        }
+// 促音: 次の音の頭子音を重ねる。母音頭・次が無い場合は「xtu」
+// n（重ねると「ん」）・x（小書き）・記号で始まる場合も重ねても「っ」にならないので「xtu」
+// 重ねた子音だけでは「っ」にならないので、次の仮名の区切りに数える分 (0/1) を返す
+static uint8_t roma_append_sokuon(mejiro_sb_t *roma_output, uint8_t *pace, const char *next_roma) {
+    const char c = next_roma != NULL ? next_roma[0] : '\0';
 
-        if (include_extra_sound) {
-            const char *extra = get_second_sound(particle_str);
-            strcat(out, extra);
-        }
-        return;
+    if (c < 'a' || c > 'z' || strchr("aiueonx", c) != NULL) {
+        roma_append(roma_output, pace, "xtu", MEJIRO_PACE_KANA_END | MEJIRO_PACE_KANA(1));
+        return 0;
     }
+    const char doubled[2] = {c, '\0'};
+    roma_append(roma_output, pace, doubled, MEJIRO_PACE_SOKUON);
+    return 1;
+}
 
-    char vowel_particle[32];
-    strcpy(vowel_particle, vowel);
-    strcat(vowel_particle, particle_str);
-    const char *first_vowel = NULL;
-    const char *suffix = NULL;
-    bool is_english = check_english_diphthong(vowel_particle, &first_vowel, &suffix);
-
-    if (is_english) {
-        const char *c_roma = get_conso_roma(conso);
-        if (c_roma == NULL) c_roma = "";
+#if MEJIRO_ROMA_SINGLE_N
+// 「ん」の次の音が子音（y・n 以外）で始まれば、「ん」は n 一つで確定する
+static bool roma_single_n(const char *next) {
+    size_t match_len;
+    const char *r = ((mejiro_kana_t)*next == MK_SOKUON || *next == '\0')
+                        ? NULL
+                        : kana_roma_lookup(next, &match_len);
 
-        int v_idx = -1;
-        for (uint8_t j = 0; j < sizeof(vowel_table)/sizeof(vowel_table[0]); j++) {
-            if (strcmp(vowel_table[j].roma, first_vowel) == 0) {
-                v_idx = vowel_table[j].index;
-                break;
-            }
-        }
-        if (v_idx < 0) v_idx = 0;
+    return r != NULL && r[0] >= 'a' && r[0] <= 'z' && strchr("aiueoyn", r[0]) == NULL;
+}
+#endif
 
-        int c_idx = get_roma_index(c_roma);
-        if (c_idx < 0) c_idx = 0;
+// 仮名コード列をローマ字に変換（生成済みトライで最長一致、一回の走査）
+// 「っ」は次の音を引いたときに重ねる子音を決める。
+// pace は roma_output と同じ大きさで、各文字の後の区切り (MEJIRO_PACE_*) を受け取る
+void kana_to_roma_zmk(const char *kana_input, char *roma_buf, uint8_t *pace,
+                      size_t output_size) {
+    mejiro_sb_t roma;
+    mejiro_sb_init(&roma, roma_buf, output_size);
+    mejiro_sb_t *roma_output = &roma;
+    memset(pace, 0, output_size);
+    const char *p = kana_input;
+    bool sokuon = false;
+    uint8_t carried = 0; /* っ ending at the next kana */
 
-        const char *base_kana = kana_table[c_idx][v_idx];
+    while (*p && roma.len < output_size - 10) {
+        size_t match_len = 1;
+        const char *r = kana_roma_lookup(p, &match_len);
 
-        if (strcmp(base_kana, "ち") == 0) {
-            base_kana = "てぃ";
-        } else if (strcmp(base_kana, "ぢ") == 0) {
-            base_kana = "でぃ";
-        } else if (strcmp(base_kana, "づ") == 0) {
-            base_kana = "どぅ";
-        } else if (strcmp(base_kana, "ぁ") == 0) {
-            base_kana = "すた";
-        } else if (strcmp(base_kana, "ぃ") == 0) {
-            base_kana = "すち";
-        } else if (strcmp(base_kana, "ぅ") == 0) {
-            base_kana = "すてぃ";
-        } else if (strcmp(base_kana, "ぇ") == 0) {
-            base_kana = "すて";
-        } else if (strcmp(base_kana, "ぉ") == 0) {
-            base_kana = "すと";
+        if (sokuon) {
+            carried += roma_append_sokuon(roma_output, pace, r);
+            sokuon = false;
         }
-
-        strcpy(out, base_kana);
-        strcat(out, suffix);
-
-        if (strcmp(out, "るしょん") == 0) {
-            strcpy(out, "りゅーしょん");
-        } else if (strcmp(out, "ふしょん") == 0) {
-            strcpy(out, "ふゅーじょん");
+        if ((mejiro_kana_t)*p == MK_SOKUON) {
+            sokuon = true;
+            p++;
+            continue;
         }
-        return;
-    }
-
-    bool is_minor = check_minor_diphthong(vowel_particle, &first_vowel, &suffix);
-    if (is_minor) {
-        const char *c_roma = get_conso_roma(conso);
-        if (c_roma == NULL) c_roma = "";
 
-        int v_idx = -1;
-        for (uint8_t j = 0; j < sizeof(vowel_table)/sizeof(vowel_table[0]); j++) {
-            if (strcmp(vowel_table[j].roma, first_vowel) == 0) {
-                v_idx = vowel_table[j].index;
-                break;
-            }
+#if MEJIRO_ROMA_SINGLE_N
+        if ((mejiro_kana_t)*p == MK_NN && roma_single_n(p + 1)) {
+            roma_append(roma_output, pace, "n",
+                        MEJIRO_PACE_KANA_END | MEJIRO_PACE_KANA(1 + carried));
+            carried = 0;
+            p++;
+            continue;
         }
-        if (v_idx < 0) v_idx = 0;
-
-        int c_idx = get_roma_index(c_roma);
-        if (c_idx < 0) c_idx = 0;
-
-        const char *base_kana = kana_table[c_idx][v_idx];
-        strcpy(out, base_kana);
-        strcat(out, suffix);
-        return;
-    }
-
-    if (exception_kana != NULL) {
-        strcpy(out, exception_kana);
-
-        if (strcmp(particle_str, "tk") == 0) {
-            if (strcmp(conso_vowel, "SKIAU") == 0) {
-                strcpy(out, "ちぇ");
-            } else if (strcmp(conso_vowel, "STKNIAU") == 0) {
-                strcpy(out, "じぇ");
-            } else if (strcmp(conso_vowel, "STNIAU") == 0) {
-                strcpy(out, "しぇ");
-            } else if (strcmp(conso_vowel, "TNYIAU") == 0) {
-                strcpy(out, "いぇ");
+#endif
+        if (r != NULL) {
+            const size_t start = roma.len;
+            roma_append(roma_output, pace, r,
+                        MEJIRO_PACE_KANA_END | MEJIRO_PACE_KANA(match_len + carried));
+            carried = 0;
+            if ((mejiro_kana_t)*p == MK_NN) {
+                // 「ん」の最初の n は次の文字次第で解釈が変わる
+                pace[start] |= MEJIRO_PACE_AMBIG_N;
             }
+            p += match_len;
+            continue;
         }
 
-        if (include_extra_sound) {
-            const char *extra = get_second_sound(particle_str);
-            strcat(out, extra);
+        if (!MK_IS_KANA(*p)) {
+            const char ascii[2] = {*p, '\0'};
+            roma_append(roma_output, pace, ascii,
+                        MEJIRO_PACE_KANA_END | MEJIRO_PACE_KANA(1 + carried));
+            carried = 0;
         }
-    } else {
-        const char *c_roma = get_conso_roma(conso);
-        if (c_roma == NULL) c_roma = "";
+        p++;
+    }
+    if (sokuon) {
+        size_t match_len;
+        roma_append_sokuon(roma_output, pace, *p ? kana_roma_lookup(p, &match_len) : NULL);
+    }
+}
 
-        int v_idx = get_vowel_index(vowel);
-        if (v_idx < 0) v_idx = 0;
+#define C_STN (MJ_S | MJ_T | MJ_N)
+
+// 追加音を取得
+static const char *get_second_sound(uint8_t particle) {
+    return mejiro_second_sound[particle & 0x7];
+}
 
-        const char *normal_suffix = get_diphthong_suffix(vowel);
-        const char *extra_sound = "";
-        if (include_extra_sound) {
-            extra_sound = get_second_sound(particle_str);
-        }
 
-        int c_idx = get_roma_index(c_roma);
-        if (c_idx < 0) c_idx = 0;
+// 子音・母音・助詞（ハーフコード）から、かな文字列を生成する共通関数
+// include_extra_sound: 追加音を含めるかどうか（左+助詞パターンではfalse）
+static void convert_to_kana(uint16_t half, bool include_extra_sound, mejiro_sb_t *out) {
+    const mejiro_kana_entry_t *entry = &mejiro_kana_halves[half & MJ_HALF_MASK];
 
-        const char *base_kana = kana_table[c_idx][v_idx];
-        strcpy(out, base_kana);
-        strcat(out, normal_suffix);
-        strcat(out, extra_sound);
+    mejiro_sb_append(out, &mejiro_kana_pool[entry->kana]);
+    if (include_extra_sound && (entry->flags & MEJIRO_KANA_EXTRA)) {
+        mejiro_sb_append(out, get_second_sound(MJ_HALF_PARTICLE(half)));
     }
 }
 
-// 助詞変換
-static void transform_joshi(const char *left_stroke, const char *right_stroke, char *out) {
+// 助詞変換（左右の助詞コード）、out の末尾に仮名コードで追加する
+static void transform_joshi(uint8_t left_stroke, uint8_t right_stroke, mejiro_sb_t *out) {
     // right_strokeからnを除去
-    char right_tk[16] = {0};
-    bool has_comma = false;
-
-    if (strstr(right_stroke, "n") != NULL) {
-        has_comma = true;
-        // nを除去
-        const char *p = right_stroke;
-        char *q = right_tk;
-        while (*p) {
-            if (*p != 'n') *q++ = *p;
-            p++;
-        }
-        *q = '\0';
-    } else {
-        strcpy(right_tk, right_stroke);
-    }
-
-    // インデックス取得
-    int l_idx = -1, r_idx = -1;
-    for (uint8_t i = 0; i < sizeof(particle_key_list)/sizeof(particle_key_list[0]); i++) {
-        if (strcmp(left_stroke, particle_key_list[i]) == 0) l_idx = i;
-        if (strcmp(right_tk, particle_key_list[i]) == 0) r_idx = i;
-    }
-
-    if (l_idx < 0 || r_idx < 0) {
-        out[0] = '\0';
-        return;
-    }
+    const bool has_comma = (right_stroke & P_N) != 0;
+    const uint8_t right_tk = right_stroke & ~P_N;
 
     // 助詞組み立て
-    if (strcmp(left_stroke, "n") == 0) {
-        strcpy(out, r_particle[r_idx]);
-        strcat(out, "、");
-    } else if ((strcmp(right_stroke, "k") == 0 || strcmp(right_stroke, "nk") == 0) && strcmp(left_stroke, "") != 0) {
-        strcpy(out, "の");
-        strcat(out, l_particle[l_idx]);
-        if (strcmp(out, "のの") == 0) strcpy(out, "な");
-        if (has_comma) strcat(out, "、");
+    if (left_stroke == P_N) {
+        mejiro_sb_append(out, mejiro_r_particle[right_tk]);
+        mejiro_sb_push(out, (char)MK_TOUTEN);
+    } else if ((right_stroke == P_K || right_stroke == (P_N | P_K)) && left_stroke != 0) {
+        // 「の」+「の」は「な」
+        if (left_stroke == P_K) {
+            mejiro_sb_push(out, (char)MK_KANA(MK_ROW_N, MK_DAN_A));
+        } else {
+            mejiro_sb_push(out, (char)MK_KANA(MK_ROW_N, MK_DAN_O));
+            mejiro_sb_append(out, mejiro_l_particle[left_stroke]);
+        }
+        if (has_comma) mejiro_sb_push(out, (char)MK_TOUTEN);
     } else {
-        strcpy(out, l_particle[l_idx]);
-        strcat(out, r_particle[r_idx]);
-        if (has_comma) strcat(out, "、");
+        mejiro_sb_append(out, mejiro_l_particle[left_stroke]);
+        mejiro_sb_append(out, mejiro_r_particle[right_tk]);
+        if (has_comma) mejiro_sb_push(out, (char)MK_TOUTEN);
     }
 }
 
-mejiro_result_t_zmk mejiro_transform_zmk(const char *mejiro_id) {
-    mejiro_result_t_zmk result = {{0}, 0, false};
+// 略語・活用の仮名コード列を結果にコピーする（収まらない分は切り捨て）
+static void result_set_kana(mejiro_result_t_zmk *result, const char *kana) {
+    mejiro_sb_t out;
+    mejiro_sb_init(&out, result->kana, sizeof(result->kana));
+    mejiro_sb_append(&out, kana);
+}
 
-    char left[32] = {0};
-    char right[32] = {0};
-    parse_mejiro_id(mejiro_id, left, right);
+mejiro_result_t_zmk mejiro_transform_zmk(mejiro_stroke_t stroke) {
+    mejiro_result_t_zmk result = {{0}, 0, false};
 
     // 削除操作（-U、-AU）の場合は持ち越しの「っ」をクリア
-    if (strcmp(mejiro_id, "-U") == 0 || strcmp(mejiro_id, "-AU") == 0) {
+    if (stroke == MJ_STROKE(0, MJ_HALF(0, MJ_U, 0)) ||
+        stroke == MJ_STROKE(0, MJ_HALF(0, MJ_A | MJ_U, 0))) {
         pending_tsu = false;
     }
 
     // 全押し（STKNYIAUntk#-STKNYIAUntk*）は「何も出力しない」ことで誤入力をキャンセル
-    if (strcmp(left, "STKNYIAUntk#") == 0 && strcmp(right, "STKNYIAUntk*") == 0) {
+    if (stroke == MJ_STROKE_ALL) {
         return result;  // output is empty, success remains false
     }
 
-    // 左側のパース: 子音(STKN) + 母音(YIAU) + 助詞(ntk)
-    char l_conso[16] = {0};
-    char l_vowel[16] = {0};
-    char l_particle_str[16] = {0};
+    // 左側: 子音(STKN) + 母音(YIAU) + 助詞(ntk)
+    const uint16_t left = MJ_LEFT(stroke);
+    const uint8_t l_conso = MJ_HALF_CONSO(left);
+    uint8_t l_vowel = MJ_HALF_VOWEL(left);
+    const uint8_t l_part = MJ_HALF_PARTICLE(left);
 
-    const char *p = left;
-    while (*p && (*p == 'S' || *p == 'T' || *p == 'K' || *p == 'N')) {
-        size_t len = strlen(l_conso);
-        l_conso[len] = *p;
-        l_conso[len + 1] = '\0';
-        p++;
-    }
-    while (*p && (*p == 'Y' || *p == 'I' || *p == 'A' || *p == 'U')) {
-        size_t len = strlen(l_vowel);
-        l_vowel[len] = *p;
-        l_vowel[len + 1] = '\0';
-        p++;
-    }
-    while (*p && (*p == 'n' || *p == 't' || *p == 'k' || *p == '#')) {
-        size_t len = strlen(l_particle_str);
-        l_particle_str[len] = *p;
-        l_particle_str[len + 1] = '\0';
-        p++;
-    }
-
-    // 右側のパース: 子音(STKN) + 母音(YIAU) + 助詞(ntk) + 末尾のアスタリスク(*)
-    char r_conso[16] = {0};
-    char r_vowel[16] = {0};
-    char r_particle_str[16] = {0};
-    bool has_asterisk = false;
-
-    p = right;
-    while (*p && (*p == 'S' || *p == 'T' || *p == 'K' || *p == 'N')) {
-        size_t len = strlen(r_conso);
-        r_conso[len] = *p;
-        r_conso[len + 1] = '\0';
-        p++;
-    }
-    while (*p && (*p == 'Y' || *p == 'I' || *p == 'A' || *p == 'U')) {
-        size_t len = strlen(r_vowel);
-        r_vowel[len] = *p;
-        r_vowel[len + 1] = '\0';
-        p++;
-    }
-    while (*p && (*p == 'n' || *p == 't' || *p == 'k')) {
-        size_t len = strlen(r_particle_str);
-        r_particle_str[len] = *p;
-        r_particle_str[len + 1] = '\0';
-        p++;
-    }
-    if (*p == '*') {
-        has_asterisk = true;
-        p++;
-    }
+    // 右側: 子音(STKN) + 母音(YIAU) + 助詞(ntk) + アスタリスク(*)
+    const uint16_t right = MJ_RIGHT(stroke);
+    const uint8_t r_conso = MJ_HALF_CONSO(right);
+    uint8_t r_vowel = MJ_HALF_VOWEL(right);
+    const uint8_t r_part = MJ_HALF_PARTICLE(right);
+    const bool has_asterisk = (stroke & MJ_STAR) != 0;
 
     // 動詞活用チェック（通常の変換より先に）。Plover版同様、アスタリスクがある場合のみ動詞略語を試行。
     if (has_asterisk) {
-        // 完全なストロークを構築（アスタリスクを除く）
-        char full_stroke[128];
-        snprintf(full_stroke, sizeof(full_stroke), "%s%s%s-%s%s%s",
-                 l_conso, l_vowel, l_particle_str,
-                 r_conso, r_vowel, r_particle_str);
+        // 完全なストローク（アスタリスクを除く）
+        const mejiro_stroke_t full_stroke = stroke & ~(MJ_STAR | MJ_HASH);
 
         // 一般略語用のストローク（助詞なし）
-        char abbr_stroke[128];
-        snprintf(abbr_stroke, sizeof(abbr_stroke), "%s%s-%s%s",
-                 l_conso, l_vowel, r_conso, r_vowel);
+        const mejiro_stroke_t abbr_stroke =
+            MJ_STROKE(left & MJ_HALF_KANA_MASK, right & MJ_HALF_KANA_MASK);
 
         // ユーザー略語チェック（最優先、助詞込み）
         abbreviation_result_t user_abbr = mejiro_user_abbreviation(full_stroke);
         if (user_abbr.success) {
-            result.kana_length = utf8_char_count(user_abbr.output);
-            kana_to_roma_zmk(user_abbr.output, result.output, sizeof(result.output));
+            result.kana_length = strlen(user_abbr.output);
+            result_set_kana(&result, user_abbr.output);
             result.success = true;
             return result;
         }
@@ -3253,178 +2491,133 @@ mejiro_result_t_zmk mejiro_transform_zmk(const char *mejiro_id) {
         abbreviation_result_t abstract_abbr = mejiro_abstract_abbreviation(abbr_stroke);
         if (abstract_abbr.success) {
             // 一般略語の出力に助詞を追加
-            char kana_output[256] = {0};
-            strcpy(kana_output, abstract_abbr.output);
-            result.kana_length = utf8_char_count(kana_output);
+            char kana_buf[256];
+            mejiro_sb_t kana_output;
+            mejiro_sb_init(&kana_output, kana_buf, sizeof(kana_buf));
+            mejiro_sb_append(&kana_output, abstract_abbr.output);
+            result.kana_length = kana_output.len;
 
             // 助詞がある場合は追加
-            if (strlen(l_particle_str) > 0 || strlen(r_particle_str) > 0) {
-                // 助詞パターンを構築
-                char particle_pattern[32];
-                snprintf(particle_pattern, sizeof(particle_pattern), "%s-%s", l_particle_str, r_particle_str);
-
+            if (l_part != 0 || r_part != 0) {
                 // 特定の助詞パターンに対して語尾に変換
-                if (strcmp(particle_pattern, "n-") == 0) {
-                    strcat(kana_output, "である");
-                } else if (strcmp(particle_pattern, "-n") == 0) {
-                    strcat(kana_output, "だ");
-                } else if (strcmp(particle_pattern, "n-n") == 0) {
-                    strcat(kana_output, "だった");
-                } else if (strcmp(particle_pattern, "-ntk") == 0) {
-                    strcat(kana_output, "です");
-                } else if (strcmp(particle_pattern, "n-ntk") == 0) {
-                    strcat(kana_output, "でした");
-                } else if (strcmp(particle_pattern, "-nt") == 0) {
-                    strcat(kana_output, "。");
-                } else if (strcmp(particle_pattern, "-nk") == 0) {
-                    strcat(kana_output, "、");
-                } else if (strcmp(particle_pattern, "n-nt") == 0) {
-                    strcat(kana_output, "?");
-                } else if (strcmp(particle_pattern, "n-nk") == 0) {
-                    strcat(kana_output, "!");
+                const char *ending = NULL;
+                for (size_t i = 0; mejiro_abstract_endings[i].output != NULL; i++) {
+                    if (l_part == mejiro_abstract_endings[i].left_particle &&
+                        r_part == mejiro_abstract_endings[i].right_particle) {
+                        ending = mejiro_abstract_endings[i].output;
+                        break;
+                    }
+                }
+                if (ending != NULL) {
+                    mejiro_sb_append(&kana_output, ending);
                 } else {
                     // その他の助詞は通常通り処理
-                    char joshi_output[128] = {0};
-                    transform_joshi(l_particle_str, r_particle_str, joshi_output);
-                    strcat(kana_output, joshi_output);
+                    transform_joshi(l_part, r_part, &kana_output);
                 }
-                result.kana_length = utf8_char_count(kana_output);
+                result.kana_length = kana_output.len;
             }
 
-            kana_to_roma_zmk(kana_output, result.output, sizeof(result.output));
+            result_set_kana(&result, kana_buf);
             result.success = true;
             return result;
         }
 
         // 動詞略語チェック
-        char left_kana_temp[64] = {0};
-        char right_kana_temp[64] = {0};
+        char left_kana_temp[64];
+        char right_kana_temp[64];
+        mejiro_sb_t left_stem;
+        mejiro_sb_t right_stem;
+        mejiro_sb_init(&left_stem, left_kana_temp, sizeof(left_kana_temp));
+        mejiro_sb_init(&right_stem, right_kana_temp, sizeof(right_kana_temp));
         // 左側の仮名を生成（動詞語幹用）
-        if (strlen(l_conso) > 0 || strlen(l_vowel) > 0) {
-            convert_to_kana(l_conso, l_vowel, "", false, left_kana_temp);
+        if (l_conso != 0 || l_vowel != 0) {
+            convert_to_kana(left & MJ_HALF_KANA_MASK, false, &left_stem);
         }
         // 右側の仮名を生成（動詞語幹用）
-        if (strlen(r_conso) > 0 || strlen(r_vowel) > 0) {
-            convert_to_kana(r_conso, r_vowel, "", false, right_kana_temp);
+        if (r_conso != 0 || r_vowel != 0) {
+            convert_to_kana(right & MJ_HALF_KANA_MASK, false, &right_stem);
         }
 
-        verb_result_t verb_result = mejiro_verb_conjugate(
-            l_conso, l_vowel, l_particle_str,
-            r_conso, r_vowel, r_particle_str,
-            left_kana_temp, right_kana_temp
-        );
+        verb_result_t verb_result = mejiro_verb_conjugate(left, right, left_kana_temp, right_kana_temp);
 
         if (verb_result.success) {
-            // 動詞活用結果をローマ字に変換して返す
-            char kana_output[128];
-            strcpy(kana_output, verb_result.output);
-            result.kana_length = utf8_char_count(kana_output);
-            kana_to_roma_zmk(kana_output, result.output, sizeof(result.output));
+            // 動詞活用結果を返す
+            result.kana_length = strlen(verb_result.output);
+            result_set_kana(&result, verb_result.output);
             result.success = true;
             return result;
         }
     }
 
+    const bool has_left_kana = l_conso != 0 || l_vowel != 0;
+    const bool has_right_kana = r_conso != 0 || r_vowel != 0;
+
     // 助詞のみの場合は助詞変換
-    bool is_particle_only = (strlen(l_conso) == 0 && strlen(l_vowel) == 0 &&
-                             strlen(r_conso) == 0 && strlen(r_vowel) == 0 &&
-                             (strlen(l_particle_str) > 0 || strlen(r_particle_str) > 0));
+    bool is_particle_only = (!has_left_kana && !has_right_kana &&
+                             (l_part != 0 || r_part != 0));
 
     // 左+助詞かどうかを先に判定（左側の追加音を除外するため）
     // ただし、ntk-nの場合は除外（これは左側の追加音「ーん」として処理すべき）
-    bool is_left_plus_particle = ((strlen(l_conso) > 0 || strlen(l_vowel) > 0) &&
-                                  strlen(r_conso) == 0 && strlen(r_vowel) == 0 &&
-                                  strlen(r_particle_str) > 0 &&
-                                  !(strcmp(l_particle_str, "ntk") == 0 && strcmp(r_particle_str, "n") == 0));
+    bool is_left_plus_particle = (has_left_kana && !has_right_kana &&
+                                  r_part != 0 &&
+                                  !(l_part == (P_N | P_T | P_K) && r_part == P_N));
 
     // ntk-nの特殊ケース: 左の追加音と右の助詞として処理
-    bool is_ntk_n = (strlen(l_conso) > 0 || strlen(l_vowel) > 0) &&
-                   strlen(r_conso) == 0 && strlen(r_vowel) == 0 &&
-                   strcmp(l_particle_str, "ntk") == 0 && strcmp(r_particle_str, "n") == 0;
+    bool is_ntk_n = has_left_kana && !has_right_kana &&
+                    l_part == (P_N | P_T | P_K) && r_part == P_N;
 
     // 母音の補完処理
     // 左側の母音が空で、左側に子音がある場合、前回の母音を使用
-    if (strlen(l_vowel) == 0 && strlen(l_conso) > 0 && strcmp(l_conso, "STN") != 0) {
-        strcpy(l_vowel, last_vowel_stroke);
+    if (l_vowel == 0 && l_conso != 0 && l_conso != C_STN) {
+        l_vowel = last_vowel_stroke;
     }
     // 右側の母音が空で、右側に子音がある場合、左の母音を使用（左も空なら前回の母音）
-    if (strlen(r_vowel) == 0 && strlen(r_conso) > 0 && strcmp(r_conso, "STN") != 0) {
-        if (strlen(l_vowel) > 0) {
-            strcpy(r_vowel, l_vowel);
+    if (r_vowel == 0 && r_conso != 0 && r_conso != C_STN) {
+        if (l_vowel != 0) {
+            r_vowel = l_vowel;
         } else {
-            strcpy(r_vowel, last_vowel_stroke);
+            r_vowel = last_vowel_stroke;
         }
     }
 
     // 使用した母音を保存（右が優先、なければ左、どちらもなければ保存しない）
-    if (strlen(r_vowel) > 0) {
-        strcpy(last_vowel_stroke, r_vowel);
-    } else if (strlen(l_vowel) > 0) {
-        strcpy(last_vowel_stroke, l_vowel);
+    if (r_vowel != 0) {
+        last_vowel_stroke = r_vowel;
+    } else if (l_vowel != 0) {
+        last_vowel_stroke = l_vowel;
     }
 
     // 「っ」の持ち越し判定（左側と右側を別々に判定）
     // ただし、英語音・マイナー二重母音（母音+助詞）に該当する場合は「っ」を出力しないため、持ち越し対象から除外する
-    char left_vowel_particle[32] = {0};
-    strcpy(left_vowel_particle, l_vowel);
-    strcat(left_vowel_particle, l_particle_str);
-    const char *dummy_first_vowel_left = NULL;
-    const char *dummy_suffix_left = NULL;
-    bool is_english_left = check_english_diphthong(left_vowel_particle, &dummy_first_vowel_left, &dummy_suffix_left);
-    bool is_minor_left = check_minor_diphthong(left_vowel_particle, &dummy_first_vowel_left, &dummy_suffix_left);
-
-    char right_vowel_particle[32] = {0};
-    strcpy(right_vowel_particle, r_vowel);
-    strcat(right_vowel_particle, r_particle_str);
-    const char *dummy_first_vowel_right = NULL;
-    const char *dummy_suffix_right = NULL;
-    bool is_english_right = check_english_diphthong(right_vowel_particle, &dummy_first_vowel_right, &dummy_suffix_right);
-    bool is_minor_right = check_minor_diphthong(right_vowel_particle, &dummy_first_vowel_right, &dummy_suffix_right);
-
-    bool has_final_tsu_left = ((strlen(l_conso) > 0 || strlen(l_vowel) > 0) &&
-                               strcmp(l_particle_str, "tk") == 0 &&
-                               strlen(r_conso) == 0 && strlen(r_vowel) == 0 && strlen(r_particle_str) == 0 &&
-                               !is_english_left && !is_minor_left);
-    bool has_final_tsu_right = ((strlen(r_conso) > 0 || strlen(r_vowel) > 0) &&
-                                strcmp(r_particle_str, "tk") == 0 &&
-                                !is_left_plus_particle &&
-                                !is_english_right && !is_minor_right);
+    const uint8_t left_flags = mejiro_kana_halves[MJ_HALF(0, l_vowel, l_part)].flags;
+    const uint8_t right_flags = mejiro_kana_halves[MJ_HALF(0, r_vowel, r_part)].flags;
+
+    bool has_final_tsu_left = (has_left_kana &&
+                               (left_flags & MEJIRO_KANA_SOKUON) &&
+                               !has_right_kana && r_part == 0);
+    bool has_final_tsu_right = (has_right_kana &&
+                                (right_flags & MEJIRO_KANA_SOKUON) &&
+                                !is_left_plus_particle);
     bool has_final_tsu = has_final_tsu_left || has_final_tsu_right;
 
+    // 仮名コード列を result.kana に組み立てる
+    mejiro_sb_t kana;
+    mejiro_sb_init(&kana, result.kana, sizeof(result.kana));
+
     if (is_particle_only) {
-        transform_joshi(l_particle_str, r_particle_str, result.output);
+        transform_joshi(l_part, r_part, &kana);
     } else {
         // 前回持ち越しの「っ」を先頭に追加
         if (pending_tsu) {
-            strcpy(result.output, "っ");
+            mejiro_sb_push(&kana, (char)MK_SOKUON);
             pending_tsu = false;
-        } else {
-            result.output[0] = '\0';
-        }
-
-        // 「っ」の持ち越し判定
-        // 左側のみでtk助詞があり、右側がない場合（英語音・マイナー二重母音は除外）
-        if ((strlen(l_conso) > 0 || strlen(l_vowel) > 0) &&
-            strcmp(l_particle_str, "tk") == 0 &&
-            strlen(r_conso) == 0 && strlen(r_vowel) == 0 && strlen(r_particle_str) == 0 &&
-            !is_english_left && !is_minor_left) {
-            has_final_tsu = true;
-        }
-        // 右側にtk助詞がある場合（左+助詞パターンでない、かつ英語音・マイナー二重母音は除外）
-        if ((strlen(r_conso) > 0 || strlen(r_vowel) > 0) &&
-            strcmp(r_particle_str, "tk") == 0 &&
-            !is_left_plus_particle &&
-            !is_english_right && !is_minor_right) {
-            has_final_tsu = true;
         }
 
         // 左側変換
-        if (strlen(l_conso) > 0 || strlen(l_vowel) > 0) {
-            char left_kana[64] = {0};
+        if (has_left_kana) {
             // 左側自体が「っ」で終わる場合のみ追加音を除外
             bool include_extra = !is_left_plus_particle && !has_final_tsu_left;
-            convert_to_kana(l_conso, l_vowel, l_particle_str, include_extra, left_kana);
-            strcat(result.output, left_kana);
+            convert_to_kana(MJ_HALF(l_conso, l_vowel, l_part), include_extra, &kana);
         }
 
         // 左+助詞: 左側にかながあり、右側には助詞のみがある場合
@@ -3432,90 +2625,68 @@ mejiro_result_t_zmk mejiro_transform_zmk(const char *mejiro_id) {
         if (is_left_plus_particle) {
 
             // コマンドテーブルから助詞文字列を検索
-            char particle_pattern[32];
-            strcpy(particle_pattern, l_particle_str);
-            strcat(particle_pattern, "-");
-            strcat(particle_pattern, r_particle_str);
-
-            bool found_in_commands = false;
-            for (size_t i = 0; i < ARRAY_SIZE(mejiro_commands_zmk); i++) {
-                if (strcmp(particle_pattern, mejiro_commands_zmk[i].stroke) == 0) {
-                    if (mejiro_commands_zmk[i].kind == MJ_CMD_STRING && mejiro_commands_zmk[i].string != NULL) {
-                        strcat(result.output, mejiro_commands_zmk[i].string);
-                        found_in_commands = true;
-                        break;
-                    }
-                }
-            }
+            const mj_cmd_t *cmd = mejiro_find_command(
+                MJ_STROKE(MJ_HALF(0, 0, l_part), MJ_HALF(0, 0, r_part)));
 
-            // コマンドテーブルになければ、transform_joshiで助詞を生成
-            if (!found_in_commands) {
-                char joshi_output[64] = {0};
-                transform_joshi(l_particle_str, r_particle_str, joshi_output);
-                strcat(result.output, joshi_output);
+            if (cmd != NULL && cmd->kind == MJ_CMD_STRING && cmd->string != NULL) {
+                mejiro_kana_append(&kana, cmd->string);
+            } else {
+                // コマンドテーブルになければ、transform_joshiで助詞を生成
+                transform_joshi(l_part, r_part, &kana);
             }
         }
         // 左のかながなくても、左の追加音キーがあってかつ右のかながある場合
         // 左の追加音を先に出力
-        if (strlen(l_conso) == 0 && strlen(l_vowel) == 0 &&
-            strlen(l_particle_str) > 0 &&
-            (strlen(r_conso) > 0 || strlen(r_vowel) > 0)) {
-            const char *left_extra_sound = get_second_sound(l_particle_str);
-            strcat(result.output, left_extra_sound);
+        if (!has_left_kana && l_part != 0 && has_right_kana) {
+            const char *left_extra_sound = get_second_sound(l_part);
+            mejiro_sb_append(&kana, left_extra_sound);
         }
 
         // 右側変換
-        if (strlen(r_conso) > 0 || strlen(r_vowel) > 0) {
-            char right_kana[64] = {0};
+        if (has_right_kana) {
             // 右側自体が「っ」で終わる場合のみ追加音を除外
             bool include_extra = !has_final_tsu_right;
-            convert_to_kana(r_conso, r_vowel, r_particle_str, include_extra, right_kana);
-            strcat(result.output, right_kana);
+            convert_to_kana(MJ_HALF(r_conso, r_vowel, r_part), include_extra, &kana);
         }
     }
 
     // 「っ」の持ち越し設定または単体出力
     if (has_final_tsu) {
         // STNtkのような母音なしで「っ」単体の場合は「っ」を出力
-        if (strlen(l_conso) > 0 && strlen(l_vowel) == 0 &&
-            strcmp(l_conso, "STN") == 0 && strcmp(l_particle_str, "tk") == 0 &&
-            strlen(r_conso) == 0 && strlen(r_vowel) == 0) {
-            strcpy(result.output, "っ");
+        if (l_conso == C_STN && l_vowel == 0 && l_part == (P_T | P_K) && !has_right_kana) {
+            mejiro_sb_clear(&kana);
+            mejiro_sb_push(&kana, (char)MK_SOKUON);
         } else {
             // それ以外は次回に持ち越し（今回の出力から「っ」を除去）
             pending_tsu = true;
-            // 出力の末尾の「っ」を削除
-            char *tsu_pos = strstr(result.output, "っ");
-            if (tsu_pos != NULL && tsu_pos[3] == '\0') {  // 末尾の「っ」のみ
-                *tsu_pos = '\0';
+            // 出力の末尾の「っ」を削除（最初の「っ」が末尾にある場合のみ）
+            const char *tsu_pos = memchr(kana.buf, (char)MK_SOKUON, kana.len);
+            if (tsu_pos != NULL && (size_t)(tsu_pos - kana.buf) + 1 == kana.len) {
+                mejiro_sb_truncate(&kana, kana.len - 1);
             }
         }
     }
 
     // ntk-nの特殊ケース: 右の助詞「n」を「ん」として追加
     if (is_ntk_n) {
-        strcat(result.output, "ん");
+        mejiro_sb_push(&kana, (char)MK_NN);
     }
 
 
-    // ひらがな出力をローマ字に変換しつつ、ひらがな文字数を保持
     // 右だけの入力の場合は変換失敗として扱う（ただし右側の助詞単体は除く）
-    bool is_right_only = (strlen(l_conso) == 0 && strlen(l_vowel) == 0 &&
-                          strlen(l_particle_str) == 0 &&
-                          (strlen(r_conso) > 0 || strlen(r_vowel) > 0));
+    bool is_right_only = (!has_left_kana && l_part == 0 && has_right_kana);
 
     // 持ち越し状態で出力が空の場合は成功として扱わない
-    if (strlen(result.output) > 0 && !is_right_only) {
-        char kana_output[128];
-        strcpy(kana_output, result.output);
-        result.kana_length = utf8_char_count(kana_output);
-        kana_to_roma_zmk(kana_output, result.output, sizeof(result.output));
+    if (kana.len > 0 && !is_right_only) {
+        result.kana_length = kana.len;
         result.success = true;
     } else if (pending_tsu) {
         // 持ち越し中は空出力だが成功扱い
+        mejiro_sb_clear(&kana);
         result.kana_length = 0;
         result.success = true;
     } else {
+        mejiro_sb_clear(&kana);
         result.kana_length = 0;
         result.success = false;
     }
@@ -3523,6 +2694,104 @@ mejiro_result_t_zmk mejiro_transform_zmk(const char *mejiro_id) {
     return result;
 }
 
+#if IS_ENABLED(CONFIG_NAGINATA_MEJIRO_BENCH)
+/*
+ * Conversion cost on the target, logged once after boot: kana_to_roma_zmk
+ * per kana on a fixed text, and a whole stroke (mejiro_transform_zmk, then
+ * kana_to_roma_zmk) per stroke on strokes spread over the whole code space.
+ * Timed with the timing API (the DWT cycle counter on Cortex-M) around whole
+ * rounds. The host bench (tests/host, mejiro_host_bench) runs the same text
+ * against the last release.
+ */
+static const char *const mejiro_bench_words[] = {
+    "きょう", "は", "いい", "てんき", "です", "ね", "めじろしき", "で", "にほんご", "を",
+    "うって", "います", "しゅうちゅう", "して", "れんしゅう", "すれば", "じゅうぶん",
+    "はやく", "なります", "りょこう", "の", "じゅんび", "しゅっぱつ", "しました", "ちゃんと",
+    "きっぷ", "ぴょんぴょん", "にゃあにゃあ", "ふぁいる", "うぇぶ", "ぺーじ", "ゔぁいおりん",
+};
+
+#define MEJIRO_BENCH_ROUNDS 20
+#define MEJIRO_BENCH_STROKE_STEP 16411u
+
+static void mejiro_bench_work_handler(struct k_work *work) {
+    static char words[ARRAY_SIZE(mejiro_bench_words)][32];
+    char roma[128];
+    uint8_t pace[128];
+    uint32_t kana_count = 0;
+    timing_t start, end;
+
+    for (size_t i = 0; i < ARRAY_SIZE(mejiro_bench_words); i++) {
+        kana_count += mejiro_kana_encode(mejiro_bench_words[i], words[i], sizeof(words[i]));
+    }
+
+    timing_init();
+    timing_start();
+
+    start = timing_counter_get();
+    for (int r = 0; r < MEJIRO_BENCH_ROUNDS; r++) {
+        for (size_t i = 0; i < ARRAY_SIZE(words); i++) {
+            kana_to_roma_zmk(words[i], roma, pace, sizeof(roma));
+        }
+    }
+    end = timing_counter_get();
+    uint64_t cycles = timing_cycles_get(&start, &end);
+    uint32_t n = MEJIRO_BENCH_ROUNDS * kana_count;
+    LOG_INF("mejiro bench: kana_to_roma_zmk %u cycles/kana, %u ns/kana", (uint32_t)(cycles / n),
+            (uint32_t)(timing_cycles_to_ns(cycles) / n));
+
+    /* the typing state is put back afterwards */
+    const uint8_t vowel = last_vowel_stroke;
+    const bool tsu = pending_tsu;
+    n = 0;
+    start = timing_counter_get();
+    for (int r = 0; r < MEJIRO_BENCH_ROUNDS; r++) {
+        for (mejiro_stroke_t stroke = 0; stroke <= MJ_STROKE_ALL;
+             stroke += MEJIRO_BENCH_STROKE_STEP) {
+            if (stroke & MJ_HASH) {
+                continue;
+            }
+            last_vowel_stroke = MJ_A;
+            pending_tsu = false;
+            const mejiro_result_t_zmk res = mejiro_transform_zmk(stroke);
+            if (res.success && res.kana[0] != '\0') {
+                kana_to_roma_zmk(res.kana, roma, pace, sizeof(roma));
+            }
+            n++;
+        }
+    }
+    end = timing_counter_get();
+    cycles = timing_cycles_get(&start, &end);
+    last_vowel_stroke = vowel;
+    pending_tsu = tsu;
+    LOG_INF("mejiro bench: stroke to romaji %u cycles/stroke, %u ns/stroke",
+            (uint32_t)(cycles / n), (uint32_t)(timing_cycles_to_ns(cycles) / n));
+
+    timing_stop();
+}
+#endif
+
+/* Resolve the string strokes of the lookup tables to packed codes. */
+static void mejiro_tables_init(void) {
+    for (size_t i = 0; i < ARRAY_SIZE(mejiro_commands_zmk); i++) {
+        mejiro_command_codes[i] = mejiro_stroke_from_string(mejiro_commands_zmk[i].stroke);
+    }
+    for (size_t i = 0; mejiro_user_abbreviations[i].stroke != NULL; i++) {
+        user_abbreviation_codes[i] = mejiro_stroke_from_string(mejiro_user_abbreviations[i].stroke);
+    }
+    for (size_t i = 0; mejiro_abstract_abbreviations[i].stroke != NULL; i++) {
+        abstract_abbreviation_codes[i] = mejiro_stroke_from_string(mejiro_abstract_abbreviations[i].stroke);
+    }
+    for (size_t i = 0; mejiro_abstract_left[i].stroke != NULL; i++) {
+        abstract_left_codes[i] = mejiro_half_from_string(mejiro_abstract_left[i].stroke);
+    }
+    for (size_t i = 0; mejiro_abstract_right[i].stroke != NULL; i++) {
+        abstract_right_codes[i] = mejiro_half_from_string(mejiro_abstract_right[i].stroke);
+    }
+    for (size_t i = 0; mejiro_verb_dict[i].stroke != NULL; i++) {
+        verb_dict_codes[i] = mejiro_stroke_from_string(mejiro_verb_dict[i].stroke);
+    }
+}
+
 static uint32_t keycode_from_ascii_basic(char c) {
     if (c >= 'a' && c <= 'z') {
         c = (char)(c - 'a' + 'A');
@@ -3534,6 +2803,8 @@ static uint32_t keycode_from_ascii_basic(char c) {
     case 'P': return P; case 'Q': return Q; case 'R': return R; case 'S': return S; case 'T': return T;
     case 'U': return U; case 'V': return V; case 'W': return W; case 'X': return X; case 'Y': return Y;
     case 'Z': return Z;
+    case '0': return N0; case '1': return N1; case '2': return N2; case '3': return N3; case '4': return N4;
+    case '5': return N5; case '6': return N6; case '7': return N7; case '8': return N8; case '9': return N9;
     case '-': return MINUS;
     case ',': return COMMA;
     case '.': return DOT;
@@ -3547,155 +2818,413 @@ static uint32_t keycode_from_ascii_basic(char c) {
     }
 }
 
-static void send_mejiro_command_string(const char *s) {
-    if (!s) {
-        return;
+// Shift付きで送る記号（winJIS配列の位置）
+static const struct {
+    char c;
+    uint8_t usage;
+} mejiro_shifted_ascii[] = {
+    {'"', HID_USAGE_KEY_KEYBOARD_APOSTROPHE_AND_QUOTE},
+    {'(', HID_USAGE_KEY_KEYBOARD_8_AND_ASTERISK},
+    {')', HID_USAGE_KEY_KEYBOARD_9_AND_LEFT_PARENTHESIS},
+    {'<', HID_USAGE_KEY_KEYBOARD_COMMA_AND_LESS_THAN},
+    {'>', HID_USAGE_KEY_KEYBOARD_PERIOD_AND_GREATER_THAN},
+    {':', HID_USAGE_KEY_KEYBOARD_SEMICOLON_AND_COLON},
+    {'|', HID_USAGE_KEY_KEYBOARD_BACKSLASH_AND_PIPE},
+    {'*', HID_USAGE_KEY_KEYBOARD_8_AND_ASTERISK},
+    {'~', HID_USAGE_KEY_KEYBOARD_EQUAL_AND_PLUS},
+    {'?', HID_USAGE_KEY_KEYBOARD_SLASH_AND_QUESTION_MARK},
+    {'!', HID_USAGE_KEY_KEYBOARD_1_AND_EXCLAMATION},
+};
+
+/* One ASCII char as a compiled key (no pace); false if it has no key. */
+static bool mejiro_key_from_ascii(char c, mejiro_key_t *key) {
+    const uint32_t kc = keycode_from_ascii_basic(c);
+
+    if (kc != NONE) {
+        key->usage = (uint8_t)(kc & 0xFF);
+        key->flags = 0;
+        return true;
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(mejiro_shifted_ascii); i++) {
+        if (mejiro_shifted_ascii[i].c == c) {
+            key->usage = mejiro_shifted_ascii[i].usage;
+            key->flags = MEJIRO_KEY_SHIFT;
+            return true;
+        }
     }
+    return false;
+}
 
-    for (size_t i = 0; s[i] != '\0'; ) {
+// コマンドの文字列をキー列にする（{#Left} は←キー）
+static uint16_t mejiro_compile_command_string(const char *s, mejiro_key_t *keys, size_t max_keys) {
+    uint16_t n = 0;
+
+    for (size_t i = 0; s[i] != '\0' && n < max_keys;) {
         if (strncmp(&s[i], "{#Left}", 7) == 0) {
-            tap_key(MJ_KC(HID_USAGE_KEY_KEYBOARD_LEFTARROW));
+            keys[n].usage = HID_USAGE_KEY_KEYBOARD_LEFTARROW;
+            keys[n].flags = 0;
+            n++;
             i += 7;
             continue;
         }
+        if (mejiro_key_from_ascii(s[i], &keys[n])) {
+            n++;
+        }
+        i++;
+    }
+    return n;
+}
 
-        switch (s[i]) {
-        case '"':
-            mod_tap(MJ_KC_LSFT, SQT);
-            i++;
-            continue;
-        case '(':
-            mod_tap(MJ_KC_LSFT, N8);
-            i++;
-            continue;
-        case ')':
-            mod_tap(MJ_KC_LSFT, N9);
-            i++;
-            continue;
-        case '<':
-            mod_tap(MJ_KC_LSFT, COMMA);
-            i++;
-            continue;
-        case '>':
-            mod_tap(MJ_KC_LSFT, DOT);
-            i++;
-            continue;
-        case ':':
-            mod_tap(MJ_KC_LSFT, SEMI);
-            i++;
-            continue;
-        case '|':
-            mod_tap(MJ_KC_LSFT, MJ_KC(HID_USAGE_KEY_KEYBOARD_BACKSLASH_AND_PIPE));
-            i++;
-            continue;
-        case '*':
-            mod_tap(MJ_KC_LSFT, MJ_KC(HID_USAGE_KEY_KEYBOARD_8_AND_ASTERISK));
-            i++;
-            continue;
-        case '~':
-            mod_tap(MJ_KC_LSFT, MJ_KC(HID_USAGE_KEY_KEYBOARD_EQUAL_AND_PLUS));
-            i++;
+static uint8_t mejiro_mod_flag(uint32_t mod_keycode) {
+    switch (mod_keycode) {
+    case MJ_KC_LSFT:
+        return MEJIRO_KEY_SHIFT;
+    case MJ_KC_LCTRL:
+        return MEJIRO_KEY_CTRL;
+    case MJ_KC_LALT:
+        return MEJIRO_KEY_ALT;
+    default:
+        return 0;
+    }
+}
+
+/* Key/modifier/string commands as compiled keys, so repeats only replay them. */
+static uint16_t mejiro_compile_command(const mj_cmd_t *cmd, mejiro_key_t *keys, size_t max_keys) {
+    if (cmd->kind == MJ_CMD_STRING) {
+        return cmd->string != NULL ? mejiro_compile_command_string(cmd->string, keys, max_keys) : 0;
+    }
+    keys[0].usage = (uint8_t)(cmd->keycode & 0xFF);
+    keys[0].flags = mejiro_mod_flag(cmd->mod) | mejiro_mod_flag(cmd->mod2);
+    return 1;
+}
+
+static void send_mejiro_command_string(const char *s) {
+    mejiro_key_t keys[64];
+
+    if (!s) {
+        return;
+    }
+    send_mejiro_keys(keys, mejiro_compile_command_string(s, keys, ARRAY_SIZE(keys)), 1);
+}
+
+// ローマ字出力をキー列にコンパイルする（区切りの pace と Shift を各キーに持たせる）
+static uint16_t mejiro_compile_roma(const char *output, const uint8_t *pace, mejiro_key_t *keys,
+                                    size_t max_keys) {
+    uint16_t n = 0;
+
+    for (const char *p = output; *p && n < max_keys; p++) {
+        /* without boundary info every key gets the inter-kana delay */
+        const uint8_t delay = (!pace || pace[p - output] != 0) ? NAGINATA_PACE_INTER_KANA
+                                                               : NAGINATA_PACE_INTRA_KANA;
+        if (!mejiro_key_from_ascii(*p, &keys[n])) {
             continue;
-        case '?':
-            mod_tap(MJ_KC_LSFT, SLASH);
-            i++;
+        }
+        keys[n].flags |= delay;
+        if (pace && (pace[p - output] & MEJIRO_PACE_KANA_END)) {
+            keys[n].flags |= MEJIRO_KEY_KANA(MEJIRO_PACE_KANA_COUNT(pace[p - output]));
+        }
+        /* "nn" at the end: the next queued stroke may let it be a single n */
+        if (pace && p[1] == '\0' && *p == 'n' && p > output &&
+            (pace[p - output - 1] & MEJIRO_PACE_AMBIG_N)) {
+            keys[n].flags |= MEJIRO_KEY_END_N;
+        }
+        n++;
+    }
+    return n;
+}
+
+/* --------------------------------------------------------------------------
+ * JIS kana-input output
+ *
+ * With the IME in kana input mode most kana are one key on the JIS layout,
+ * voiced and semi-voiced kana one more (゛/゜). The table holds the plain and
+ * small kana; the voiced rows are mapped to their plain row arithmetically.
+ * ゐ, ゑ, ゎ and "?" have no key in kana input and are dropped; "!" is
+ * Shift+1, as ぬ has no shifted kana.
+ * -------------------------------------------------------------------------- */
+
+#define JIS_KANA(row, col) (MK_KANA(MK_ROW_##row, col) & 0x7F)
+#define JK(u) {HID_USAGE_KEY_KEYBOARD_##u, 0}
+#define JK_S(u) {HID_USAGE_KEY_KEYBOARD_##u, MEJIRO_KEY_SHIFT}
+
+static const mejiro_key_t jis_kana_keys[128] = {
+    [JIS_KANA(A, 0)] = JK(3_AND_HASH),           [JIS_KANA(A, 1)] = JK(E),
+    [JIS_KANA(A, 2)] = JK(4_AND_DOLLAR),         [JIS_KANA(A, 3)] = JK(5_AND_PERCENT),
+    [JIS_KANA(A, 4)] = JK(6_AND_CARET),          [JIS_KANA(A, 5)] = JK(INTERNATIONAL3), /* ー */
+    [JIS_KANA(A, 6)] = JK_S(COMMA_AND_LESS_THAN), /* 、 */
+    [JIS_KANA(A, 7)] = JK_S(PERIOD_AND_GREATER_THAN), /* 。 */
+    [JIS_KANA(K, 0)] = JK(T), [JIS_KANA(K, 1)] = JK(G), [JIS_KANA(K, 2)] = JK(H),
+    [JIS_KANA(K, 3)] = JK(APOSTROPHE_AND_QUOTE), [JIS_KANA(K, 4)] = JK(B),
+    [JIS_KANA(S, 0)] = JK(X), [JIS_KANA(S, 1)] = JK(D), [JIS_KANA(S, 2)] = JK(R),
+    [JIS_KANA(S, 3)] = JK(P), [JIS_KANA(S, 4)] = JK(C),
+    [JIS_KANA(T, 0)] = JK(Q), [JIS_KANA(T, 1)] = JK(A), [JIS_KANA(T, 2)] = JK(Z),
+    [JIS_KANA(T, 3)] = JK(W), [JIS_KANA(T, 4)] = JK(S),
+    [JIS_KANA(N, 0)] = JK(U), [JIS_KANA(N, 1)] = JK(I), [JIS_KANA(N, 2)] = JK(1_AND_EXCLAMATION),
+    [JIS_KANA(N, 3)] = JK(COMMA_AND_LESS_THAN), [JIS_KANA(N, 4)] = JK(K),
+    [JIS_KANA(H, 0)] = JK(F), [JIS_KANA(H, 1)] = JK(V), [JIS_KANA(H, 2)] = JK(2_AND_AT),
+    [JIS_KANA(H, 3)] = JK(EQUAL_AND_PLUS), [JIS_KANA(H, 4)] = JK(MINUS_AND_UNDERSCORE),
+    [JIS_KANA(M, 0)] = JK(J), [JIS_KANA(M, 1)] = JK(N), [JIS_KANA(M, 2)] = JK(NON_US_HASH_AND_TILDE),
+    [JIS_KANA(M, 3)] = JK(SLASH_AND_QUESTION_MARK), [JIS_KANA(M, 4)] = JK(M),
+    [JIS_KANA(Y, 0)] = JK(7_AND_AMPERSAND),      [JIS_KANA(Y, 1)] = JK_S(7_AND_AMPERSAND),
+    [JIS_KANA(Y, 2)] = JK(8_AND_ASTERISK),       [JIS_KANA(Y, 3)] = JK_S(8_AND_ASTERISK),
+    [JIS_KANA(Y, 4)] = JK(9_AND_LEFT_PARENTHESIS), [JIS_KANA(Y, 5)] = JK_S(9_AND_LEFT_PARENTHESIS),
+    [JIS_KANA(R, 0)] = JK(O), [JIS_KANA(R, 1)] = JK(L), [JIS_KANA(R, 2)] = JK(PERIOD_AND_GREATER_THAN),
+    [JIS_KANA(R, 3)] = JK(SEMICOLON_AND_COLON), [JIS_KANA(R, 4)] = JK(INTERNATIONAL1),
+    [JIS_KANA(W, 0)] = JK(0_AND_RIGHT_PARENTHESIS), [JIS_KANA(W, 4)] = JK_S(0_AND_RIGHT_PARENTHESIS),
+    [JIS_KANA(W, 5)] = JK(Y),
+    [JIS_KANA(SMALL, 0)] = JK_S(3_AND_HASH),     [JIS_KANA(SMALL, 1)] = JK_S(E),
+    [JIS_KANA(SMALL, 2)] = JK_S(4_AND_DOLLAR),   [JIS_KANA(SMALL, 3)] = JK_S(5_AND_PERCENT),
+    [JIS_KANA(SMALL, 4)] = JK_S(6_AND_CARET),    [JIS_KANA(SMALL, 5)] = JK_S(Z), /* っ */
+};
+
+/* ASCII left in the kana output (です. / !) */
+static mejiro_kana_t jis_kana_from_ascii(char c) {
+    switch (c) {
+    case '.': return MK_KUTEN;
+    case ',': return MK_TOUTEN;
+    case '-': return MK_CHOON;
+    default: return 0;
+    }
+}
+
+/* 濁音・半濁音の行 → 清音の行 */
+static const uint8_t jis_kana_plain_row[16] = {
+    [MK_ROW_G] = MK_ROW_K, [MK_ROW_Z] = MK_ROW_S, [MK_ROW_D] = MK_ROW_T,
+    [MK_ROW_B] = MK_ROW_H, [MK_ROW_P] = MK_ROW_H,
+};
+
+#define JIS_DAKUTEN HID_USAGE_KEY_KEYBOARD_LEFT_BRACKET_AND_LEFT_BRACE   /* ゛ */
+#define JIS_HANDAKUTEN HID_USAGE_KEY_KEYBOARD_RIGHT_BRACKET_AND_RIGHT_BRACE /* ゜ */
+
+// 仮名コード列を JIS かな入力のキー列にコンパイルする（1仮名 1キー、濁点・半濁点は +1）
+static uint16_t mejiro_compile_jis_kana(const char *kana, mejiro_key_t *keys, size_t max_keys) {
+    uint16_t n = 0;
+
+    for (const char *p = kana; *p && n + 2 <= max_keys; p++) {
+        mejiro_kana_t c = (mejiro_kana_t)*p;
+        uint8_t mark = 0;
+
+        if (c == MK_KANA(MK_ROW_W, 2)) {
+            c = MK_KANA(MK_ROW_A, MK_DAN_U); /* ゔ = う + ゛ */
+            mark = JIS_DAKUTEN;
+        } else if (MK_IS_KANA(c) && jis_kana_plain_row[MK_ROW(c)] != 0) {
+            mark = MK_ROW(c) == MK_ROW_P ? JIS_HANDAKUTEN : JIS_DAKUTEN;
+            c = MK_KANA(jis_kana_plain_row[MK_ROW(c)], MK_COL(c));
+        }
+
+        if (c == '!') {
+            keys[n].usage = HID_USAGE_KEY_KEYBOARD_1_AND_EXCLAMATION;
+            keys[n].flags = MEJIRO_KEY_SHIFT | NAGINATA_PACE_INTER_KANA | MEJIRO_KEY_KANA(1);
+            n++;
             continue;
-        case '!':
-            mod_tap(MJ_KC_LSFT, N1);
-            i++;
+        }
+        if (!MK_IS_KANA(c)) {
+            c = jis_kana_from_ascii((char)c);
+        }
+
+        const mejiro_key_t *key = &jis_kana_keys[c & 0x7F];
+        if (c == 0 || key->usage == 0) {
             continue;
-        default:
-            break;
         }
 
-        uint32_t kc = keycode_from_ascii_basic(s[i]);
-        if (kc != NONE) {
-            tap_key(kc);
+        keys[n].usage = key->usage;
+        keys[n].flags = key->flags | (mark ? NAGINATA_PACE_INTRA_KANA
+                                           : NAGINATA_PACE_INTER_KANA | MEJIRO_KEY_KANA(1));
+        n++;
+        if (mark) {
+            keys[n].usage = mark;
+            keys[n].flags = NAGINATA_PACE_INTER_KANA | MEJIRO_KEY_KANA(1);
+            n++;
         }
-        i++;
     }
+    return n;
 }
 
-static void send_mejiro_roma(const char *output) {
-    if (!output) {
-        return;
+/* Output backend of converted strokes; switched at runtime by MJ_CMD_OUTPUT_MODE. */
+static enum {
+    MEJIRO_OUTPUT_ROMA,
+    MEJIRO_OUTPUT_JIS_KANA,
+} mejiro_output_mode = IS_ENABLED(CONFIG_NAGINATA_MEJIRO_JIS_KANA) ? MEJIRO_OUTPUT_JIS_KANA
+                                                                    : MEJIRO_OUTPUT_ROMA;
+
+// 仮名コード列を現在の出力方式のキー列にする（出力の直前でのみ変換する）
+static uint16_t mejiro_compile_kana(const char *kana, mejiro_key_t *keys, size_t max_keys) {
+    if (mejiro_output_mode == MEJIRO_OUTPUT_JIS_KANA) {
+        return mejiro_compile_jis_kana(kana, keys, max_keys);
     }
 
-    for (const char *p = output; *p; p++) {
-        uint32_t kc = keycode_from_ascii_basic(*p);
-        if (kc != NONE) {
-            tap_key(kc);
-            if (MEJIRO_ROMA_KEY_DELAY_MS > 0) {
-                k_msleep(MEJIRO_ROMA_KEY_DELAY_MS);
-            }
-            continue;
+    char roma[128];
+    uint8_t pace[sizeof(roma)];
+    kana_to_roma_zmk(kana, roma, pace, sizeof(roma));
+    return mejiro_compile_roma(roma, pace, keys, max_keys);
+}
+
+static void mejiro_toggle_output_mode(void) {
+    mejiro_output_mode = mejiro_output_mode == MEJIRO_OUTPUT_ROMA ? MEJIRO_OUTPUT_JIS_KANA
+                                                                  : MEJIRO_OUTPUT_ROMA;
+
+    /* keys compiled for the other backend must not be replayed */
+#if CONFIG_NAGINATA_MEJIRO_CACHE_SIZE > 0
+    memset(mejiro_cache, 0, sizeof(mejiro_cache));
+#endif
+    g_mejiro_last_key_count = 0;
+    g_mejiro_last_units = 0;
+
+    LOG_DBG("mejiro output: %s", mejiro_output_mode == MEJIRO_OUTPUT_JIS_KANA ? "JIS kana" : "romaji");
+}
+
+static const struct {
+    uint8_t flag;
+    uint32_t keycode;
+} mejiro_key_mod_keys[] = {
+    {MEJIRO_KEY_CTRL, MJ_KC_LCTRL},
+    {MEJIRO_KEY_ALT, MJ_KC_LALT},
+    {MEJIRO_KEY_SHIFT, MJ_KC_LSFT},
+};
+
+/* Move the held modifiers to `want`: releases first (reverse order), then presses. */
+static void mejiro_set_mods(uint8_t *held, uint8_t want) {
+    for (size_t i = ARRAY_SIZE(mejiro_key_mod_keys); i-- > 0;) {
+        if ((*held & ~want) & mejiro_key_mod_keys[i].flag) {
+            release_key(mejiro_key_mod_keys[i].keycode);
         }
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(mejiro_key_mod_keys); i++) {
+        if ((want & ~*held) & mejiro_key_mod_keys[i].flag) {
+            press_key(mejiro_key_mod_keys[i].keycode);
+        }
+    }
+    *held = want;
+}
 
-        switch (*p) {
-        case '?':
-            mod_tap(MJ_KC_LSFT, SLASH);
-            if (MEJIRO_ROMA_KEY_DELAY_MS > 0) {
-                k_msleep(MEJIRO_ROMA_KEY_DELAY_MS);
-            }
-            break;
-        case '!':
-            mod_tap(MJ_KC_LSFT, N1);
-            if (MEJIRO_ROMA_KEY_DELAY_MS > 0) {
-                k_msleep(MEJIRO_ROMA_KEY_DELAY_MS);
-            }
-            break;
-        case '-':
-            tap_key(MINUS);
-            if (MEJIRO_ROMA_KEY_DELAY_MS > 0) {
-                k_msleep(MEJIRO_ROMA_KEY_DELAY_MS);
-            }
-            break;
-        case '/':
-            tap_key(SLASH);
-            if (MEJIRO_ROMA_KEY_DELAY_MS > 0) {
-                k_msleep(MEJIRO_ROMA_KEY_DELAY_MS);
+/* Navigation/edit keys on the priority lane, each with its modifiers around it. */
+static void send_mejiro_priority_keys(const mejiro_key_t *keys, size_t n, uint8_t times) {
+    for (uint8_t r = 0; r < times; r++) {
+        for (size_t i = 0; i < n; i++) {
+            for (size_t m = 0; m < ARRAY_SIZE(mejiro_key_mod_keys); m++) {
+                if (keys[i].flags & mejiro_key_mod_keys[m].flag) {
+                    naginata_emit_priority(mejiro_key_mod_keys[m].keycode, true);
+                }
             }
-            break;
-        case ':':
-            mod_tap(MJ_KC_LSFT, SEMI);
-            if (MEJIRO_ROMA_KEY_DELAY_MS > 0) {
-                k_msleep(MEJIRO_ROMA_KEY_DELAY_MS);
+            naginata_emit_priority(MJ_KC(keys[i].usage), true);
+            naginata_emit_priority(MJ_KC(keys[i].usage), false);
+            for (size_t m = ARRAY_SIZE(mejiro_key_mod_keys); m-- > 0;) {
+                if (keys[i].flags & mejiro_key_mod_keys[m].flag) {
+                    naginata_emit_priority(mejiro_key_mod_keys[m].keycode, false);
+                }
             }
-            break;
-        default:
-            break;
         }
     }
 }
 
-static void send_mejiro_output(const char *mejiro_id) {
-    if (!mejiro_id || mejiro_id[0] == '\0') {
-        return;
+/* Send compiled keys `times` times. A modifier is pressed before the first
+ * key of a run that needs it and released before the next key that does not
+ * (or at the end), not around every key. */
+static void send_mejiro_keys(const mejiro_key_t *keys, size_t n, uint8_t times) {
+    uint8_t held = 0;
+
+    for (uint8_t r = 0; r < times; r++) {
+        for (size_t i = 0; i < n; i++) {
+            mejiro_set_mods(&held, keys[i].flags & MEJIRO_KEY_MODS);
+            naginata_emit_tap_kana(MJ_KC(keys[i].usage),
+                                   (enum naginata_pace)(keys[i].flags & MEJIRO_KEY_PACE_MASK),
+                                   MEJIRO_KEY_KANA_COUNT(keys[i].flags));
+        }
     }
+    mejiro_set_mods(&held, 0);
+}
+
+static void mejiro_set_last_keys(uint16_t n, uint16_t units) {
+    memcpy(g_mejiro_last_keys, mejiro_burst, n * sizeof(mejiro_burst[0]));
+    g_mejiro_last_key_count = n;
+    g_mejiro_last_units = units;
+}
 
-    LOG_DBG("mejiro stroke: %s", mejiro_id);
+#if MEJIRO_ROMA_SINGLE_N
+/*
+ * Strokes finalized faster than they are sent are planned together: a stroke
+ * ending in ん ("nn") is held while more strokes are queued, and when the next
+ * output starts with a plain consonant ん goes out as a single n, the same as
+ * inside one stroke. Pacing is unchanged (a stroke boundary is a kana
+ * boundary); each stroke keeps its own history entry.
+ */
+static mejiro_key_t mejiro_staged[ARRAY_SIZE(mejiro_burst)];
+static uint16_t mejiro_staged_count = 0;
+static uint16_t mejiro_staged_units = 0;
+
+/* A key that starts a kana with a consonant other than y/n (not sokuon, not shifted). */
+static bool mejiro_key_single_n_follows(const mejiro_key_t *key) {
+    const uint8_t u = key->usage;
+    return u >= HID_USAGE_KEY_KEYBOARD_A && u <= HID_USAGE_KEY_KEYBOARD_Z &&
+           u != HID_USAGE_KEY_KEYBOARD_A && u != HID_USAGE_KEY_KEYBOARD_E &&
+           u != HID_USAGE_KEY_KEYBOARD_I && u != HID_USAGE_KEY_KEYBOARD_O &&
+           u != HID_USAGE_KEY_KEYBOARD_U && u != HID_USAGE_KEY_KEYBOARD_Y &&
+           u != HID_USAGE_KEY_KEYBOARD_N && (key->flags & ~MEJIRO_KEY_END_N) == NAGINATA_PACE_INTRA_KANA;
+}
 
-    if (handle_mejiro_command(mejiro_id)) {
+/* Send the held stroke, planned against the keys that will follow it (NULL: none). */
+static void mejiro_flush_staged(const mejiro_key_t *next, uint16_t next_count) {
+    if (mejiro_staged_count == 0) {
         return;
     }
+    uint16_t n = mejiro_staged_count;
+    if (next_count > 0 && mejiro_key_single_n_follows(&next[0])) {
+        /* ん now ends at the first n */
+        n--;
+        mejiro_staged[n - 1].flags |= mejiro_staged[n].flags & MEJIRO_KEY_KANA_MASK;
+    }
+    mejiro_staged_count = 0;
 
-    mejiro_result_t_zmk result = mejiro_transform_zmk(mejiro_id);
-    if (!result.success) {
-        /* Undefined stroke: emit nothing. Keep state cleanup at caller side only. */
-        return;
+    naginata_emit_entry_begin();
+    send_mejiro_keys(mejiro_staged, n, 1);
+    naginata_emit_entry_end();
+    mejiro_stats_count_output(n, mejiro_staged_units);
+}
+
+/* Hold the keys instead of sending them when they end in "nn" and another stroke is queued. */
+static bool mejiro_stage(const mejiro_key_t *keys, uint16_t n, uint16_t units) {
+    if (n == 0 || !(keys[n - 1].flags & MEJIRO_KEY_END_N) ||
+        k_msgq_num_used_get(&mejiro_stroke_msgq) == 0) {
+        return false;
     }
+    memcpy(mejiro_staged, keys, n * sizeof(keys[0]));
+    mejiro_staged_count = n;
+    mejiro_staged_units = units;
+    return true;
+}
+#else
+/* the default spellings never shorten across strokes */
+static void mejiro_flush_staged(const mejiro_key_t *next, uint16_t next_count) {}
+
+static bool mejiro_stage(const mejiro_key_t *keys, uint16_t n, uint16_t units) { return false; }
+#endif
+
+/* Convert a stroke once and send it `times` times; history gets one entry for all of them. */
+static void send_mejiro_output(mejiro_stroke_t stroke, uint8_t times) {
+#if CONFIG_ZMK_LOG_LEVEL >= LOG_LEVEL_DBG
+    char id[MEJIRO_STROKE_STR_MAX];
+    mejiro_stroke_to_string(stroke, id, sizeof(id));
+    LOG_DBG("mejiro stroke: %s x%u", id, times);
+#endif
 
-    if (result.output[0] == '\0') {
+    /* undefined strokes and carried-over っ emit nothing (units == 0) */
+    uint16_t units;
+    const uint16_t n = mejiro_compile_stroke(stroke, &units);
+    if (units == 0) {
         return;
     }
 
-    send_mejiro_roma(result.output);
-
-    strncpy(g_mejiro_last_output, result.output, sizeof(g_mejiro_last_output) - 1);
-    g_mejiro_last_output[sizeof(g_mejiro_last_output) - 1] = '\0';
+    mejiro_flush_staged(mejiro_burst, n);
+    mejiro_set_last_keys(n, units);
+    mejiro_history_push((uint16_t)(units * times));
+    if (times == 1 && mejiro_stage(mejiro_burst, n, units)) {
+        return;
+    }
 
-    g_mejiro_last_units =
-        (uint16_t)(result.kana_length > 0 ? result.kana_length : strlen(result.output));
-    mejiro_history_push(g_mejiro_last_units);
+    naginata_emit_entry_begin();
+    send_mejiro_keys(mejiro_burst, n, times);
+    naginata_emit_entry_end();
+    mejiro_stats_count_output((uint16_t)(n * times), (uint16_t)(units * times));
+    LOG_DBG("mejiro stroke: %u keys for %u kana", n, units);
 }
 
@@ -0,0 +1,101 @@
+#include <zmk_naginata/mejiro_kana_code.h>
+
+#define K(row, col) MK_KANA(MK_ROW_##row, col)
+
+/* U+3041 (ぁ) .. U+3096 (ゖ) -> code, 0 = none */
+static const mejiro_kana_t hiragana_codes[] = {
+    K(SMALL, 0), K(A, 0), K(SMALL, 1), K(A, 1), K(SMALL, 2), K(A, 2), K(SMALL, 3), K(A, 3),
+    K(SMALL, 4), K(A, 4),                                      /* ぁあぃいぅうぇえぉお */
+    K(K, 0), K(G, 0), K(K, 1), K(G, 1), K(K, 2), K(G, 2), K(K, 3), K(G, 3), K(K, 4), K(G, 4),
+    K(S, 0), K(Z, 0), K(S, 1), K(Z, 1), K(S, 2), K(Z, 2), K(S, 3), K(Z, 3), K(S, 4), K(Z, 4),
+    K(T, 0), K(D, 0), K(T, 1), K(D, 1), K(SMALL, 5), K(T, 2), K(D, 2), K(T, 3), K(D, 3),
+    K(T, 4), K(D, 4),                                          /* た..ど, っ */
+    K(N, 0), K(N, 1), K(N, 2), K(N, 3), K(N, 4),
+    K(H, 0), K(B, 0), K(P, 0), K(H, 1), K(B, 1), K(P, 1), K(H, 2), K(B, 2), K(P, 2),
+    K(H, 3), K(B, 3), K(P, 3), K(H, 4), K(B, 4), K(P, 4),
+    K(M, 0), K(M, 1), K(M, 2), K(M, 3), K(M, 4),
+    K(Y, 1), K(Y, 0), K(Y, 3), K(Y, 2), K(Y, 5), K(Y, 4),     /* ゃやゅゆょよ */
+    K(R, 0), K(R, 1), K(R, 2), K(R, 3), K(R, 4),
+    K(SMALL, 6), K(W, 0), K(W, 1), K(W, 3), K(W, 4), K(W, 5), /* ゎわゐゑをん */
+    K(W, 2),                                                   /* ゔ */
+    0, 0,                                                      /* ゕゖ */
+};
+
+#define HIRAGANA_FIRST 0x3041
+
+mejiro_kana_t mejiro_kana_from_utf8(const char **p) {
+    const unsigned char *s = (const unsigned char *)*p;
+
+    if (s[0] < 0x80) {
+        *p += 1;
+        return s[0];
+    }
+
+    /* only 3-byte sequences carry kana; skip anything else whole */
+    if ((s[0] & 0xF0) != 0xE0) {
+        size_t n = 1;
+        while ((s[n] & 0xC0) == 0x80) {
+            n++;
+        }
+        *p += n;
+        return 0;
+    }
+    if ((s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80) {
+        *p += 1;
+        return 0;
+    }
+    *p += 3;
+
+    const uint16_t cp = (uint16_t)(((s[0] & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F));
+    if (cp >= HIRAGANA_FIRST && cp < HIRAGANA_FIRST + sizeof(hiragana_codes)) {
+        return hiragana_codes[cp - HIRAGANA_FIRST];
+    }
+    switch (cp) {
+    case 0x30FC:
+        return MK_CHOON;
+    case 0x3001:
+        return MK_TOUTEN;
+    case 0x3002:
+        return MK_KUTEN;
+    default:
+        return 0;
+    }
+}
+
+size_t mejiro_kana_encode(const char *utf8, char *out, size_t out_sz) {
+    size_t n = 0;
+
+    if (out_sz == 0) {
+        return 0;
+    }
+    while (*utf8 != '\0' && n + 1 < out_sz) {
+        const mejiro_kana_t c = mejiro_kana_from_utf8(&utf8);
+        if (c != 0) {
+            out[n++] = (char)c;
+        }
+    }
+    out[n] = '\0';
+    return n;
+}
+
+uint16_t mejiro_kana_codepoint(mejiro_kana_t c) {
+    if (!MK_IS_KANA(c)) {
+        return c;
+    }
+    switch (c) {
+    case MK_CHOON:
+        return 0x30FC;
+    case MK_TOUTEN:
+        return 0x3001;
+    case MK_KUTEN:
+        return 0x3002;
+    default:
+        break;
+    }
+    for (uint16_t i = 0; i < sizeof(hiragana_codes); i++) {
+        if (hiragana_codes[i] == c) {
+            return (uint16_t)(HIRAGANA_FIRST + i);
+        }
+    }
+    return 0;
+}
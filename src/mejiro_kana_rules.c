@@ -0,0 +1,360 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <zmk_naginata/mejiro_kana.h>
+
+/*
+ * Mejiro kana rules for one half stroke.
+ *
+ * Only the host generator (scripts/mejiro_kana_gen.c) links this file; the
+ * firmware looks the result up in the generated mejiro_kana_halves table.
+ */
+
+#ifndef ARRAY_SIZE
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+#define P_N MJ_PN
+#define P_T MJ_PT
+#define P_K MJ_PK
+
+// 子音コード→kana_table の行（S=1 T=2 K=4 N=8）
+static const uint8_t conso_row[16] = {
+    0,  /* ""   */  2,  /* S    s */  3,  /* T    t */  7,  /* ST   r */
+    1,  /* K    k */  8,  /* SK   w */  5,  /* TK   h */  13, /* STK  p */
+    4,  /* N    n */  10, /* SN   z */  11, /* TN   d */  15, /* STN  l */
+    9,  /* KN   g */  6,  /* SKN  m */  12, /* TKN  b */  14, /* STKN f */
+};
+
+// kana_table の段
+enum {
+    DAN_A, DAN_I, DAN_U, DAN_E, DAN_O, DAN_YA, DAN_YU, DAN_YO,
+};
+
+// 母音コード→段と二重母音の後半（Y=1 I=2 A=4 U=8）
+typedef struct {
+    uint8_t index;
+    const char *suffix;
+} vowel_map_t;
+
+static const vowel_map_t vowel_table[16] = {
+    [0] = {DAN_A, ""},
+    [MJ_A] = {DAN_A, ""},
+    [MJ_I] = {DAN_I, ""},
+    [MJ_U] = {DAN_U, ""},
+    [MJ_I | MJ_A] = {DAN_E, ""},
+    [MJ_A | MJ_U] = {DAN_O, ""},
+    [MJ_Y | MJ_A] = {DAN_YA, ""},
+    [MJ_Y | MJ_U] = {DAN_YU, ""},
+    [MJ_Y | MJ_A | MJ_U] = {DAN_YO, ""},
+    // 二重母音
+    [MJ_Y] = {DAN_A, "い"},
+    [MJ_Y | MJ_I] = {DAN_YO, "う"},
+    [MJ_Y | MJ_I | MJ_A] = {DAN_E, "い"},
+    [MJ_Y | MJ_I | MJ_U] = {DAN_YU, "う"},
+    [MJ_Y | MJ_I | MJ_A | MJ_U] = {DAN_U, "う"},
+    [MJ_I | MJ_U] = {DAN_U, "い"},
+    [MJ_I | MJ_A | MJ_U] = {DAN_O, "う"},
+};
+
+// 行段→ひらがなマッピング
+static const char *kana_table[][8] = {
+    {"あ", "い", "う", "え", "お", "や", "ゆ", "よ"},     // ""
+    {"か", "き", "く", "け", "こ", "きゃ", "きゅ", "きょ"}, // k
+    {"さ", "し", "す", "せ", "そ", "しゃ", "しゅ", "しょ"}, // s
+    {"た", "ち", "つ", "て", "と", "ちゃ", "ちゅ", "ちょ"}, // t
+    {"な", "に", "ぬ", "ね", "の", "にゃ", "にゅ", "にょ"}, // n
+    {"は", "ひ", "ふ", "へ", "ほ", "ひゃ", "ひゅ", "ひょ"}, // h
+    {"ま", "み", "む", "め", "も", "みゃ", "みゅ", "みょ"}, // m
+    {"ら", "り", "る", "れ", "ろ", "りゃ", "りゅ", "りょ"}, // r
+    {"わ", "うぃ", "ゔ", "うぇ", "うぉ", "わ", "ゔゅ", "を"}, // w
+    {"が", "ぎ", "ぐ", "げ", "ご", "ぎゃ", "ぎゅ", "ぎょ"}, // g
+    {"ざ", "じ", "ず", "ぜ", "ぞ", "じゃ", "じゅ", "じょ"}, // z
+    {"だ", "ぢ", "づ", "で", "ど", "ぢゃ", "ぢゅ", "ぢょ"}, // d
+    {"ば", "び", "ぶ", "べ", "ぼ", "びゃ", "びゅ", "びょ"}, // b
+    {"ぱ", "ぴ", "ぷ", "ぺ", "ぽ", "ぴゃ", "ぴゅ", "ぴょ"}, // p
+    {"ふぁ", "ふぃ", "ふゅ", "ふぇ", "ふぉ", "ふゃ", "ふゅ", "ふょ"}, // f
+    {"ぁ", "ぃ", "ぅ", "ぇ", "ぉ", "ゃ", "ゅ", "ょ"}      // l
+};
+
+// 複雑二重母音マッピング（親指を使う外来音）
+typedef struct {
+    const char *stroke;  // 母音+助詞ストローク
+    uint8_t first_vowel; // kana_table の段
+    const char *suffix;
+} minor_diphthong_map_t;
+
+static const minor_diphthong_map_t minor_diphthong_table[] = {
+    {"IAUtk", DAN_A, "う"},   // ~あう
+    {"YItk", DAN_I, "い"},    // ~いい
+    {"YIUtk", DAN_O, "い"},   // ~おい
+    {"YIAtk", DAN_A, "え"},   // ~あえ
+    {"YIAUtk", DAN_O, "お"},  // ~おお
+};
+
+// 英語音マッピング（親指を使う外来音）
+typedef struct {
+    const char *stroke;  // 母音+助詞ストローク
+    uint8_t first_vowel; // kana_table の段
+    const char *suffix;
+} english_diphthong_map_t;
+
+static const english_diphthong_map_t english_diphthong_table[] = {
+
+// |V/C | t | k |  nt   | nk | ntk|
+// |----|---|---|-------|----|----|
+// |IAU |~as|~al|~ation |~ind|~arn|
+// |YI  |~is|~il|~ition |~ing|~een|
+// |YIU |~us|~ul|~usion |~and|~oom|
+// |YIA |~es|~el|~ention|~end|~ain|
+// |YIAU|~os|~ol|~otion |~ong|~orn|
+
+    // t
+    {"IAUt", DAN_A, "す"},
+    {"YIt", DAN_I, "す"},
+    {"YIUt", DAN_U, "す"},
+    {"YIAt", DAN_E, "す"},
+    {"YIAUt", DAN_O, "す"},
+
+    // k
+    {"IAUk", DAN_A, "る"},
+    {"YIk", DAN_I, "る"},
+    {"YIUk", DAN_U, "る"},
+    {"YIAk", DAN_E, "る"},
+    {"YIAUk", DAN_O, "る"},
+
+    // nt
+    {"IAUnt", DAN_E, "ーしょん"},
+    {"YInt", DAN_I, "しょん"},
+    {"YIUnt", DAN_U, "しょん"},
+    {"YIAnt", DAN_E, "んしょん"},
+    {"YIAUnt", DAN_O, "ーしょん"},
+
+    // nk
+    {"IAUnk", DAN_A, "いんど"},
+    {"YInk", DAN_I, "んぐ"},
+    {"YIUnk", DAN_A, "んど"},
+    {"YIAnk", DAN_E, "んど"},
+    {"YIAUnk", DAN_O, "んぐ"},
+
+    // ntk
+    {"IAUntk", DAN_A, "ーん"},
+    {"YIntk", DAN_I, "ーん"},
+    {"YIUntk", DAN_U, "ーん"},
+    {"YIAntk", DAN_E, "ーん"},
+    {"YIAUntk", DAN_O, "ーん"},
+};
+
+// 例外的なかなのマッピング
+typedef struct {
+    const char *stroke;  // 子音+母音ストローク
+    const char *kana;
+} exception_kana_t;
+
+static const exception_kana_t exception_kana_table[] = {
+    // F
+    {"STKNU", "ゔ"},
+    {"STKNYA", "ゔぁ"},
+    {"STKNYI", "ゔぃ"},
+    {"STKNYU", "ふゅ"},
+    {"STKNYIU", "ゔぇ"},
+    {"STKNYAU", "ゔぉ"},
+    {"STKNYIAU", "じぇい"},
+    {"STKNIAU", "じぇ"},
+    {"STKNIU", "ゔゅ"},
+
+    // W
+    {"SKU", "ゎ"},
+    {"SKYA", "うぁ"},
+    {"SKYI", "ゐ"},
+    {"SKYU", "ゆい"},
+    {"SKYIU", "ゑ"},
+    {"SKYAU", "を"},
+    {"SKYIAU", "ちぇい"},
+    {"SKIAU", "ちぇ"},
+    {"SKIU", "いう"},
+
+    // D
+    {"TNYA", "てぃ"},
+    {"TNYI", "とぅ"},
+    {"TNYU", "でゅ"},
+    {"TNYIU", "どぅ"},
+    {"TNYAU", "でぃ"},
+    {"TNYIAU", "いぇ"},
+    {"TNIU", "てゅ"},
+
+    // X
+    {"STNYA", "すた"},
+    {"STNYI", "すち"},
+    {"STNYU", "すてぃ"},
+    {"STNYIU", "すて"},
+    {"STNYAU", "すと"},
+    {"STNYIAU", "しぇい"},
+    {"STNIAU", "しぇ"},
+    {"STNIU", "くす"},
+    {"STNY", "すたい"},
+    {"STNYIA", "すてい"},
+    {NULL, NULL}
+};
+
+static uint16_t minor_diphthong_codes[ARRAY_SIZE(minor_diphthong_table)];
+static uint16_t english_diphthong_codes[ARRAY_SIZE(english_diphthong_table)];
+static uint16_t exception_kana_codes[ARRAY_SIZE(exception_kana_table)];
+
+#define C_STN (MJ_S | MJ_T | MJ_N)
+
+// 英語音をチェック（母音+助詞のハーフコード）
+static bool check_english_diphthong(uint16_t vowel_particle, uint8_t *first_vowel, const char **suffix) {
+    for (uint8_t i = 0; i < ARRAY_SIZE(english_diphthong_table); i++) {
+        if (vowel_particle == english_diphthong_codes[i]) {
+            *first_vowel = english_diphthong_table[i].first_vowel;
+            *suffix = english_diphthong_table[i].suffix;
+            return true;
+        }
+    }
+    return false;
+}
+
+// マイナー二重母音をチェック（母音+助詞のハーフコード）
+static bool check_minor_diphthong(uint16_t vowel_particle, uint8_t *first_vowel, const char **suffix) {
+    for (uint8_t i = 0; i < ARRAY_SIZE(minor_diphthong_table); i++) {
+        if (vowel_particle == minor_diphthong_codes[i]) {
+            *first_vowel = minor_diphthong_table[i].first_vowel;
+            *suffix = minor_diphthong_table[i].suffix;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 例外的なかなをチェック（子音+母音のハーフコード）
+static const char *check_exception_kana(uint16_t conso_vowel) {
+    for (uint8_t i = 0; exception_kana_table[i].stroke != NULL; i++) {
+        if (conso_vowel == exception_kana_codes[i]) {
+            return exception_kana_table[i].kana;
+        }
+    }
+    return NULL;
+}
+
+// tk 付きの例外かな（〜えい ではなく 〜え）
+static const char *exception_kana_tk(uint16_t conso_vowel, const char *kana) {
+    if (conso_vowel == MJ_HALF(MJ_S | MJ_K, MJ_I | MJ_A | MJ_U, 0)) {
+        return "ちぇ";
+    } else if (conso_vowel == MJ_HALF(MJ_S | MJ_T | MJ_K | MJ_N, MJ_I | MJ_A | MJ_U, 0)) {
+        return "じぇ";
+    } else if (conso_vowel == MJ_HALF(C_STN, MJ_I | MJ_A | MJ_U, 0)) {
+        return "しぇ";
+    } else if (conso_vowel == MJ_HALF(MJ_T | MJ_N, MJ_Y | MJ_I | MJ_A | MJ_U, 0)) {
+        return "いぇ";
+    }
+    return kana;
+}
+
+
+void mejiro_kana_rules_init(void) {
+    for (size_t i = 0; i < ARRAY_SIZE(minor_diphthong_table); i++) {
+        minor_diphthong_codes[i] = mejiro_half_from_string(minor_diphthong_table[i].stroke);
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(english_diphthong_table); i++) {
+        english_diphthong_codes[i] = mejiro_half_from_string(english_diphthong_table[i].stroke);
+    }
+    for (size_t i = 0; exception_kana_table[i].stroke != NULL; i++) {
+        exception_kana_codes[i] = mejiro_half_from_string(exception_kana_table[i].stroke);
+    }
+}
+
+// 子音・母音・助詞（ハーフコード）から、追加音を除いたかな文字列を生成する
+// 追加音を付けるかどうかは MEJIRO_KANA_EXTRA で返し、付ける側で判断する
+uint8_t mejiro_kana_rules_convert(uint16_t half, char *out) {
+    const uint8_t conso = MJ_HALF_CONSO(half);
+    const uint8_t vowel = MJ_HALF_VOWEL(half);
+    const uint8_t particle = MJ_HALF_PARTICLE(half);
+    const uint16_t vowel_particle = MJ_HALF(0, vowel, particle);
+    uint8_t first_vowel = DAN_A;
+    const char *suffix = NULL;
+    uint8_t flags = 0;
+    out[0] = '\0';
+
+    // 「っ」の持ち越し判定に使う英語音・マイナー二重母音は子音によらない
+    if (check_english_diphthong(vowel_particle, &first_vowel, &suffix)) {
+        flags |= MEJIRO_KANA_ENGLISH;
+    }
+    if (check_minor_diphthong(vowel_particle, &first_vowel, &suffix)) {
+        flags |= MEJIRO_KANA_MINOR;
+    }
+    if (particle == (P_T | P_K) && !(flags & (MEJIRO_KANA_ENGLISH | MEJIRO_KANA_MINOR))) {
+        flags |= MEJIRO_KANA_SOKUON;
+    }
+
+    if (conso == C_STN && vowel == 0) {
+        return flags | MEJIRO_KANA_EXTRA;
+    }
+
+    const uint16_t conso_vowel = half & MJ_HALF_KANA_MASK;
+    const char *exception_kana = check_exception_kana(conso_vowel);
+    bool prefer_exception = (particle == P_N ||
+                             particle == (P_T | P_K) ||
+                             particle == (P_N | P_T | P_K));
+    if (prefer_exception && exception_kana != NULL) {
+        strcpy(out, exception_kana);
+
+        if (particle == (P_T | P_K)) {
+            strcpy(out, exception_kana_tk(conso_vowel, out));
+        }
+        return flags | MEJIRO_KANA_EXTRA;
+    }
+
+    if (check_english_diphthong(vowel_particle, &first_vowel, &suffix)) {
+        const char *base_kana = kana_table[conso_row[conso]][first_vowel];
+
+        if (strcmp(base_kana, "ち") == 0) {
+            base_kana = "てぃ";
+        } else if (strcmp(base_kana, "ぢ") == 0) {
+            base_kana = "でぃ";
+        } else if (strcmp(base_kana, "づ") == 0) {
+            base_kana = "どぅ";
+        } else if (strcmp(base_kana, "ぁ") == 0) {
+            base_kana = "すた";
+        } else if (strcmp(base_kana, "ぃ") == 0) {
+            base_kana = "すち";
+        } else if (strcmp(base_kana, "ぅ") == 0) {
+            base_kana = "すてぃ";
+        } else if (strcmp(base_kana, "ぇ") == 0) {
+            base_kana = "すて";
+        } else if (strcmp(base_kana, "ぉ") == 0) {
+            base_kana = "すと";
+        }
+
+        strcpy(out, base_kana);
+        strcat(out, suffix);
+
+        if (strcmp(out, "るしょん") == 0) {
+            strcpy(out, "りゅーしょん");
+        } else if (strcmp(out, "ふしょん") == 0) {
+            strcpy(out, "ふゅーじょん");
+        }
+        return flags;
+    }
+
+    if (check_minor_diphthong(vowel_particle, &first_vowel, &suffix)) {
+        const char *base_kana = kana_table[conso_row[conso]][first_vowel];
+        strcpy(out, base_kana);
+        strcat(out, suffix);
+        return flags;
+    }
+
+    if (exception_kana != NULL) {
+        strcpy(out, exception_kana);
+
+        if (particle == (P_T | P_K)) {
+            strcpy(out, exception_kana_tk(conso_vowel, out));
+        }
+    } else {
+        const char *base_kana = kana_table[conso_row[conso]][vowel_table[vowel].index];
+        strcpy(out, base_kana);
+        strcat(out, vowel_table[vowel].suffix);
+    }
+    return flags | MEJIRO_KANA_EXTRA;
+}
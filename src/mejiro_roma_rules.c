@@ -0,0 +1,89 @@
+#include <stddef.h>
+
+#include <zmk_naginata/mejiro_kana.h>
+
+/*
+ * Kana -> romaji rules.
+ *
+ * Only the host generator (scripts/mejiro_kana_gen.c) links this file; the
+ * firmware walks the trie built from it (mejiro_roma_nodes/edges).
+ */
+
+// ひらがな→ヘボン式ローマ字変換テーブル（最長一致、同じ長さなら先のエントリ）
+const mejiro_roma_rule_t mejiro_roma_rules[] = {
+    // 基本五十音
+    {"あ", "a"}, {"い", "i"}, {"う", "u"}, {"え", "e"}, {"お", "o"},
+    {"か", "ka"}, {"き", "ki"}, {"く", "ku"}, {"け", "ke"}, {"こ", "ko"},
+    {"さ", "sa"}, {"し", "shi"}, {"す", "su"}, {"せ", "se"}, {"そ", "so"},
+    {"た", "ta"}, {"ち", "chi"}, {"つ", "tsu"}, {"て", "te"}, {"と", "to"},
+    {"な", "na"}, {"に", "ni"}, {"ぬ", "nu"}, {"ね", "ne"}, {"の", "no"},
+    {"は", "ha"}, {"ひ", "hi"}, {"ふ", "fu"}, {"へ", "he"}, {"ほ", "ho"},
+    {"ま", "ma"}, {"み", "mi"}, {"む", "mu"}, {"め", "me"}, {"も", "mo"},
+    {"や", "ya"}, {"ゆ", "yu"}, {"よ", "yo"},
+    {"ら", "ra"}, {"り", "ri"}, {"る", "ru"}, {"れ", "re"}, {"ろ", "ro"},
+    {"わ", "wa"}, {"ゐ", "wi"}, {"ゑ", "we"}, {"を", "wo"}, {"ん", "nn"},
+
+    // 濁音
+    {"が", "ga"}, {"ぎ", "gi"}, {"ぐ", "gu"}, {"げ", "ge"}, {"ご", "go"},
+    {"ざ", "za"}, {"じ", "ji"}, {"ず", "zu"}, {"ぜ", "ze"}, {"ぞ", "zo"},
+    {"だ", "da"}, {"ぢ", "di"}, {"づ", "du"}, {"で", "de"}, {"ど", "do"},
+    {"ば", "ba"}, {"び", "bi"}, {"ぶ", "bu"}, {"べ", "be"}, {"ぼ", "bo"},
+
+    // 半濁音
+    {"ぱ", "pa"}, {"ぴ", "pi"}, {"ぷ", "pu"}, {"ぺ", "pe"}, {"ぽ", "po"},
+
+    // 拗音(きゃ系)
+    {"きゃ", "kya"}, {"きゅ", "kyu"}, {"きょ", "kyo"},
+    {"しゃ", "sha"}, {"しゅ", "shu"}, {"しょ", "sho"},
+    {"ちゃ", "cha"}, {"ちゅ", "chu"}, {"ちょ", "cho"},
+    {"にゃ", "nya"}, {"にゅ", "nyu"}, {"にょ", "nyo"},
+    {"ひゃ", "hya"}, {"ひゅ", "hyu"}, {"ひょ", "hyo"},
+    {"みゃ", "mya"}, {"みゅ", "myu"}, {"みょ", "myo"},
+    {"りゃ", "rya"}, {"りゅ", "ryu"}, {"りょ", "ryo"},
+    {"ぎゃ", "gya"}, {"ぎゅ", "gyu"}, {"ぎょ", "gyo"},
+    {"じゃ", "ja"}, {"じゅ", "ju"}, {"じょ", "jo"},
+    {"ぢゃ", "dya"}, {"ぢゅ", "dyu"}, {"ぢょ", "dyo"},
+    {"びゃ", "bya"}, {"びゅ", "byu"}, {"びょ", "byo"},
+    {"ぴゃ", "pya"}, {"ぴゅ", "pyu"}, {"ぴょ", "pyo"},
+
+    // 特殊音
+    {"ゔ", "vu"},    {"ゔぁ", "va"},  {"ゔぃ", "vi"}, {"ゔぇ", "ve"}, {"ゔぉ", "vo"},
+    {"ゔゅ", "vyu"},
+    {"うぁ", "wha"}, {"うぃ", "wi"},  {"うぇ", "we"}, {"うぉ", "who"},
+    {"ふぁ", "fa"},  {"ふぃ", "fi"},  {"ふぇ", "fe"}, {"ふぉ", "fo"},
+    {"ふゃ", "fya"}, {"ふゅ", "fyu"}, {"ふょ", "fyo"},
+    {"くぁ", "kwa"},  {"くぃ", "kwi"},  {"くぇ", "kwe"}, {"くぉ", "kwo"},
+    {"いぇ", "ye"}, {"しぇ", "she"}, {"じぇ", "je"}, {"ちぇ", "che"},
+    {"てぃ", "thi"}, {"でぃ", "dhi"}, {"でゅ", "dhu"},
+    {"とぅ", "twu"}, {"どぅ", "dwu"},
+
+    // 小書き文字
+    {"ぁ", "xa"}, {"ぃ", "xi"}, {"ぅ", "xu"}, {"ぇ", "xe"}, {"ぉ", "xo"},
+    {"ゃ", "xya"}, {"ゅ", "xyu"}, {"ょ", "xyo"},
+    {"っ", "xtu"}, {"ゎ", "xwa"},
+
+    // 長音符
+    {"ー", "-"},
+
+    // 句読点
+    {"、", ","}, {"。", "."}, {"!", "!"}, {"!", "!"}, {"?", "?"}, {"?", "?"},
+
+    {NULL, NULL}
+};
+
+#define MS MEJIRO_ROMA_MSIME
+#define GO MEJIRO_ROMA_GOOGLE
+#define MAC MEJIRO_ROMA_MACOS
+
+// IME ごとの綴り（上の表より優先）。その IME が受け付ける、より短いか正しい綴りのみ
+const mejiro_roma_ime_rule_t mejiro_roma_ime_rules[] = {
+    // 訓令式のほうが短いもの
+    {MS | GO | MAC, "し", "si"}, {MS | GO | MAC, "ち", "ti"}, {MS | GO | MAC, "つ", "tu"},
+    {MS | GO | MAC, "くぁ", "qa"}, {MS | GO | MAC, "くぃ", "qi"},
+    {MS | GO | MAC, "くぇ", "qe"}, {MS | GO | MAC, "くぉ", "qo"},
+
+    // wi/we は「うぃ」「うぇ」になるため、ゐ・ゑ は wyi/wye
+    {MS | GO, "ゐ", "wyi"}, {MS | GO, "ゑ", "wye"},
+
+    {0, NULL, NULL}
+};
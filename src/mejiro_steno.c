@@ -0,0 +1,131 @@
+#include <stdbool.h>
+
+#include <zmk_naginata/mejiro_steno.h>
+
+/* Gemini PR keys in Plover's chart order: 6 bytes x 7 bits, first byte flagged by 0x80 */
+enum {
+    GM_FN, GM_N1, GM_N2, GM_N3, GM_N4, GM_N5, GM_N6,
+    GM_S1, GM_S2, GM_TL, GM_KL, GM_PL, GM_WL, GM_HL,
+    GM_RL, GM_A, GM_O, GM_STAR1, GM_STAR2, GM_RES1, GM_RES2,
+    GM_PWR, GM_STAR3, GM_STAR4, GM_E, GM_U, GM_FR, GM_RR,
+    GM_PR, GM_BR, GM_LR, GM_GR, GM_TR, GM_SR, GM_DR,
+    GM_N7, GM_N8, GM_N9, GM_NA, GM_NB, GM_NC, GM_ZR,
+};
+
+/* TX Bolt keys: 4 groups of 6, group in the top two bits, first key in bit 0 */
+enum {
+    TX_SL, TX_TL, TX_KL, TX_PL, TX_WL, TX_HL,
+    TX_RL, TX_A, TX_O, TX_STAR, TX_E, TX_U,
+    TX_FR, TX_RR, TX_PR, TX_BR, TX_LR, TX_GR,
+    TX_TR, TX_SR, TX_DR, TX_ZR, TX_NUM,
+    TX_EXTRA, /* sixth bit of group 3, not in Plover's chart */
+};
+
+#define MEJIRO_STENO_KEYS 24
+
+/*
+ * Steno key of each stroke bit (mejiro_stroke.h order: left STKNYIAUntk, #,
+ * right STKNYIAUntk, *). Consonants sit on the upper row and vowels on the
+ * lower row of each hand, outer key first; particles take the vowel/star keys.
+ */
+static const uint8_t gemini_keys[MEJIRO_STENO_KEYS] = {
+    GM_S1, GM_TL, GM_PL, GM_HL, GM_S2, GM_KL, GM_WL, GM_RL, GM_A, GM_O, GM_STAR1,
+    GM_N1,
+    GM_TR, GM_LR, GM_PR, GM_FR, GM_SR, GM_GR, GM_BR, GM_RR, GM_E, GM_U, GM_STAR4,
+    GM_STAR2,
+};
+
+static const uint8_t txbolt_keys[MEJIRO_STENO_KEYS] = {
+    TX_SL, TX_TL, TX_PL, TX_HL, TX_NUM, TX_KL, TX_WL, TX_RL, TX_A, TX_O, TX_STAR,
+    TX_EXTRA,
+    TX_TR, TX_LR, TX_PR, TX_FR, TX_SR, TX_GR, TX_BR, TX_RR, TX_E, TX_U, TX_DR,
+    TX_ZR,
+};
+
+size_t mejiro_steno_encode(enum mejiro_steno_protocol protocol, mejiro_stroke_t stroke,
+                           uint8_t out[MEJIRO_STENO_PACKET_MAX]) {
+    if (protocol == MEJIRO_STENO_GEMINIPR) {
+        for (size_t i = 0; i < 6; i++) {
+            out[i] = 0;
+        }
+        out[0] = 0x80;
+        for (int bit = 0; bit < MEJIRO_STENO_KEYS; bit++) {
+            if (stroke & (1u << bit)) {
+                const uint8_t key = gemini_keys[bit];
+                out[key / 7] |= (uint8_t)(0x40 >> (key % 7));
+            }
+        }
+        return 6;
+    }
+
+    uint8_t groups[4] = {0};
+    for (int bit = 0; bit < MEJIRO_STENO_KEYS; bit++) {
+        if (stroke & (1u << bit)) {
+            const uint8_t key = txbolt_keys[bit];
+            groups[key / 6] |= (uint8_t)(1u << (key % 6));
+        }
+    }
+    /* only groups with keys, in order; a 0 byte ends the stroke */
+    size_t n = 0;
+    for (uint8_t g = 0; g < 4; g++) {
+        if (groups[g] != 0) {
+            out[n++] = (uint8_t)((g << 6) | groups[g]);
+        }
+    }
+    out[n++] = 0;
+    return n;
+}
+
+mejiro_stroke_t mejiro_steno_decode(enum mejiro_steno_protocol protocol, const uint8_t *packet,
+                                    size_t len) {
+    mejiro_stroke_t stroke = 0;
+
+    for (int bit = 0; bit < MEJIRO_STENO_KEYS; bit++) {
+        bool down = false;
+        if (protocol == MEJIRO_STENO_GEMINIPR) {
+            const uint8_t key = gemini_keys[bit];
+            down = key / 7 < len && (packet[key / 7] & (0x40 >> (key % 7)));
+        } else {
+            const uint8_t key = txbolt_keys[bit];
+            for (size_t i = 0; i < len; i++) {
+                if ((packet[i] >> 6) == key / 6 && (packet[i] & (1u << (key % 6)))) {
+                    down = true;
+                }
+            }
+        }
+        if (down) {
+            stroke |= 1u << bit;
+        }
+    }
+    return stroke;
+}
+
+#ifdef __ZEPHYR__
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+
+#if !DT_HAS_CHOSEN(zmk_naginata_steno)
+#error "CONFIG_NAGINATA_MEJIRO_STENO needs a zmk,naginata-steno chosen UART (e.g. a CDC-ACM port)"
+#endif
+
+static const struct device *const steno_uart = DEVICE_DT_GET(DT_CHOSEN(zmk_naginata_steno));
+
+#if IS_ENABLED(CONFIG_NAGINATA_MEJIRO_STENO_TXBOLT)
+#define STENO_PROTOCOL MEJIRO_STENO_TXBOLT
+#else
+#define STENO_PROTOCOL MEJIRO_STENO_GEMINIPR
+#endif
+
+int mejiro_steno_send(mejiro_stroke_t stroke) {
+    uint8_t packet[MEJIRO_STENO_PACKET_MAX];
+
+    if (!device_is_ready(steno_uart)) {
+        return -ENODEV;
+    }
+    const size_t n = mejiro_steno_encode(STENO_PROTOCOL, stroke, packet);
+    for (size_t i = 0; i < n; i++) {
+        uart_poll_out(steno_uart, packet[i]);
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,75 @@
+#include <zmk_naginata/mejiro_stroke.h>
+
+/* letters of one half, in bit order */
+static const char mejiro_half_letters[MJ_HALF_BITS] = {'S', 'T', 'K', 'N', 'Y', 'I',
+                                                       'A', 'U', 'n', 't', 'k'};
+
+static int mejiro_half_bit(char c) {
+    for (int i = 0; i < MJ_HALF_BITS; i++) {
+        if (mejiro_half_letters[i] == c) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static size_t mejiro_half_to_string(uint16_t half, char *out, size_t n, size_t out_sz) {
+    for (int i = 0; i < MJ_HALF_BITS; i++) {
+        if ((half & (1u << i)) && n + 1 < out_sz) {
+            out[n++] = mejiro_half_letters[i];
+        }
+    }
+    return n;
+}
+
+size_t mejiro_stroke_to_string(mejiro_stroke_t stroke, char *out, size_t out_sz) {
+    if (out == NULL || out_sz == 0) {
+        return 0;
+    }
+
+    size_t n = mejiro_half_to_string(MJ_LEFT(stroke), out, 0, out_sz);
+    if ((stroke & MJ_HASH) && n + 1 < out_sz) {
+        out[n++] = '#';
+    }
+    if (n + 1 < out_sz) {
+        out[n++] = '-';
+    }
+    n = mejiro_half_to_string(MJ_RIGHT(stroke), out, n, out_sz);
+    if ((stroke & MJ_STAR) && n + 1 < out_sz) {
+        out[n++] = '*';
+    }
+    out[n] = '\0';
+    return n;
+}
+
+uint16_t mejiro_half_from_string(const char *s) {
+    uint16_t half = 0;
+    for (; s != NULL && *s != '\0'; s++) {
+        const int bit = mejiro_half_bit(*s);
+        if (bit >= 0) {
+            half |= (uint16_t)(1u << bit);
+        }
+    }
+    return half;
+}
+
+mejiro_stroke_t mejiro_stroke_from_string(const char *s) {
+    mejiro_stroke_t stroke = 0;
+    unsigned int shift = 0;
+
+    for (; s != NULL && *s != '\0'; s++) {
+        if (*s == '-') {
+            shift = MJ_RIGHT_SHIFT;
+        } else if (*s == '#') {
+            stroke |= MJ_HASH;
+        } else if (*s == '*') {
+            stroke |= MJ_STAR;
+        } else {
+            const int bit = mejiro_half_bit(*s);
+            if (bit >= 0) {
+                stroke |= (mejiro_stroke_t)1u << (bit + shift);
+            }
+        }
+    }
+    return stroke;
+}
@@ -0,0 +1,497 @@
+#include <stddef.h>
+
+#include <zmk_naginata/mejiro_word.h>
+
+/*
+ * Word tables of the Mejiro transform, in UTF-8.
+ *
+ * Only the host generator (scripts/mejiro_kana_gen.c) links this file; it
+ * writes every table into mejiro_kana_table.h with the strings as kana codes.
+ */
+
+#define P_N MJ_PN
+#define P_T MJ_PT
+#define P_K MJ_PK
+
+// ユーザー略語のマッピング（完全なストローク形式）
+const abbreviation_entry_t mejiro_user_abbreviations_rules[] = {
+    {"A-SKNIA", "あめりか"},
+    {"KNUntk-KNU", "ぐーぐる"},
+    {"KAUn-TAntk", "こんぴゅーたー"},
+    {"SKNIA-SAUtk", "めそっど"},
+    {"TNIA-SNI", "でじたる"},
+    {"SU-STKNAU", "すまーとふぉん"},
+    {"SU-TKAU", "すまほ"},
+    {"STKU-STA", "ぷらすちっく"},
+    {"KI-TKNAU", "きーぼーど"},
+    {"In-STA", "いんふら"},
+    {"KAUn-TKNIn", "こんびに"},
+    {"SI-KNAUt", "しごと"},
+    {"SI-SU", "しすてむ"},
+    {"SAU-TKUt", "そふと"},
+    {"SAU-SKIA", "そふとうぇあ"},
+    {"TKA-SKIA", "はーどうぇあ"},
+    {"In-NIAtk", "いんたーねっと"},
+    {"In-STKNAU", "いんふぉめーしょん"},
+    {"KAU-SKNYU", "こみゅにけーしょん"},
+    {"SI-SKNYU", "しみゅれーしょん"},
+    {"IU-STU", "ういるす"},
+    {"KAU-IU", "ころなういるす"},
+    {"SIn-KNAt", "しんがた"},
+    {"A-STI", "ありがとう"},
+    {"AU-NIA", "おねがい"},
+    {"YAU-STAU", "よろしく"},
+    {"TA-TAU", "たとえば"},
+    {"KNU-TY", "ぐたいてきには"},
+    {NULL, NULL}
+};
+
+// 一般略語の完全一致マッピング
+const abbreviation_entry_t mejiro_abstract_abbreviations_rules[] = {
+    {"A-TNA", "あれだけ"},
+    {"KAU-TNA", "これだけ"},
+    {"SAU-TNA", "それだけ"},
+    {"TNAU-TNA", "どれだけ"},
+    {"TNA-TNA", "だれだけ"},
+    {"A-IU", "ああいう"},
+    {"KAU-IU", "こういう"},
+    {"SAU-IU", "そういう"},
+    {"TNAU-IU", "どういう"},
+    {"NA-IU", "なんていう"},
+    {NULL, NULL}
+};
+
+// 一般略語の左側マッピング
+const abbreviation_entry_t mejiro_abstract_left_rules[] = {
+    {"STN", ""},
+    {"IAU", "あの"},
+    {"KIAU", "この"},
+    {"SIAU", "その"},
+    {"TIAU", "との"},
+    {"TNIAU", "どの"},
+    {"NIAU", "なんの"},
+    {"IU", "いう"},
+    {"YIU", "ああいう"},
+    {"KIU", "こういう"},
+    {"SIU", "そういう"},
+    {"TIU", "という"},
+    {"TNIU", "どういう"},
+    {"NIU", "なんていう"},
+    {NULL, NULL}
+};
+
+// 一般略語の右側マッピング
+const abbreviation_entry_t mejiro_abstract_right_rules[] = {
+    {"STN", ""},
+    {"KAU", "こと"},
+    {"STAU", "ころ"},
+    {"KI", "とき"},
+    {"TAU", "ところ"},
+    {"TKI", "ひと"},
+    {"TKA", "はなし"},
+    {"KA", "かんじ"},
+    {"TKIAU", "ほう"},
+    {"SKNAU", "もの"},
+    {"KNAU", "ものごと"},
+    {"SI", "しごと"},
+    {NULL, NULL}
+};
+
+// 一般略語の後の助詞の組み合わせ → 語尾（ない組み合わせは助詞のまま）
+const abbreviation_ending_t mejiro_abstract_endings_rules[] = {
+    {P_N, 0, "である"},
+    {0, P_N, "だ"},
+    {P_N, P_N, "だった"},
+    {0, P_N | P_T | P_K, "です"},
+    {P_N, P_N | P_T | P_K, "でした"},
+    {0, P_N | P_T, "。"},
+    {0, P_N | P_K, "、"},
+    {P_N, P_N | P_T, "?"},
+    {P_N, P_N | P_K, "!"},
+    {0, 0, NULL}
+};
+
+// 五段活用テーブル
+// [行][活用形] = 語尾
+const char *const mejiro_godan_conjugate_rules[10][MEJIRO_CONJ_FORMS] = {
+    // k行
+    {"か", "か", "か", "き", "く", "い", "こう", "け", "け", "け"},
+    // g行
+    {"が", "が", "が", "ぎ", "ぐ", "い", "ごう", "げ", "げ", "げ"},
+    // s行
+    {"さ", "さ", "さ", "し", "す", "し", "そう", "せ", "せ", "せ"},
+    // t行
+    {"た", "た", "た", "ち", "つ", "っ", "とう", "て", "て", "て"},
+    // n行
+    {"な", "な", "な", "に", "ぬ", "ん", "のう", "ね", "ね", "ね"},
+    // b行
+    {"ば", "ば", "ば", "び", "ぶ", "ん", "ぼう", "べ", "べ", "べ"},
+    // m行
+    {"ま", "ま", "ま", "み", "む", "ん", "もう", "め", "め", "め"},
+    // r行
+    {"ら", "ら", "ら", "り", "る", "っ", "ろう", "れ", "れ", "れ"},
+    // w行
+    {"わ", "わ", "わ", "い", "う", "っ", "おう", "え", "え", "え"},
+    // dummy
+    {"", "", "", "", "", "", "", "", "", ""}
+};
+
+// 上一段活用テーブル
+const char *const mejiro_kami_conjugate_rules[10][MEJIRO_CONJ_FORMS] = {
+    // k行
+    {"き", "きさ", "きら", "き", "きる", "き", "きよう", "きれ", "きれ", "きろ"},
+    // g行
+    {"ぎ", "ぎさ", "ぎら", "ぎ", "ぎる", "ぎ", "ぎよう", "ぎれ", "ぎれ", "ぎろ"},
+    // z行
+    {"じ", "じさ", "じら", "じ", "じる", "じ", "じよう", "じれ", "じれ", "じろ"},
+    // t行
+    {"ち", "ちさ", "ちら", "ち", "ちる", "ち", "ちよう", "ちれ", "ちれ", "ちろ"},
+    // n行
+    {"に", "にさ", "にら", "に", "にる", "に", "によう", "にれ", "にれ", "にろ"},
+    // b行
+    {"び", "びさ", "びら", "び", "びる", "び", "びよう", "びれ", "びれ", "びろ"},
+    // m行
+    {"み", "みさ", "みら", "み", "みる", "み", "みよう", "みれ", "みれ", "みろ"},
+    // r行
+    {"り", "りさ", "りら", "り", "りる", "り", "りよう", "りれ", "りれ", "りろ"},
+    // w行
+    {"い", "いさ", "いら", "い", "いる", "い", "いよう", "いれ", "いれ", "いろ"},
+    // dummy
+    {"", "", "", "", "", "", "", "", "", ""}
+};
+
+// 下一段活用テーブル
+const char *const mejiro_simo_conjugate_rules[12][MEJIRO_CONJ_FORMS] = {
+    // k行
+    {"け", "けさ", "けら", "け", "ける", "け", "けよう", "けれ", "けれ", "けろ"},
+    // g行
+    {"げ", "げさ", "げら", "げ", "げる", "げ", "げよう", "げれ", "げれ", "げろ"},
+    // s行
+    {"せ", "せさ", "せら", "せ", "せる", "せ", "せよう", "せれ", "せれ", "せろ"},
+    // z行
+    {"ぜ", "ぜさ", "ぜら", "ぜ", "ぜる", "ぜ", "ぜよう", "ぜれ", "ぜれ", "ぜろ"},
+    // t行
+    {"て", "てさ", "てら", "て", "てる", "て", "てよう", "てれ", "てれ", "てろ"},
+    // d行
+    {"で", "でさ", "でら", "で", "でる", "で", "でよう", "でれ", "でれ", "でろ"},
+    // n行
+    {"ね", "ねさ", "ねら", "ね", "ねる", "ね", "ねよう", "ねれ", "ねれ", "ねろ"},
+    // h行
+    {"へ", "へさ", "へら", "へ", "へる", "へ", "へよう", "へれ", "へれ", "へろ"},
+    // b行
+    {"べ", "べさ", "べら", "べ", "べる", "べ", "べよう", "べれ", "べれ", "べろ"},
+    // m行
+    {"め", "めさ", "めら", "め", "める", "め", "めよう", "めれ", "めれ", "めろ"},
+    // r行
+    {"れ", "れさ", "れら", "れ", "れる", "れ", "れよう", "れれ", "れれ", "れろ"},
+    // w行
+    {"え", "えさ", "えら", "え", "える", "え", "えよう", "えれ", "えれ", "えろ"}
+};
+
+// サ変活用
+const char *const mejiro_sahen_conjugate_rules[MEJIRO_CONJ_FORMS] = {
+    "し", "さ", "さ", "し", "する", "し", "しよう", "すれ", "でき", "しろ"
+};
+// カ変活用
+const char *const mejiro_kahen_conjugate_rules[MEJIRO_CONJ_FORMS] = {
+    "こ", "こさ", "こら", "き", "くる", "き", "こよう", "くれ", "これ", "こい"
+};
+// 行く（五段特殊）
+const char *const mejiro_iku_conjugate_rules[MEJIRO_CONJ_FORMS] = {
+    "いか", "いか", "いか", "いき", "いく", "いっ", "いこう", "いけ", "いけ", "いけ"
+};
+// ある（五段特殊）
+const char *const mejiro_aru_conjugate_rules[MEJIRO_CONJ_FORMS] = {
+    "", "あら", "あら", "あり", "ある", "あっ", "あろう", "あれ", "ありえ", "あれ"
+};
+
+// 主要な動詞辞書 (Plover_Mejiroより統合)
+const verb_entry_t mejiro_verb_dict_rules[] = {
+    // 五段活用
+    // k行 13コ
+    {"A-STU", "ある", 'k', VERB_TYPE_GODAN},       // 歩く
+    {"I-TNA", "いただ", 'k', VERB_TYPE_GODAN},     // 頂く
+    {"U-KNAU", "うご", 'k', VERB_TYPE_GODAN},      // 動く
+    {"KA-YA", "かがや", 'k', VERB_TYPE_GODAN},     // 輝く
+    {"KI-KNA", "きがつ", 'k', VERB_TYPE_GODAN},    // 気が付く
+    {"KI-TNU", "きづ", 'k', VERB_TYPE_GODAN},      // 気付く
+    {"SI-KNAU", "しご", 'k', VERB_TYPE_GODAN},     // 扱く
+    {"TA-TA", "たた", 'k', VERB_TYPE_GODAN},       // 叩く
+    {"TU-TNU", "つづ", 'k', VERB_TYPE_GODAN},      // 続く
+    {"NAU-SNAU", "のぞ", 'k', VERB_TYPE_GODAN},    // 除く
+    {"TKA-STA", "はたら", 'k', VERB_TYPE_GODAN},   // 働く
+    {"TKI-STA", "ひら", 'k', VERB_TYPE_GODAN},     // 開く
+    {"SKNI-KNA", "みが", 'k', VERB_TYPE_GODAN},    // 磨く
+    // g行 7コ
+    {"I-SAU", "いそ", 'g', VERB_TYPE_GODAN},       // 急ぐ
+    {"KA-SIA", "かせ", 'g', VERB_TYPE_GODAN},      // 稼ぐ
+    {"KA-TU", "かつ", 'g', VERB_TYPE_GODAN},       // 担ぐ
+    {"SA-SA", "ささ", 'g', VERB_TYPE_GODAN},       // 捧ぐ
+    {"TU-NA", "つな", 'g', VERB_TYPE_GODAN},       // 繋ぐ
+    {"TKU-SA", "ふさ", 'g', VERB_TYPE_GODAN},      // 塞ぐ
+    {"TKU-SIA", "ふせ", 'g', VERB_TYPE_GODAN},     // 防ぐ
+    // s行 27コ
+    {"A-KA", "あか", 's', VERB_TYPE_GODAN},        // 明かす
+    {"I-KA", "いか", 's', VERB_TYPE_GODAN},        // 活かす
+    {"I-TA", "いた", 's', VERB_TYPE_GODAN},        // 致す
+    {"AU-TAU", "おと", 's', VERB_TYPE_GODAN},      // 落とす
+    {"KA-KA", "かか", 's', VERB_TYPE_GODAN},       // 欠かす
+    {"KA-KU", "かく", 's', VERB_TYPE_GODAN},       // 隠す
+    {"KU-STA", "くら", 's', VERB_TYPE_GODAN},      // 暮らす
+    {"KAU-STAU", "ころ", 's', VERB_TYPE_GODAN},    // 殺す
+    {"KAU-SKA", "こわ", 's', VERB_TYPE_GODAN},     // 壊す
+    {"SA-KNA", "さが", 's', VERB_TYPE_GODAN},      // 探す
+    {"SI-SKNIA", "しめ", 's', VERB_TYPE_GODAN},    // 示す
+    {"TA-AU", "たお", 's', VERB_TYPE_GODAN},       // 倒す
+    {"TNA-", "だ", 's', VERB_TYPE_GODAN},          // 出す
+    {"TU-TKNU", "つぶ", 's', VERB_TYPE_GODAN},     // 潰す
+    {"TIA-STA", "てら", 's', VERB_TYPE_GODAN},     // 照らす
+    {"NA-AU", "なお", 's', VERB_TYPE_GODAN},       // 直す
+    {"NI-KNA", "にが", 's', VERB_TYPE_GODAN},      // 逃がす
+    {"NAU-TKNA", "のば", 's', VERB_TYPE_GODAN},    // 伸ばす
+    {"TKA-NA", "はな", 's', VERB_TYPE_GODAN},      // 話す
+    {"TKA-KNA", "はが", 's', VERB_TYPE_GODAN},     // 剥がす
+    {"SKNA-KA", "まか", 's', VERB_TYPE_GODAN},     // 任す
+    {"SKNI-TA", "みた", 's', VERB_TYPE_GODAN},     // 満たす
+    {"SKNI-NA", "みな", 's', VERB_TYPE_GODAN},     // 見なす
+    {"SKNI-SKNA", "みまわ", 's', VERB_TYPE_GODAN}, // 見回す
+    {"SKNI-SKA", "みわた", 's', VERB_TYPE_GODAN},  // 見渡す
+    {"YU-STA", "ゆら", 's', VERB_TYPE_GODAN},      // 揺らす
+    {"SKA-TA", "わた", 's', VERB_TYPE_GODAN},      // 渡す
+    // t行 4コ
+    {"U-KNA", "うが", 't', VERB_TYPE_GODAN},       // 穿つ
+    {"SAU-TNA", "そだ", 't', VERB_TYPE_GODAN},     // 育つ
+    {"TA-SKNAU", "たも", 't', VERB_TYPE_GODAN},    // 保つ
+    {"SKNIA-TNA", "めだ", 't', VERB_TYPE_GODAN},   // 目立つ
+    // b行 10コ
+    {"A-SAU", "あそ", 'b', VERB_TYPE_GODAN},       // 遊ぶ
+    {"IA-STA", "えら", 'b', VERB_TYPE_GODAN},      // 選ぶ
+    {"AU-YAU", "およ", 'b', VERB_TYPE_GODAN},      // 及ぶ
+    {"KAU-STAU", "ころ", 'b', VERB_TYPE_GODAN},    // 転ぶ
+    {"NA-STA", "なら", 'b', VERB_TYPE_GODAN},      // 並ぶ
+    {"TKA-KAU", "はこ", 'b', VERB_TYPE_GODAN},     // 運ぶ
+    {"TKAU-STAU", "ほろ", 'b', VERB_TYPE_GODAN},   // 滅ぶ
+    {"SKNA-NA", "まな", 'b', VERB_TYPE_GODAN},     // 学ぶ
+    {"SKNU-SU", "むす", 'b', VERB_TYPE_GODAN},     // 結ぶ
+    {"YAU-STAU", "よろこ", 'b', VERB_TYPE_GODAN},  // 喜ぶ
+    // m行 19コ
+    {"I-NA", "いな", 'm', VERB_TYPE_GODAN},        // 否む
+    {"U-STA", "うらや", 'm', VERB_TYPE_GODAN},     // 羨む
+    {"KA-KNA", "かが", 'm', VERB_TYPE_GODAN},      // 屈む
+    {"KA-SU", "かす", 'm', VERB_TYPE_GODAN},       // 霞む
+    {"SI-SNU", "しず", 'm', VERB_TYPE_GODAN},      // 沈む
+    {"SU-SU", "すす", 'm', VERB_TYPE_GODAN},       // 進む
+    {"TA-NAU", "たの", 'm', VERB_TYPE_GODAN},      // 頼む
+    {"TIU-TKNA", "ついば", 'm', VERB_TYPE_GODAN},  // 啄む
+    {"TU-TU", "つつ", 'm', VERB_TYPE_GODAN},       // 包む
+    {"TU-SKNA", "つま", 'm', VERB_TYPE_GODAN},     // 摘む
+    {"NA-YA", "なや", 'm', VERB_TYPE_GODAN},       // 悩む
+    {"NU-SU", "ぬす", 'm', VERB_TYPE_GODAN},       // 盗む
+    {"NAU-SNAU", "のぞ", 'm', VERB_TYPE_GODAN},    // 望む
+    {"TKA-SA", "はさ", 'm', VERB_TYPE_GODAN},      // 挟む
+    {"TKA-STA", "はら", 'm', VERB_TYPE_GODAN},     // 孕む
+    {"TKI-KAU", "ひっこ", 'm', VERB_TYPE_GODAN},   // 引っ込む
+    {"TKU-KU", "ふく", 'm', VERB_TYPE_GODAN},      // 含む
+    {"TKAU-TKAU", "ほほえ", 'm', VERB_TYPE_GODAN}, // 微笑む
+    {"YA-SU", "やす", 'm', VERB_TYPE_GODAN},       // 休む
+    // r行 17コ
+    {"I-", "い", 'r', VERB_TYPE_GODAN},            // 要る
+    {"KA-KNI", "かぎ", 'r', VERB_TYPE_GODAN},      // 限る
+    {"KNA-TKNA", "がんば", 'r', VERB_TYPE_GODAN},  // 頑張る
+    {"KNA-", "がんば", 'r', VERB_TYPE_GODAN},      // 頑張る
+    {"KU-TNA", "くださ", 'r', VERB_TYPE_GODAN},    // 下さる
+    {"KIA-", "け", 'r', VERB_TYPE_GODAN},          // 蹴る
+    {"KAU-TAU", "ことな", 'r', VERB_TYPE_GODAN},   // 異なる
+    {"SYA-TKNIA", "しゃべ", 'r', VERB_TYPE_GODAN}, // しゃべる
+    {"SU-TKNIA", "すべ", 'r', VERB_TYPE_GODAN},    // 滑る
+    {"T-KA", "たすか", 'r', VERB_TYPE_GODAN},      // 助かる
+    {"TA-SNU", "たずさわ", 'r', VERB_TYPE_GODAN},  // 携わる
+    {"NA-", "な", 'r', VERB_TYPE_GODAN},           // なる
+    {"TKY-", "はい", 'r', VERB_TYPE_GODAN},        // 入る
+    {"TKA-SI", "はし", 'r', VERB_TYPE_GODAN},      // 走る
+    {"TKA-TKNA", "はばか", 'r', VERB_TYPE_GODAN},  // 憚る
+    {"YA-", "や", 'r', VERB_TYPE_GODAN},           // やる
+    {"-YA", "や", 'r', VERB_TYPE_GODAN},           // やる
+    {"SKA-", "わか", 'r', VERB_TYPE_GODAN},        // 分かる
+    // w行 41コ
+    {"-A", "あ", 'w', VERB_TYPE_GODAN},            // 会う
+    {"A-STA", "あら", 'w', VERB_TYPE_GODAN},       // 洗う
+    {"A-SAU", "あらそ", 'w', VERB_TYPE_GODAN},     // 争う
+    {"IU-", "い", 'w', VERB_TYPE_GODAN},           // 言う
+    {"I-SNA", "いざな", 'w', VERB_TYPE_GODAN},     // 誘う
+    {"I-SKA", "いわ", 'w', VERB_TYPE_GODAN},       // 祝う
+    {"U-SI", "うしな", 'w', VERB_TYPE_GODAN},      // 失う
+    {"U-TA", "うた", 'w', VERB_TYPE_GODAN},        // 歌う
+    {"U-KNA", "うたが", 'w', VERB_TYPE_GODAN},     // 疑う
+    {"U-YA", "うやま", 'w', VERB_TYPE_GODAN},      // 敬う
+    {"AU-KAU", "おこな", 'w', VERB_TYPE_GODAN},    // 行う
+    {"AU-SKNAU", "おも", 'w', VERB_TYPE_GODAN},    // 思う
+    {"AU-", "おも", 'w', VERB_TYPE_GODAN},         // 思う
+    {"KA-NA", "かな", 'w', VERB_TYPE_GODAN},       // 叶う
+    {"KA-SKNA", "かま", 'w', VERB_TYPE_GODAN},     // 構う
+    {"KU-STU", "くる", 'w', VERB_TYPE_GODAN},      // 狂う
+    {"SI-A", "しあ", 'w', VERB_TYPE_GODAN},        // 仕合う
+    {"SI-TA", "したが", 'w', VERB_TYPE_GODAN},     // 従う
+    {"SI-SKNA", "しま", 'w', VERB_TYPE_GODAN},     // 仕舞う
+    {"SAU-STAU", "そろ", 'w', VERB_TYPE_GODAN},    // 揃う
+    {"TA-TA", "たたか", 'w', VERB_TYPE_GODAN},     // 戦う
+    {"TI-KA", "ちか", 'w', VERB_TYPE_GODAN},       // 誓う
+    {"TI-KNA", "ちが", 'w', VERB_TYPE_GODAN},      // 違う
+    {"TU-KA", "つか", 'w', VERB_TYPE_GODAN},       // 使う
+    {"TU-TI", "つちか", 'w', VERB_TYPE_GODAN},     // 培う
+    {"TU-TNAU", "つど", 'w', VERB_TYPE_GODAN},     // 集う
+    {"TIA-STA", "てら", 'w', VERB_TYPE_GODAN},     // 衒う
+    {"TNIA-A", "であ", 'w', VERB_TYPE_GODAN},      // 出会う
+    {"TAU-NA", "ともな", 'w', VERB_TYPE_GODAN},    // 伴う
+    {"NA-STA", "なら", 'w', VERB_TYPE_GODAN},      // 習う
+    {"NI-A", "にあ", 'w', VERB_TYPE_GODAN},        // 似合う
+    {"NI-SKA", "にぎわ", 'w', VERB_TYPE_GODAN},    // 賑わう
+    {"NIA-KNA", "ねが", 'w', VERB_TYPE_GODAN},     // 願う
+    {"NAU-STAU", "のろ", 'w', VERB_TYPE_GODAN},    // 呪う
+    {"TKA-STA", "はら", 'w', VERB_TYPE_GODAN},     // 払う
+    {"TKI-STAU", "ひろ", 'w', VERB_TYPE_GODAN},    // 拾う
+    {"SKNA-TAU", "まと", 'w', VERB_TYPE_GODAN},    // 纏う
+    {"SKNI-A", "みあ", 'w', VERB_TYPE_GODAN},      // 見合う
+    {"SKNU-KA", "むか", 'w', VERB_TYPE_GODAN},     // 向かう
+    {"SKNAU-STA", "もら", 'w', VERB_TYPE_GODAN},   // 貰う
+    {"SKA-STA", "わら", 'w', VERB_TYPE_GODAN},     // 笑う
+    // 上一段活用
+    // k行 1コ
+    {"TN-KI", "で", 'k', VERB_TYPE_KAMI},          // 出来る
+    // z行 5コ
+    {"IA-SNI", "えん", 'z', VERB_TYPE_KAMI},       // 演じる
+    {"KA-SNI", "かん", 'z', VERB_TYPE_KAMI},       // 感じる
+    {"KI-SNI", "きん", 'z', VERB_TYPE_KAMI},       // 禁じる
+    {"SI-SNI", "しん", 'z', VERB_TYPE_KAMI},       // 信じる
+    {"TNA-SNI", "だん", 'z', VERB_TYPE_KAMI},      // 断じる
+    // m行 1コ
+    {"KA-SKNI", "かんが", 'm', VERB_TYPE_KAMI},    // 鑑みる
+    // 下一段活用
+    // k行 4コ
+    {"KI-SKAU", "きをつ", 'k', VERB_TYPE_SIMO},    // 気をつける
+    {"T-KIA", "たす", 'k', VERB_TYPE_SIMO},        // 助ける
+    {"TU-TN", "つづ", 'k', VERB_TYPE_SIMO},        // 続ける
+    {"TN-KIA", "つづ", 'k', VERB_TYPE_SIMO},       // 続ける
+    // g行 1コ
+    {"K-KNIA", "かか", 'g', VERB_TYPE_SIMO},       // 掲げる
+    // s行 2コ
+    {"A-SKA", "あわ", 's', VERB_TYPE_SIMO},       // 合わせる
+    {"SKNA-KA", "まか", 's', VERB_TYPE_SIMO},      // 任せる
+    // d行 1コ
+    {"TN-", "", 'd', VERB_TYPE_SIMO},              // 出る
+    // b行 2コ
+    {"KU-STA", "くら", 'b', VERB_TYPE_SIMO},       // 比べる
+    {"SI-STA", "しら", 'b', VERB_TYPE_SIMO},       // 調べる
+    // m行 4コ
+    {"SA-TNA", "さだ", 'm', VERB_TYPE_SIMO},       // 定める
+    {"TA-SI", "たしか", 'm', VERB_TYPE_SIMO},      // 確かめる
+    {"TKA-SNI", "はじ", 'm', VERB_TYPE_SIMO},      // 始める
+    {"SKNAU-TAU", "もと", 'm', VERB_TYPE_SIMO},    // 求める
+    // r行 5コ
+    {"U-SKNAU", "うも", 'r', VERB_TYPE_SIMO},      // 埋もれる
+    {"KAU-STIA", "こわ", 'r', VERB_TYPE_SIMO},     // 壊れる
+    {"NA-KNA", "なが", 'r', VERB_TYPE_SIMO},       // 流れる
+    {"TKA-SNU", "はず", 'r', VERB_TYPE_SIMO},      // 外れる
+    {"SKA-SU", "わす", 'r', VERB_TYPE_SIMO},       // 忘れる
+    // w行 10コ
+    {"AU-SA", "おさ", 'w', VERB_TYPE_SIMO},        // 抑える
+    {"AU-SI", "おし", 'w', VERB_TYPE_SIMO},        // 教える
+    {"AU-TKNAU", "おぼ", 'w', VERB_TYPE_SIMO},     // 覚える
+    {"KA-KNA", "かんが", 'w', VERB_TYPE_SIMO},     // 考える
+    {"KA-", "かんが", 'w', VERB_TYPE_SIMO},        // 考える
+    {"KI-TA", "きた", 'w', VERB_TYPE_SIMO},        // 鍛える
+    {"KU-SKA", "くわ", 'w', VERB_TYPE_SIMO},       // 加える
+    {"KAU-TA", "こた", 'w', VERB_TYPE_SIMO},       // 答える
+    {"SA-SA", "ささ", 'w', VERB_TYPE_SIMO},        // 支える
+    {"SKNA-KNA", "まちが", 'w', VERB_TYPE_SIMO},   // 間違える
+    // 特殊活用
+    {"I-K", "", '\0', VERB_TYPE_SPECIAL},          // 行く（特殊）
+    {"A-", "", '\0', VERB_TYPE_SPECIAL},           // ある（特殊）
+    {"K-", "", '\0', VERB_TYPE_KAHEN},             // 来る（カ変）
+    {NULL, NULL, '\0', VERB_TYPE_GODAN}
+};
+
+// 「です」の活用（右助詞コードで引く）
+const char *const mejiro_desu_conjugate_rules[8] = {
+    [0] = "です",
+    [P_N] = "でして",
+    [P_T] = "でした",
+    [P_K] = "でしょう",
+    [P_N | P_T] = "です.",
+    [P_N | P_K] = "ですが",
+    [P_T | P_K] = "ですか?",
+    [P_N | P_T | P_K] = "ですね",
+};
+
+// 助詞の追加音（ん/つ/く/っ/ち/き/ー）を助詞コードで引く
+const char *const mejiro_second_sound_rules[8] = {
+    [0] = "",
+    [P_N] = "ん",
+    [P_T] = "つ",
+    [P_K] = "く",
+    [P_T | P_K] = "っ",
+    [P_N | P_T] = "ち",
+    [P_N | P_K] = "き",
+    [P_N | P_T | P_K] = "ー",
+};
+
+// 補助動詞・助動詞マップ
+const auxiliary_map_t mejiro_auxiliary_exception_rules[] = {
+    {P_N | P_T, 0, CONJ_MASU, "たい"}, // ～たい
+    {P_N | P_T, P_N, CONJ_MASU, "たくない"}, // ～たい+否定
+    {P_N | P_T, P_T, CONJ_MASU, "たかった"}, // ～たい+過去
+    {P_N | P_T, P_N | P_T, CONJ_MASU, "たくなかった"}, // ～たい+否定+過去
+    {P_N | P_T, P_K, CONJ_TE_TA, "てほしい"}, // ～ほしい
+    {P_N | P_T, P_N | P_K, CONJ_TE_TA, "てほしくない"}, // ～ほしい+否定
+    {P_N | P_T, P_T | P_K, CONJ_TE_TA, "てほしかった"}, // ～ほしい+過去
+    {P_N | P_T, P_N | P_T | P_K, CONJ_TE_TA, "てほしくなかった"}, // ～ほしい+否定+過去
+    {P_T | P_K, 0, CONJ_KANOU, "る"},              // 可能
+    {P_T | P_K, P_N, CONJ_KANOU, "ない"},           // 可能+否定
+    {P_T | P_K, P_T, CONJ_KANOU, "た"},             // 可能+過去
+    {P_T | P_K, P_K, CONJ_KANOU, "ます"},           // 可能+丁寧
+    {P_T | P_K, P_N | P_T, CONJ_KANOU, "なかった"},      // 可能+否定+過去
+    {P_T | P_K, P_N | P_K, CONJ_KANOU, "ません"},        // 可能+否定+丁寧
+    {P_T | P_K, P_T | P_K, CONJ_KANOU, "ました"},        // 可能+過去+丁寧
+    {P_T | P_K, P_N | P_T | P_K, CONJ_KANOU, "て"},           // 可能+て
+    {P_N | P_T | P_K, 0, CONJ_MASU, ""},                // 連用
+    {P_N | P_T | P_K, P_N, CONJ_NAI, "ず"},              // 否定
+    {P_N | P_T | P_K, P_T, CONJ_KATEI, "ば"},            // 仮定
+    {P_N | P_T | P_K, P_K, CONJ_MASU, "ましょう"},           // 提案
+    {P_N | P_T | P_K, P_N | P_T, CONJ_NAI, "なければ"},       // 否定+仮定
+    {P_N | P_T | P_K, P_N | P_K, CONJ_NAI, "なく"},           // 否定+連用
+    {P_N | P_T | P_K, P_T | P_K, CONJ_TE_TA, "てください"},   // 丁寧命令
+    {P_N | P_T | P_K, P_N | P_T | P_K, CONJ_IKOU, ""},               // 意向
+    {0, 0, CONJ_JISHO, NULL}
+};
+
+// 左側補助動詞マップ: [活用形, 補助動詞の語幹, 活用段, 活用行]
+const left_auxiliary_info_t mejiro_left_auxiliary_rules[] = {
+    {P_N, CONJ_TE_TA, "て", 2, 'w'},      // ～ている
+    {P_T, CONJ_SHIEKI, "", 3, 's'},        // ～させる（使役）
+    {P_K, CONJ_UKEMI, "", 3, 'r'},        // ～られる（受身）
+    {P_N | P_K, CONJ_TE_TA, "てしま", 1, 'w'}, // ～てしまう
+    {0, CONJ_JISHO, NULL, 0, '\0'}
+};
+
+// 右側助動詞マップ（右助詞コードで引く）
+const right_auxiliary_t mejiro_right_auxiliary_rules[8] = {
+    [0] = {CONJ_JISHO, ""},
+    [P_N] = {CONJ_NAI, "ない"},
+    [P_T] = {CONJ_TE_TA, "た"},
+    [P_K] = {CONJ_MASU, "ます"},
+    [P_N | P_T] = {CONJ_NAI, "なかった"},
+    [P_N | P_K] = {CONJ_MASU, "ません"},
+    [P_T | P_K] = {CONJ_MASU, "ました"},
+    [P_N | P_T | P_K] = {CONJ_TE_TA, "て"},
+};
+
+// 左側助詞（助詞コードで引く）
+const char *const mejiro_l_particle_rules[8] = {
+    [0] = "", [P_N] = "、", [P_T] = "に", [P_K] = "の",
+    [P_T | P_K] = "で", [P_N | P_T] = "と", [P_N | P_K] = "を", [P_N | P_T | P_K] = "へ",
+};
+// 右側助詞（nを除いた助詞コードで引く）
+const char *const mejiro_r_particle_rules[8] = {
+    [0] = "", [P_N] = "、", [P_T] = "は", [P_K] = "が",
+    [P_T | P_K] = "も", [P_N | P_T] = "は、", [P_N | P_K] = "が、", [P_N | P_T | P_K] = "も、",
+};
@@ -0,0 +1,754 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+
+#if IS_ENABLED(CONFIG_SETTINGS)
+#include <zephyr/settings/settings.h>
+#endif
+
+#include <zmk/event_manager.h>
+#include <zmk/events/keycode_state_changed.h>
+#include <zmk/endpoints.h>
+#include <zmk/hid.h>
+#include <zmk/keys.h>
+
+#if IS_ENABLED(CONFIG_NAGINATA_EMIT_BLE_ALIGN)
+#include <zephyr/bluetooth/conn.h>
+#include <zmk/ble.h>
+#include <zmk/events/ble_active_profile_changed.h>
+#endif
+
+#include <zmk_naginata/naginata_emit.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+struct naginata_emit_op {
+    uint32_t keycode; /* 0 = pause only */
+    uint8_t pace;     /* enum naginata_pace, wait after this event */
+    uint8_t kana;     /* kana completed by this release (undo may cut after it) */
+    bool pressed;
+};
+
+static struct naginata_emit_op emit_ring[CONFIG_NAGINATA_EMIT_QUEUE_SIZE];
+static uint16_t emit_head = 0;
+static uint16_t emit_count = 0;
+static struct k_spinlock emit_lock;
+
+/* Running op counts (emit_pushed - emit_popped == emit_count) and the last entry, under emit_lock */
+static uint32_t emit_pushed = 0;
+static uint32_t emit_popped = 0;
+static uint32_t emit_entry_start = 0;
+static uint32_t emit_entry_end = 0;
+static bool emit_entry_valid = false;
+static bool emit_popped_unit_end = true; /* no kana is partly raised */
+
+/* Priority lane: each event waits only until emit_popped reaches `after` */
+struct naginata_emit_priority_op {
+    struct naginata_emit_op op;
+    uint32_t after;
+};
+
+static struct naginata_emit_priority_op emit_priority_ring[CONFIG_NAGINATA_EMIT_PRIORITY_QUEUE_SIZE];
+static uint16_t emit_priority_head = 0;
+static uint16_t emit_priority_count = 0;
+
+/* a producer waiting for room in the paced lane (naginata_emit_reserve), under emit_lock */
+static struct k_work *emit_room_work = NULL;
+static uint16_t emit_room_ops = 0;
+
+/* the paced lane waits until then before its next event (system work queue only) */
+static int64_t emit_paced_due = 0;
+
+static int64_t mejiro_synth_timestamp = 0;
+static struct k_spinlock emit_ts_lock;
+
+/* IME state as last seen on the event bus, and the pacing profile for each state */
+static atomic_t emit_ime_on = ATOMIC_INIT(1);
+static struct naginata_pace_profile emit_profiles[2] = {
+    [0] = {.intra_kana_ms = 0, .inter_kana_ms = 0},
+    [1] = {.intra_kana_ms = CONFIG_NAGINATA_ROMA_INTRA_KANA_DELAY_MS,
+           .inter_kana_ms = CONFIG_NAGINATA_ROMA_INTER_KANA_DELAY_MS},
+};
+
+/*
+ * The events are raised from the system work queue, the thread that also runs
+ * the keymap for physical keys, so synthesized and physical events never
+ * interleave inside one listener.
+ */
+static struct k_work_delayable emit_work;
+K_SEM_DEFINE(naginata_emit_space_sem, 0, 1);
+
+void naginata_emit_sync_timestamp(int64_t ts) {
+    k_spinlock_key_t key = k_spin_lock(&emit_ts_lock);
+    if (mejiro_synth_timestamp < ts) {
+        mejiro_synth_timestamp = ts;
+    }
+    k_spin_unlock(&emit_ts_lock, key);
+}
+
+static int64_t next_mejiro_synth_timestamp(void) {
+    k_spinlock_key_t key = k_spin_lock(&emit_ts_lock);
+    int64_t ts = ++mejiro_synth_timestamp;
+    k_spin_unlock(&emit_ts_lock, key);
+    return ts;
+}
+
+void naginata_emit_set_profile(bool ime_on, const struct naginata_pace_profile *profile) {
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    emit_profiles[ime_on ? 1 : 0] = *profile;
+    k_spin_unlock(&emit_lock, key);
+}
+
+void naginata_emit_get_profile(bool ime_on, struct naginata_pace_profile *profile) {
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    *profile = emit_profiles[ime_on ? 1 : 0];
+    k_spin_unlock(&emit_lock, key);
+}
+
+bool naginata_emit_ime_on(void) { return atomic_get(&emit_ime_on) != 0; }
+
+#if IS_ENABLED(CONFIG_SETTINGS)
+static void emit_save_work_handler(struct k_work *work) {
+    struct naginata_pace_profile profiles[2];
+
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    memcpy(profiles, emit_profiles, sizeof(profiles));
+    k_spin_unlock(&emit_lock, key);
+
+    int err = settings_save_one("naginata/pace", profiles, sizeof(profiles));
+    if (err < 0) {
+        LOG_ERR("Failed to save naginata pacing (err %d)", err);
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(emit_save_work, emit_save_work_handler);
+
+static int emit_settings_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg) {
+    const char *next;
+    struct naginata_pace_profile profiles[2];
+
+    if (!settings_name_steq(name, "pace", &next) || next) {
+        return -ENOENT;
+    }
+    if (len != sizeof(profiles)) {
+        return -EINVAL;
+    }
+
+    int err = read_cb(cb_arg, profiles, sizeof(profiles));
+    if (err <= 0) {
+        LOG_ERR("Failed to read naginata pacing from settings (err %d)", err);
+        return err;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    memcpy(emit_profiles, profiles, sizeof(profiles));
+    k_spin_unlock(&emit_lock, key);
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(naginata, "naginata", NULL, emit_settings_set, NULL, NULL);
+#endif
+
+void naginata_emit_adjust_profile(enum naginata_pace pace, int delta_ms) {
+    const bool ime_on = naginata_emit_ime_on();
+
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    struct naginata_pace_profile *profile = &emit_profiles[ime_on ? 1 : 0];
+    uint16_t *ms = pace == NAGINATA_PACE_INTRA_KANA ? &profile->intra_kana_ms
+                                                    : &profile->inter_kana_ms;
+    *ms = (uint16_t)CLAMP((int)*ms + delta_ms, 0, CONFIG_NAGINATA_PACE_MAX_MS);
+    k_spin_unlock(&emit_lock, key);
+
+#if IS_ENABLED(CONFIG_SETTINGS)
+    k_work_reschedule(&emit_save_work, K_MSEC(CONFIG_NAGINATA_PACE_SAVE_DEBOUNCE_MS));
+#endif
+}
+
+#if IS_ENABLED(CONFIG_NAGINATA_EMIT_BLE_ALIGN)
+/*
+ * BLE connection events
+ *
+ * Over BLE the host gets the reports once per connection event, so it never
+ * sees a spacing finer than the connection interval. Reports raised less than
+ * half an interval apart arrive in the same event anyway: those delays are
+ * dropped and the reports go out as one burst (up to
+ * CONFIG_NAGINATA_EMIT_BLE_REPORTS_PER_EVENT). Longer delays are rounded up to
+ * whole intervals, so every burst lands in its own event and the radio is not
+ * woken for events that carry nothing. Peripheral latency lets the link skip
+ * the idle events in between.
+ */
+
+/* Connection interval to the active host in 1.25 ms units, 0 when not connected. */
+static atomic_t emit_ble_interval = ATOMIC_INIT(0);
+
+static bool emit_ble_is_active(struct bt_conn *conn) {
+    return bt_addr_le_cmp(bt_conn_get_dst(conn), zmk_ble_active_profile_addr()) == 0;
+}
+
+/* Look the active host up again: at connection and on a profile switch only. */
+static void emit_ble_refresh(void) {
+    uint16_t interval = 0;
+    struct bt_conn *conn = bt_conn_lookup_addr_le(BT_ID_DEFAULT, zmk_ble_active_profile_addr());
+    if (conn != NULL) {
+        struct bt_conn_info info;
+        if (bt_conn_get_info(conn, &info) == 0) {
+            interval = info.le.interval;
+        }
+        bt_conn_unref(conn);
+    }
+    atomic_set(&emit_ble_interval, interval);
+}
+
+static void emit_ble_connected(struct bt_conn *conn, uint8_t err) {
+    if (err == 0 && emit_ble_is_active(conn)) {
+        emit_ble_refresh();
+    }
+}
+
+static void emit_ble_disconnected(struct bt_conn *conn, uint8_t reason) {
+    if (emit_ble_is_active(conn)) {
+        atomic_set(&emit_ble_interval, 0);
+    }
+}
+
+static void emit_ble_param_updated(struct bt_conn *conn, uint16_t interval, uint16_t latency,
+                                   uint16_t timeout) {
+    if (emit_ble_is_active(conn)) {
+        atomic_set(&emit_ble_interval, interval);
+    }
+}
+
+BT_CONN_CB_DEFINE(naginata_emit_conn_callbacks) = {
+    .connected = emit_ble_connected,
+    .disconnected = emit_ble_disconnected,
+    .le_param_updated = emit_ble_param_updated,
+};
+
+/* Connection interval to the active host in microseconds, 0 when output is not over BLE. */
+static uint32_t emit_ble_interval_us(void) {
+    if (zmk_endpoints_selected().transport != ZMK_TRANSPORT_BLE) {
+        return 0;
+    }
+    return (uint32_t)atomic_get(&emit_ble_interval) * 1250;
+}
+
+static uint16_t emit_ble_align(uint16_t delay_ms, uint32_t interval_us) {
+    const uint32_t delay_us = (uint32_t)delay_ms * 1000;
+
+    if (interval_us == 0 || delay_ms == 0) {
+        return delay_ms;
+    }
+    if (delay_us * 2 < interval_us) {
+        return 0;
+    }
+    return (uint16_t)DIV_ROUND_UP(DIV_ROUND_UP(delay_us, interval_us) * interval_us, 1000);
+}
+#else
+static uint32_t emit_ble_interval_us(void) { return 0; }
+
+static uint16_t emit_ble_align(uint16_t delay_ms, uint32_t interval_us) { return delay_ms; }
+#endif
+
+static uint16_t emit_pace_ms(uint8_t pace) {
+    struct naginata_pace_profile profile;
+    naginata_emit_get_profile(naginata_emit_ime_on(), &profile);
+
+    uint16_t ms;
+    switch (pace) {
+    case NAGINATA_PACE_INTRA_KANA:
+        ms = profile.intra_kana_ms;
+        break;
+    case NAGINATA_PACE_INTER_KANA:
+        ms = profile.inter_kana_ms;
+        break;
+    case NAGINATA_PACE_HEX_DIGIT:
+        ms = CONFIG_NAGINATA_UNICODE_DIGIT_DELAY_MS;
+        break;
+    case NAGINATA_PACE_SESSION:
+        ms = CONFIG_NAGINATA_UNICODE_SESSION_DELAY_MS;
+        break;
+    default:
+        ms = 0;
+        break;
+    }
+    return ms > 0 ? emit_ble_align(ms, emit_ble_interval_us()) : 0;
+}
+
+/* The release that completes one or more kana. */
+static bool emit_ends_unit(const struct naginata_emit_op *op) { return op->kana > 0; }
+
+static bool emit_is_modifier(uint32_t keycode) {
+    return ZMK_HID_USAGE_ID(keycode) >= HID_USAGE_KEY_KEYBOARD_LEFTCONTROL &&
+           ZMK_HID_USAGE_ID(keycode) <= HID_USAGE_KEY_KEYBOARD_RIGHT_GUI;
+}
+
+static bool emit_pop(struct naginata_emit_op *op) {
+    struct k_work *resume = NULL;
+
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    if (emit_count == 0) {
+        k_spin_unlock(&emit_lock, key);
+        return false;
+    }
+    *op = emit_ring[emit_head];
+    emit_head = (emit_head + 1) % ARRAY_SIZE(emit_ring);
+    emit_count--;
+    emit_popped++;
+    if (op->pressed && !emit_is_modifier(op->keycode)) {
+        emit_popped_unit_end = false;
+    } else if (emit_ends_unit(op)) {
+        emit_popped_unit_end = true;
+    }
+    if (emit_room_work != NULL && ARRAY_SIZE(emit_ring) - emit_count >= emit_room_ops) {
+        resume = emit_room_work;
+        emit_room_work = NULL;
+    }
+    k_spin_unlock(&emit_lock, key);
+    k_sem_give(&naginata_emit_space_sem);
+    if (resume != NULL) {
+        k_work_submit(resume);
+    }
+    return true;
+}
+
+/* HID reports sent for synthesized keys (one per raised event, one per packed release) */
+static atomic_t emit_reports = ATOMIC_INIT(0);
+
+uint32_t naginata_emit_report_count(void) { return (uint32_t)atomic_get(&emit_reports); }
+
+#if CONFIG_NAGINATA_EMIT_PACK_KEYS > 1
+/*
+ * Report packing
+ *
+ * A run of distinct plain keys is typed as overlapping presses: each press
+ * still gets its own report (so the host sees the key-downs in queue order),
+ * but the releases are held back and sent together in one report. "kyo" is
+ * 3 press reports + 1 release report instead of 6. A release is only held
+ * back when the next queued event presses another packable key, so nothing
+ * stays down once the queue drains.
+ *
+ * The packed releases go to the HID report directly and skip
+ * zmk_keycode_state_changed, so listeners see only the presses. That is
+ * limited to keys no release listener acts on: plain keys without implicit
+ * modifiers (hold-tap only captures modifiers; caps word, key repeat and the
+ * IME listener below look at presses only), and only while no explicit
+ * modifier is held, which is how an active sticky modifier shows up. Sticky
+ * keys act on the release of the key they modified, so packing defaults to
+ * off when the keymap uses them (CONFIG_ZMK_BEHAVIOR_STICKY_KEY).
+ */
+static zmk_key_t emit_held[CONFIG_NAGINATA_EMIT_PACK_KEYS];
+static uint8_t emit_held_count = 0;
+static int64_t emit_held_since;
+
+/* letters, digits and punctuation without implicit modifiers */
+static bool emit_packable(uint32_t keycode) {
+    const uint8_t page = ZMK_HID_USAGE_PAGE(keycode);
+    const uint16_t usage = ZMK_HID_USAGE_ID(keycode);
+    return (page == 0 || page == HID_USAGE_KEY) && SELECT_MODS(keycode) == 0 &&
+           usage >= HID_USAGE_KEY_KEYBOARD_A &&
+           usage <= HID_USAGE_KEY_KEYBOARD_SLASH_AND_QUESTION_MARK;
+}
+
+static bool emit_is_held(uint32_t keycode) {
+    for (uint8_t i = 0; i < emit_held_count; i++) {
+        if (emit_held[i] == ZMK_HID_USAGE_ID(keycode)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void emit_hold(uint32_t keycode) {
+    if (emit_held_count == 0) {
+        emit_held_since = k_uptime_get();
+    }
+    emit_held[emit_held_count++] = ZMK_HID_USAGE_ID(keycode);
+}
+
+/* Release every held key in one report. */
+static void emit_release_held(void) {
+    if (emit_held_count == 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < emit_held_count; i++) {
+        (void)zmk_hid_keyboard_release(emit_held[i]);
+    }
+    emit_held_count = 0;
+    (void)zmk_endpoints_send_report(HID_USAGE_KEY);
+    atomic_inc(&emit_reports);
+}
+
+/* Whether the release in op can wait for the press queued after it. */
+static bool emit_defer_release(const struct naginata_emit_op *op, uint16_t delay_ms) {
+    if (!emit_packable(op->keycode) || emit_is_held(op->keycode) ||
+        emit_held_count + 2 > CONFIG_NAGINATA_EMIT_PACK_KEYS || zmk_hid_get_explicit_mods() != 0) {
+        return false;
+    }
+    const int64_t since = emit_held_count > 0 ? emit_held_since : k_uptime_get();
+    if (k_uptime_get() + delay_ms - since > CONFIG_NAGINATA_EMIT_PACK_HOLD_MS) {
+        return false;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    bool defer = false;
+    if (emit_count > 0) {
+        const struct naginata_emit_op *next = &emit_ring[emit_head];
+        defer = next->pressed && emit_packable(next->keycode) && !emit_is_held(next->keycode) &&
+                ZMK_HID_USAGE_ID(next->keycode) != ZMK_HID_USAGE_ID(op->keycode);
+    }
+    k_spin_unlock(&emit_lock, key);
+    return defer;
+}
+
+/* Raise the event and return the delay to wait before the next one. */
+static uint16_t emit_raise(const struct naginata_emit_op *op) {
+    const uint16_t delay_ms = emit_pace_ms(op->pace);
+
+    if (op->keycode == 0) {
+        emit_release_held();
+        return delay_ms;
+    }
+    if (!op->pressed && emit_packable(op->keycode)) {
+        const bool defer = emit_defer_release(op, delay_ms);
+        /* a release that neither waits nor ends a held run goes on the event bus */
+        if (defer || emit_held_count > 0) {
+            emit_hold(op->keycode);
+            if (!defer) {
+                emit_release_held();
+            }
+            return delay_ms;
+        }
+    }
+    if (!op->pressed || !emit_packable(op->keycode) || emit_is_held(op->keycode)) {
+        emit_release_held();
+    }
+    (void)raise_zmk_keycode_state_changed_from_encoded(op->keycode, op->pressed,
+                                                       next_mejiro_synth_timestamp());
+    atomic_inc(&emit_reports);
+    return delay_ms;
+}
+#else
+/* Raise the event and return the delay to wait before the next one. */
+static uint16_t emit_raise(const struct naginata_emit_op *op) {
+    if (op->keycode != 0) {
+        (void)raise_zmk_keycode_state_changed_from_encoded(op->keycode, op->pressed,
+                                                           next_mejiro_synth_timestamp());
+        atomic_inc(&emit_reports);
+    }
+    return emit_pace_ms(op->pace);
+}
+#endif
+
+static bool emit_pop_priority(struct naginata_emit_op *op) {
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    const bool ready = emit_priority_count > 0 &&
+                       (int32_t)(emit_popped - emit_priority_ring[emit_priority_head].after) >= 0;
+    if (ready) {
+        *op = emit_priority_ring[emit_priority_head].op;
+        emit_priority_head = (emit_priority_head + 1) % ARRAY_SIZE(emit_priority_ring);
+        emit_priority_count--;
+    }
+    k_spin_unlock(&emit_lock, key);
+    if (ready) {
+        k_sem_give(&naginata_emit_space_sem);
+    }
+    return ready;
+}
+
+#if IS_ENABLED(CONFIG_NAGINATA_EMIT_BLE_ALIGN)
+/* reports raised since the last delay: one BLE connection event takes only so many */
+static uint32_t emit_burst_reports = 0;
+
+static uint16_t emit_ble_burst_delay(uint32_t reports, uint16_t delay_ms) {
+    if (delay_ms > 0) {
+        emit_burst_reports = 0;
+        return delay_ms;
+    }
+    emit_burst_reports += reports;
+    if (emit_burst_reports < CONFIG_NAGINATA_EMIT_BLE_REPORTS_PER_EVENT) {
+        return 0;
+    }
+    const uint32_t interval_us = emit_ble_interval_us();
+    emit_burst_reports = 0;
+    return (uint16_t)DIV_ROUND_UP(interval_us, 1000);
+}
+#else
+static uint16_t emit_ble_burst_delay(uint32_t reports, uint16_t delay_ms) { return delay_ms; }
+#endif
+
+/* Raise every priority event whose paced events are out. */
+static void emit_raise_priority(void) {
+    struct naginata_emit_op op;
+
+    while (emit_pop_priority(&op)) {
+        (void)emit_raise(&op);
+    }
+}
+
+static void emit_work_handler(struct k_work *work) {
+    struct naginata_emit_op op;
+
+    emit_raise_priority();
+
+    const int64_t wait_ms = emit_paced_due - k_uptime_get();
+    if (wait_ms > 0) {
+        k_work_reschedule(&emit_work, K_MSEC(wait_ms));
+        return;
+    }
+    if (!emit_pop(&op)) {
+        return;
+    }
+    const uint32_t reports = naginata_emit_report_count();
+    uint16_t delay_ms = emit_raise(&op);
+    delay_ms = emit_ble_burst_delay(naginata_emit_report_count() - reports, delay_ms);
+    if (delay_ms > 0) {
+        emit_paced_due = k_uptime_get() + delay_ms;
+    }
+    emit_raise_priority();
+
+    /* one paced event per run, so work queued behind it (physical keys) goes in between */
+    k_work_reschedule(&emit_work, K_MSEC(delay_ms));
+}
+
+/*
+ * Raise the next event inline. For producers on the system work queue when a
+ * lane is full: the work item that would drain it cannot run meanwhile, and
+ * sleeping here would hold up the keymap. Strokes wait for room before they
+ * start (naginata_emit_reserve), so only output larger than the lane gets
+ * here; its next event goes out now, without the rest of its pace delay.
+ */
+static void emit_drain_inline(void) {
+    struct naginata_emit_op op;
+
+    if (emit_pop_priority(&op)) {
+        (void)emit_raise(&op);
+        return;
+    }
+    if (emit_pop(&op)) {
+        const uint16_t delay_ms = emit_raise(&op);
+        if (delay_ms > 0) {
+            emit_paced_due = k_uptime_get() + delay_ms;
+        }
+    }
+}
+
+/* Wait for room in a full lane. */
+static void emit_wait_space(void) {
+    if (k_current_get() == k_work_queue_thread_get(&k_sys_work_q)) {
+        emit_drain_inline();
+    } else {
+        LOG_DBG("naginata emit queue full, waiting");
+        k_work_schedule(&emit_work, K_NO_WAIT);
+        k_sem_take(&naginata_emit_space_sem, K_MSEC(100));
+    }
+}
+
+static void emit_push(uint32_t keycode, bool pressed, enum naginata_pace pace, uint8_t kana) {
+    const struct naginata_emit_op op = {
+        .keycode = keycode, .pace = pace, .kana = kana, .pressed = pressed};
+
+    for (;;) {
+        k_spinlock_key_t key = k_spin_lock(&emit_lock);
+        if (emit_count < ARRAY_SIZE(emit_ring)) {
+            emit_ring[(emit_head + emit_count) % ARRAY_SIZE(emit_ring)] = op;
+            emit_count++;
+            emit_pushed++;
+            k_spin_unlock(&emit_lock, key);
+            break;
+        }
+        k_spin_unlock(&emit_lock, key);
+        emit_wait_space();
+    }
+
+    /* No effect while a pacing delay is pending, so the delay is kept. */
+    k_work_schedule(&emit_work, K_NO_WAIT);
+}
+
+bool naginata_emit_reserve(uint16_t ops, struct k_work *resume) {
+    ops = MIN(ops, (uint16_t)ARRAY_SIZE(emit_ring));
+
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    const bool room = ARRAY_SIZE(emit_ring) - emit_count >= ops;
+    if (!room) {
+        emit_room_work = resume;
+        emit_room_ops = ops;
+    }
+    k_spin_unlock(&emit_lock, key);
+    return room;
+}
+
+void naginata_emit_press(uint32_t keycode) { emit_push(keycode, true, NAGINATA_PACE_NONE, 0); }
+
+void naginata_emit_release(uint32_t keycode) { emit_push(keycode, false, NAGINATA_PACE_NONE, 0); }
+
+void naginata_emit_tap(uint32_t keycode, enum naginata_pace pace) {
+    naginata_emit_tap_kana(keycode, pace, 0);
+}
+
+void naginata_emit_tap_kana(uint32_t keycode, enum naginata_pace pace, uint8_t kana) {
+    emit_push(keycode, true, NAGINATA_PACE_NONE, 0);
+    emit_push(keycode, false, pace, kana);
+}
+
+void naginata_emit_pause(enum naginata_pace pace) {
+    if (pace != NAGINATA_PACE_NONE) {
+        emit_push(0, false, pace, 0);
+    }
+}
+
+void naginata_emit_entry_begin(void) {
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    emit_entry_start = emit_pushed;
+    emit_entry_valid = false;
+    k_spin_unlock(&emit_lock, key);
+}
+
+void naginata_emit_entry_end(void) {
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    emit_entry_end = emit_pushed;
+    emit_entry_valid = true;
+    k_spin_unlock(&emit_lock, key);
+}
+
+uint16_t naginata_emit_cancel_entry(void) {
+    uint16_t units = 0;
+    uint16_t dropped = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    /* only while the entry is the queue's tail and not fully raised */
+    if (emit_entry_valid && emit_pushed == emit_entry_end &&
+        (int32_t)(emit_entry_end - emit_popped) > 0) {
+        /* first op to drop: the entry's first, or the one after the kana being raised */
+        uint16_t cut = 0;
+        if ((int32_t)(emit_entry_start - emit_popped) > 0) {
+            cut = (uint16_t)(emit_entry_start - emit_popped);
+        } else if (!emit_popped_unit_end) {
+            while (cut < emit_count &&
+                   !emit_ends_unit(&emit_ring[(emit_head + cut) % ARRAY_SIZE(emit_ring)])) {
+                cut++;
+            }
+            cut++;
+        }
+
+        /* drop presses and their releases; keep releases of keys pressed before the cut */
+        uint16_t kept = cut;
+        /* per priority event: dropped events it was waiting for */
+        uint16_t skipped[ARRAY_SIZE(emit_priority_ring)] = {0};
+        for (uint16_t i = cut; i < emit_count; i++) {
+            struct naginata_emit_op op = emit_ring[(emit_head + i) % ARRAY_SIZE(emit_ring)];
+            const bool drop = op.keycode == 0 || op.pressed;
+
+            if (op.keycode != 0 && op.pressed) {
+                /* the next release of the key goes with it: marked as a pause, dropped below */
+                for (uint16_t j = i + 1; j < emit_count; j++) {
+                    struct naginata_emit_op *release =
+                        &emit_ring[(emit_head + j) % ARRAY_SIZE(emit_ring)];
+                    if (!release->pressed && release->keycode == op.keycode) {
+                        release->keycode = 0;
+                        break;
+                    }
+                }
+            }
+
+            if (drop) {
+                units += op.kana;
+                for (uint16_t k = 0; k < emit_priority_count; k++) {
+                    const struct naginata_emit_priority_op *p =
+                        &emit_priority_ring[(emit_priority_head + k) %
+                                            ARRAY_SIZE(emit_priority_ring)];
+                    skipped[k] += (int32_t)(p->after - (emit_popped + i)) > 0;
+                }
+                continue;
+            }
+            op.pace = NAGINATA_PACE_NONE;
+            emit_ring[(emit_head + kept++) % ARRAY_SIZE(emit_ring)] = op;
+        }
+        if (cut < emit_count) {
+            dropped = emit_count - kept;
+            emit_count = kept;
+            emit_pushed -= dropped;
+            for (uint16_t k = 0; k < emit_priority_count; k++) {
+                emit_priority_ring[(emit_priority_head + k) % ARRAY_SIZE(emit_priority_ring)]
+                    .after -= skipped[k];
+            }
+        }
+        emit_entry_valid = false;
+    }
+    k_spin_unlock(&emit_lock, key);
+
+    if (dropped > 0) {
+        LOG_DBG("naginata emit: undo dropped %u events (%u kana)", dropped, units);
+        /* lets a packed release go out if the press it waited for was dropped */
+        emit_push(0, false, NAGINATA_PACE_NONE, 0);
+    }
+    return units;
+}
+
+void naginata_emit_priority(uint32_t keycode, bool pressed) {
+    const struct naginata_emit_op op = {
+        .keycode = keycode, .pace = NAGINATA_PACE_NONE, .kana = 0, .pressed = pressed};
+
+    k_spinlock_key_t key = k_spin_lock(&emit_lock);
+    /* full: wait, as an event sent around the lane could overtake its own press */
+    while (emit_priority_count == ARRAY_SIZE(emit_priority_ring)) {
+        k_spin_unlock(&emit_lock, key);
+        emit_wait_space();
+        key = k_spin_lock(&emit_lock);
+    }
+    struct naginata_emit_priority_op *slot =
+        &emit_priority_ring[(emit_priority_head + emit_priority_count) %
+                            ARRAY_SIZE(emit_priority_ring)];
+    slot->op = op;
+    slot->after = emit_pushed;
+    emit_priority_count++;
+    /* output after the last entry: undo erases it instead of canceling */
+    emit_entry_valid = false;
+    k_spin_unlock(&emit_lock, key);
+
+    /* cuts a pending pacing delay; the handler schedules the rest of it again */
+    k_work_reschedule(&emit_work, K_NO_WAIT);
+}
+
+void naginata_emit_submit(struct k_work *work) { k_work_submit(work); }
+
+/*
+ * Follow the IME state from every LANG1/LANG2 press: #-t/#-k, ng_on/ng_off macros, plain keys.
+ * With BLE alignment, also the connection interval of a newly selected or paired profile.
+ */
+static int naginata_emit_listener(const zmk_event_t *eh) {
+#if IS_ENABLED(CONFIG_NAGINATA_EMIT_BLE_ALIGN)
+    if (as_zmk_ble_active_profile_changed(eh) != NULL) {
+        emit_ble_refresh();
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+#endif
+
+    const struct zmk_keycode_state_changed *ev = as_zmk_keycode_state_changed(eh);
+    if (ev == NULL || !ev->state || ev->usage_page != HID_USAGE_KEY) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    if (ev->keycode == HID_USAGE_KEY_KEYBOARD_LANG1) {
+        atomic_set(&emit_ime_on, 1);
+    } else if (ev->keycode == HID_USAGE_KEY_KEYBOARD_LANG2) {
+        atomic_set(&emit_ime_on, 0);
+    }
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(naginata_emit, naginata_emit_listener);
+ZMK_SUBSCRIPTION(naginata_emit, zmk_keycode_state_changed);
+#if IS_ENABLED(CONFIG_NAGINATA_EMIT_BLE_ALIGN)
+ZMK_SUBSCRIPTION(naginata_emit, zmk_ble_active_profile_changed);
+#endif
+
+void naginata_emit_init(void) {
+    static bool started = false;
+    if (started) {
+        return;
+    }
+    started = true;
+
+    k_work_init_delayable(&emit_work, emit_work_handler);
+}
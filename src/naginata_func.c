@@ -8,6 +8,7 @@
 #include <zmk/behavior.h>
 #include <zmk/behavior_queue.h>
 #include <zmk_naginata/naginata_func.h>
+#include <zmk_naginata/naginata_emit.h>
 
 int64_t timestamp;
 
@@ -41,15 +42,13 @@ void naginata_on(void) {
 
 void nofunc() {}
 
+// Unicode入力。待ち時間は naginata_emit のキューが入れるので、ここでは k_sleep しない
+
 void switch_to_hex_input() {
     switch (naginata_config.os) {
         case NG_MACOS:
-            raise_zmk_keycode_state_changed_from_encoded(LANG2, true, timestamp);  // 未確定文字を確定する
-            raise_zmk_keycode_state_changed_from_encoded(LANG2, false, timestamp);
-            k_sleep(K_MSEC(10));
-            raise_zmk_keycode_state_changed_from_encoded(LC(F20), true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(LC(F20), false, timestamp);
-            k_sleep(K_MSEC(50));
+            naginata_emit_tap(LANG2, NAGINATA_PACE_SESSION);   // 未確定文字を確定する
+            naginata_emit_tap(LC(F20), NAGINATA_PACE_SESSION); // unicode_hex_input_switcher.json
             return;
         case NG_WINDOWS:
             return;
@@ -62,11 +61,8 @@ void switch_to_hex_input() {
 void return_to_kana_input() {
     switch (naginata_config.os) {
         case NG_MACOS:
-            raise_zmk_keycode_state_changed_from_encoded(LS(LANG1), true, timestamp);  // 未確定文字を確定する
-            raise_zmk_keycode_state_changed_from_encoded(LS(LANG1), false, timestamp);
-            k_sleep(K_MSEC(10));
-            raise_zmk_keycode_state_changed_from_encoded(LANG1, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(LANG1, false, timestamp);
+            naginata_emit_tap(LS(LANG1), NAGINATA_PACE_SESSION); // 未確定文字を確定する
+            naginata_emit_tap(LANG1, NAGINATA_PACE_NONE);
             return;
         case NG_WINDOWS:
         case NG_LINUX:
@@ -77,20 +73,15 @@ void return_to_kana_input() {
 void press_compose_key() {
     switch (naginata_config.os) {
         case NG_MACOS:
-            raise_zmk_keycode_state_changed_from_encoded(LEFT_ALT, true, timestamp);
-            k_sleep(K_MSEC(50));
+            naginata_emit_press(LEFT_ALT);
+            naginata_emit_pause(NAGINATA_PACE_SESSION);
             return;
         case NG_WINDOWS:
-            raise_zmk_keycode_state_changed_from_encoded(RIGHT_ALT, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(RIGHT_ALT, false, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(U, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(U, false, timestamp);
-            k_sleep(K_MSEC(50));
+            naginata_emit_tap(RIGHT_ALT, NAGINATA_PACE_NONE);
+            naginata_emit_tap(U, NAGINATA_PACE_SESSION);
             return;
         case NG_LINUX:
-            raise_zmk_keycode_state_changed_from_encoded(LC(LS(U)), true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(LC(LS(U)), false, timestamp);
-            k_sleep(K_MSEC(50));
+            naginata_emit_tap(LC(LS(U)), NAGINATA_PACE_SESSION);
             return;
         case NG_IOS:
     }
@@ -99,64 +90,134 @@ void press_compose_key() {
 void release_compose_key() {
     switch (naginata_config.os) {
         case NG_MACOS:
-            raise_zmk_keycode_state_changed_from_encoded(LEFT_ALT, false, timestamp);
-            k_sleep(K_MSEC(50));
+            naginata_emit_release(LEFT_ALT);
+            naginata_emit_pause(NAGINATA_PACE_SESSION);
             return;
         case NG_WINDOWS:
-            raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
-            k_sleep(K_MSEC(50));
+            naginata_emit_tap(ENTER, NAGINATA_PACE_SESSION);
             return;
         case NG_LINUX:
-            raise_zmk_keycode_state_changed_from_encoded(LC(LS(U)), true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(LC(LS(U)), false, timestamp);
-            k_sleep(K_MSEC(50));
+            naginata_emit_tap(LC(LS(U)), NAGINATA_PACE_SESSION);
             return;
         case NG_IOS:
     }
 }
 
+/*
+ * 文字列ごとに入力セッションを1回だけ開く:
+ *   macOS   Unicode Hex Input, Optionを押したまま4桁ずつ（BMP外はサロゲートペア）
+ *   Linux   Ctrl+Shift+U 16進 を続け、次の Ctrl+Shift+U が前の文字を確定する
+ *   Windows 文字ごとに 右Alt U 16進 Enter（まとめられない）
+ * Windows/Linux は最後に Enter で確定する。
+ */
+static void unicode_session_begin(void) {
+    switch_to_hex_input();
+    if (naginata_config.os == NG_MACOS) {
+        press_compose_key();
+    }
+}
+
+static void unicode_session_end(void) {
+    release_compose_key();
+    if (naginata_config.os != NG_MACOS) {
+        naginata_emit_tap(ENTER, NAGINATA_PACE_SESSION);
+    }
+    return_to_kana_input();
+}
+
+static void unicode_char_begin(bool first) {
+    if (naginata_config.os == NG_WINDOWS && !first) {
+        release_compose_key();
+    }
+    if (naginata_config.os != NG_MACOS) {
+        press_compose_key();
+    }
+}
+
+static const uint32_t hex_digit_keys[16] = {N0, N1, N2, N3, N4, N5, N6, N7,
+                                            N8, N9, A,  B,  C,  D,  E,  F};
+
+// 4桁以上の16進（先頭の0は4桁まで）
+static void unicode_tap_hex(uint32_t cp) {
+    int shift = 12;
+    while (shift < 28 && (cp >> (shift + 4)) != 0) {
+        shift += 4;
+    }
+    for (; shift >= 0; shift -= 4) {
+        naginata_emit_tap(hex_digit_keys[(cp >> shift) & 0xF], NAGINATA_PACE_HEX_DIGIT);
+    }
+}
+
+static void unicode_tap_code_point(uint32_t cp) {
+    if (naginata_config.os == NG_MACOS && cp > 0xFFFF) {
+        cp -= 0x10000;
+        unicode_tap_hex(0xD800 | (cp >> 10));
+        unicode_tap_hex(0xDC00 | (cp & 0x3FF));
+        return;
+    }
+    unicode_tap_hex(cp);
+}
+
+// UTF-8を1文字読む。終端と不正なバイト列は0
+static uint32_t utf8_next(const char **p) {
+    const unsigned char *s = (const unsigned char *)*p;
+    uint32_t cp;
+    int n;
+
+    if (s[0] == 0) {
+        return 0;
+    } else if (s[0] < 0x80) {
+        *p += 1;
+        return s[0];
+    } else if ((s[0] & 0xE0) == 0xC0) {
+        cp = s[0] & 0x1F;
+        n = 1;
+    } else if ((s[0] & 0xF0) == 0xE0) {
+        cp = s[0] & 0x0F;
+        n = 2;
+    } else if ((s[0] & 0xF8) == 0xF0) {
+        cp = s[0] & 0x07;
+        n = 3;
+    } else {
+        return 0;
+    }
+    for (int i = 1; i <= n; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    *p += n + 1;
+    return cp;
+}
+
+void input_unicode_string(const char *utf8) {
+    if (naginata_config.os == NG_IOS || *utf8 == '\0') {
+        return;
+    }
+
+    unicode_session_begin();
+    bool first = true;
+    for (uint32_t cp = utf8_next(&utf8); cp != 0; cp = utf8_next(&utf8)) {
+        unicode_char_begin(first);
+        unicode_tap_code_point(cp);
+        first = false;
+    }
+    unicode_session_end();
+}
+
 void input_unicode_hex(int n1, int n2, int n3, int n4) {
-    switch (naginata_config.os) {
-        case NG_MACOS:
-            switch_to_hex_input();
-            press_compose_key();
-            raise_zmk_keycode_state_changed_from_encoded(n1, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(n1, false, timestamp);
-            k_sleep(K_MSEC(10));
-            raise_zmk_keycode_state_changed_from_encoded(n2, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(n2, false, timestamp);
-            k_sleep(K_MSEC(10));
-            raise_zmk_keycode_state_changed_from_encoded(n3, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(n3, false, timestamp);
-            k_sleep(K_MSEC(10));
-            raise_zmk_keycode_state_changed_from_encoded(n4, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(n4, false, timestamp);
-            k_sleep(K_MSEC(10));
-            release_compose_key();
-            return_to_kana_input();
-            return;
-        case NG_WINDOWS:
-        case NG_LINUX:
-            press_compose_key();
-            raise_zmk_keycode_state_changed_from_encoded(n1, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(n1, false, timestamp);
-            k_sleep(K_MSEC(10));
-            raise_zmk_keycode_state_changed_from_encoded(n2, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(n2, false, timestamp);
-            k_sleep(K_MSEC(10));
-            raise_zmk_keycode_state_changed_from_encoded(n3, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(n3, false, timestamp);
-            k_sleep(K_MSEC(10));
-            raise_zmk_keycode_state_changed_from_encoded(n4, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(n4, false, timestamp);
-            k_sleep(K_MSEC(10));
-            release_compose_key();
-            raise_zmk_keycode_state_changed_from_encoded(ENTER, true, timestamp);
-            raise_zmk_keycode_state_changed_from_encoded(ENTER, false, timestamp);
-            return_to_kana_input();
-            return;
+    if (naginata_config.os == NG_IOS) {
+        return;
     }
+
+    unicode_session_begin();
+    unicode_char_begin(true);
+    naginata_emit_tap(n1, NAGINATA_PACE_HEX_DIGIT);
+    naginata_emit_tap(n2, NAGINATA_PACE_HEX_DIGIT);
+    naginata_emit_tap(n3, NAGINATA_PACE_HEX_DIGIT);
+    naginata_emit_tap(n4, NAGINATA_PACE_HEX_DIGIT);
+    unicode_session_end();
 }
 
 void ng_T() { ng_left(1); }
@@ -394,7 +455,6 @@ void ngh_DFI() { // {vk1Csc079}
     //raise_zmk_keycode_state_changed_from_encoded(LG(SLASH), true, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LG(SLASH), false, timestamp);
     //raise_zmk_keycode_state_changed_from_encoded(LEFT_WIN, false, timestamp);
-    uint32_t now;
     // Win(Left GUI) を押下
     //now = k_uptime_get_32();
     //raise_zmk_keycode_state_changed_from_encoded(LEFT_WIN, true, now);
@@ -0,0 +1,11 @@
+# Run two host programs (-DOLD=... -DNEW=...) and fail unless they print the same.
+execute_process(COMMAND ${OLD} OUTPUT_VARIABLE old_output RESULT_VARIABLE old_result)
+execute_process(COMMAND ${NEW} OUTPUT_VARIABLE new_output RESULT_VARIABLE new_result)
+if (NOT old_result EQUAL 0 OR NOT new_result EQUAL 0)
+  message(FATAL_ERROR "${OLD}: ${old_result}, ${NEW}: ${new_result}")
+endif()
+if (NOT old_output STREQUAL new_output)
+  file(WRITE ${NEW}.old.txt "${old_output}")
+  file(WRITE ${NEW}.new.txt "${new_output}")
+  message(FATAL_ERROR "${NEW} differs from ${OLD}: see ${NEW}.old.txt and ${NEW}.new.txt")
+endif()
@@ -0,0 +1,51 @@
+#include <zephyr/bluetooth/conn.h>
+#include <zmk/ble.h>
+
+#include "host_ble.h"
+
+/* defined by BT_CONN_CB_DEFINE in the module */
+extern const struct bt_conn_cb host_conn_cb;
+
+struct bt_conn {
+    bt_addr_le_t dst;
+    struct bt_conn_info info;
+    bool connected;
+};
+
+static struct bt_conn host_conn = {.dst = {.type = 1, .a = {1, 2, 3, 4, 5, 6}}};
+static bt_addr_le_t host_profile_addr = {.type = 1, .a = {1, 2, 3, 4, 5, 6}};
+
+uint32_t host_ble_lookups = 0;
+
+bt_addr_le_t *zmk_ble_active_profile_addr(void) { return &host_profile_addr; }
+
+const bt_addr_le_t *bt_conn_get_dst(const struct bt_conn *conn) { return &conn->dst; }
+
+struct bt_conn *bt_conn_lookup_addr_le(uint8_t id, const bt_addr_le_t *peer) {
+    (void)id;
+    host_ble_lookups++;
+    return host_conn.connected && bt_addr_le_cmp(peer, &host_conn.dst) == 0 ? &host_conn : NULL;
+}
+
+void bt_conn_unref(struct bt_conn *conn) { (void)conn; }
+
+int bt_conn_get_info(const struct bt_conn *conn, struct bt_conn_info *info) {
+    *info = conn->info;
+    return 0;
+}
+
+void host_ble_connect(uint16_t interval) {
+    host_conn.connected = true;
+    host_conn.info.le.interval = interval;
+    host_conn_cb.connected(&host_conn, 0);
+}
+
+void host_ble_param_update(uint16_t interval) {
+    host_conn.info.le.interval = interval;
+    host_conn_cb.le_param_updated(&host_conn, interval, 0, 400);
+}
+
+void host_ble_disconnect(void) {
+    host_conn.connected = false;
+    host_conn_cb.disconnected(&host_conn, 0x13);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdint.h>
+
+/* bt_conn_lookup_addr_le calls so far */
+extern uint32_t host_ble_lookups;
+
+/* The active profile's host connects, changes its connection interval, or goes away. */
+void host_ble_connect(uint16_t interval);
+void host_ble_param_update(uint16_t interval);
+void host_ble_disconnect(void);
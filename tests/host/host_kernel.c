@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <zephyr/kernel.h>
+
+struct k_work_q k_sys_work_q;
+
+static int64_t host_now_ms = 0;
+static uint64_t host_work_seq = 0;
+int64_t host_slept_ms = 0;
+
+/* work items that are submitted or scheduled, in no particular order */
+static struct k_work *host_pending[64];
+static size_t host_pending_count = 0;
+
+int64_t k_uptime_get(void) { return host_now_ms; }
+
+int32_t k_msleep(int32_t ms) {
+    if (ms > 0) {
+        host_now_ms += ms;
+        host_slept_ms += ms;
+    }
+    return 0;
+}
+
+static void host_queue(struct k_work *work, int64_t due) {
+    if (!work->pending) {
+        if (host_pending_count == ARRAY_SIZE(host_pending)) {
+            fprintf(stderr, "host work queue overflow\n");
+            exit(1);
+        }
+        host_pending[host_pending_count++] = work;
+        work->pending = true;
+    }
+    work->due = due;
+    work->seq = host_work_seq++;
+}
+
+void k_work_init(struct k_work *work, k_work_handler_t handler) {
+    *work = (struct k_work){.handler = handler};
+}
+
+void k_work_init_delayable(struct k_work_delayable *dwork, k_work_handler_t handler) {
+    k_work_init(&dwork->work, handler);
+}
+
+int k_work_submit(struct k_work *work) {
+    if (work->pending) {
+        return 0;
+    }
+    host_queue(work, host_now_ms);
+    return 1;
+}
+
+/* Like Zephyr: no effect while the item is already scheduled or queued. */
+int k_work_schedule(struct k_work_delayable *dwork, k_timeout_t delay) {
+    if (dwork->work.pending) {
+        return 0;
+    }
+    host_queue(&dwork->work, host_now_ms + delay.ms);
+    return 1;
+}
+
+int k_work_reschedule(struct k_work_delayable *dwork, k_timeout_t delay) {
+    host_queue(&dwork->work, host_now_ms + delay.ms);
+    return 1;
+}
+
+void k_sem_give(struct k_sem *sem) {
+    if (sem->count < sem->limit) {
+        sem->count++;
+    }
+}
+
+int k_sem_take(struct k_sem *sem, k_timeout_t timeout) {
+    if (sem->count > 0) {
+        sem->count--;
+        return 0;
+    }
+    /* nothing else runs while the caller waits: let the work queue run for it */
+    host_run(host_now_ms + (timeout.ms > 0 ? timeout.ms : 0));
+    if (sem->count > 0) {
+        sem->count--;
+        return 0;
+    }
+    return -EAGAIN;
+}
+
+int k_msgq_put(struct k_msgq *msgq, const void *data, k_timeout_t timeout) {
+    (void)timeout;
+    if (msgq->used == msgq->max_msgs) {
+        return -ENOMSG;
+    }
+    const uint32_t slot = (msgq->read + msgq->used) % msgq->max_msgs;
+    memcpy(&msgq->buffer[slot * msgq->msg_size], data, msgq->msg_size);
+    msgq->used++;
+    return 0;
+}
+
+int k_msgq_get(struct k_msgq *msgq, void *data, k_timeout_t timeout) {
+    (void)timeout;
+    if (msgq->used == 0) {
+        return -ENOMSG;
+    }
+    memcpy(data, &msgq->buffer[msgq->read * msgq->msg_size], msgq->msg_size);
+    msgq->read = (msgq->read + 1) % msgq->max_msgs;
+    msgq->used--;
+    return 0;
+}
+
+uint32_t k_msgq_num_used_get(struct k_msgq *msgq) { return msgq->used; }
+
+uint32_t k_msgq_num_free_get(struct k_msgq *msgq) { return msgq->max_msgs - msgq->used; }
+
+/* earliest due item, first scheduled first among equals */
+static int host_next(void) {
+    int next = -1;
+    for (size_t i = 0; i < host_pending_count; i++) {
+        const struct k_work *work = host_pending[i];
+        if (next < 0 || work->due < host_pending[next]->due ||
+            (work->due == host_pending[next]->due && work->seq < host_pending[next]->seq)) {
+            next = (int)i;
+        }
+    }
+    return next;
+}
+
+void host_run(int64_t until_ms) {
+    for (int next = host_next(); next >= 0 && host_pending[next]->due <= until_ms;
+         next = host_next()) {
+        struct k_work *work = host_pending[next];
+        host_pending[next] = host_pending[--host_pending_count];
+        work->pending = false;
+        if (work->due > host_now_ms) {
+            host_now_ms = work->due;
+        }
+        work->handler(work);
+    }
+    if (host_now_ms < until_ms) {
+        host_now_ms = until_ms;
+    }
+}
+
+void host_run_all(void) {
+    for (int next = host_next(); next >= 0; next = host_next()) {
+        host_run(host_pending[next]->due);
+    }
+}
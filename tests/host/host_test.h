@@ -0,0 +1,50 @@
+#pragma once
+
+#include <zmk/event_manager.h>
+#include <zmk_naginata/naginata_emit.h>
+
+/* One event on the host's side: raised on the event bus, or a packed release sent as a report. */
+struct host_event {
+    int64_t ms;
+    uint32_t keycode;
+    bool pressed;
+    bool packed;
+    uint32_t report; /* index of the HID report that carried it */
+};
+
+#define HOST_EVENTS_MAX 65536
+
+extern struct host_event host_events[HOST_EVENTS_MAX];
+extern size_t host_event_count;
+/* HID reports sent: one per raised event plus one per packed release report */
+extern uint32_t host_report_count;
+extern enum zmk_transport host_transport;
+/* the emitter's event listener (naginata_emit.c) */
+extern const zmk_listener_callback_t host_listener_naginata_emit;
+
+void host_reset_events(void);
+/* No key is left down on the host. */
+bool host_keys_up(void);
+/* Text the recorded presses type on a US layout (backspace erases). */
+size_t host_text(char *out, size_t size);
+
+extern int host_failures;
+void host_check(bool ok, const char *file, int line, const char *what);
+
+#define CHECK(cond) host_check((cond), __FILE__, __LINE__, #cond)
+#define CHECK_TEXT(expected) host_check_text((expected), __FILE__, __LINE__)
+void host_check_text(const char *expected, const char *file, int line);
+
+static inline uint32_t host_key(char c) {
+    return ZMK_HID_USAGE(HID_USAGE_KEY, HID_USAGE_KEY_KEYBOARD_A + c - 'a');
+}
+
+/* Queue romaji as the transform does: a vowel or the second n of "nn" ends a kana. */
+static inline void host_tap_roma(const char *roma) {
+    for (const char *p = roma; *p != '\0'; p++) {
+        const bool second_n = *p == 'n' && p > roma && p[-1] == 'n' && (p - 1 == roma || p[-2] != 'n');
+        const bool end = strchr("aiueo", *p) != NULL || second_n;
+        naginata_emit_tap_kana(host_key(*p), end ? NAGINATA_PACE_INTER_KANA : NAGINATA_PACE_INTRA_KANA,
+                               end ? 1 : 0);
+    }
+}
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <zmk/event_manager.h>
+
+#include "host_test.h"
+
+struct host_event host_events[HOST_EVENTS_MAX];
+size_t host_event_count = 0;
+uint32_t host_report_count = 0;
+
+enum zmk_transport host_transport = ZMK_TRANSPORT_USB;
+
+/* keys down in the host's report, modifiers included */
+static uint16_t host_held[16];
+static size_t host_held_count = 0;
+
+/* the module's listener, when the test links naginata_emit.c */
+extern const zmk_listener_callback_t host_listener_naginata_emit __attribute__((weak));
+
+static void host_record(uint32_t keycode, bool pressed, bool packed) {
+    if (host_event_count == ARRAY_SIZE(host_events)) {
+        fprintf(stderr, "host event log overflow\n");
+        exit(1);
+    }
+    host_events[host_event_count++] = (struct host_event){
+        .ms = k_uptime_get(),
+        .keycode = keycode,
+        .pressed = pressed,
+        .packed = packed,
+        .report = host_report_count};
+
+    const uint16_t usage = ZMK_HID_USAGE_ID(keycode);
+    for (size_t i = 0; i < host_held_count; i++) {
+        if (host_held[i] == usage) {
+            host_held[i] = host_held[--host_held_count];
+            break;
+        }
+    }
+    if (pressed && host_held_count < ARRAY_SIZE(host_held)) {
+        host_held[host_held_count++] = usage;
+    }
+}
+
+int raise_zmk_keycode_state_changed_from_encoded(uint32_t encoded, bool pressed,
+                                                 int64_t timestamp) {
+    const struct zmk_keycode_state_changed ev = {
+        .usage_page = HID_USAGE_KEY,
+        .keycode = ZMK_HID_USAGE_ID(encoded),
+        .implicit_modifiers = SELECT_MODS(encoded),
+        .state = pressed,
+        .timestamp = timestamp,
+    };
+    const zmk_event_t eh = {.type = HOST_EV_KEYCODE_STATE_CHANGED, .data = &ev};
+
+    host_record(encoded, pressed, false);
+    host_report_count++;
+    if (&host_listener_naginata_emit != NULL) {
+        host_listener_naginata_emit(&eh);
+    }
+    return 0;
+}
+
+int zmk_hid_keyboard_release(zmk_key_t key) {
+    host_record(ZMK_HID_USAGE(HID_USAGE_KEY, key), false, true);
+    return 0;
+}
+
+zmk_mod_flags_t zmk_hid_get_explicit_mods(void) {
+    zmk_mod_flags_t mods = 0;
+    for (size_t i = 0; i < host_held_count; i++) {
+        if (host_held[i] >= HID_USAGE_KEY_KEYBOARD_LEFTCONTROL &&
+            host_held[i] <= HID_USAGE_KEY_KEYBOARD_RIGHT_GUI) {
+            mods |= 1u << (host_held[i] - HID_USAGE_KEY_KEYBOARD_LEFTCONTROL);
+        }
+    }
+    return mods;
+}
+
+int zmk_endpoints_send_report(uint16_t usage_page) {
+    (void)usage_page;
+    host_report_count++;
+    return 0;
+}
+
+struct zmk_endpoint_instance zmk_endpoints_selected(void) {
+    return (struct zmk_endpoint_instance){.transport = host_transport};
+}
+
+void host_reset_events(void) {
+    host_event_count = 0;
+    host_report_count = 0;
+}
+
+bool host_keys_up(void) { return host_held_count == 0; }
+
+/* US layout, enough for romaji and the command strings */
+static char host_char(uint32_t keycode, bool shifted) {
+    static const char plain[] = "abcdefghijklmnopqrstuvwxyz1234567890\n\x1b\b\t -=[]\\#;'`,./";
+    static const char shift[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ!@#$%^&*()\n\x1b\b\t _+{}|~:\"~<>?";
+    const uint16_t usage = ZMK_HID_USAGE_ID(keycode);
+
+    if (usage < HID_USAGE_KEY_KEYBOARD_A || usage > HID_USAGE_KEY_KEYBOARD_SLASH_AND_QUESTION_MARK) {
+        return 0;
+    }
+    return (shifted ? shift : plain)[usage - HID_USAGE_KEY_KEYBOARD_A];
+}
+
+size_t host_text(char *out, size_t size) {
+    size_t len = 0;
+    int shift = 0;
+
+    for (size_t i = 0; i < host_event_count; i++) {
+        const struct host_event *ev = &host_events[i];
+        const uint16_t usage = ZMK_HID_USAGE_ID(ev->keycode);
+        if (usage == HID_USAGE_KEY_KEYBOARD_LEFTSHIFT || usage == HID_USAGE_KEY_KEYBOARD_RIGHTSHIFT) {
+            shift += ev->pressed ? 1 : -1;
+            continue;
+        }
+        if (!ev->pressed) {
+            continue;
+        }
+        const char c = host_char(ev->keycode, shift > 0 || (SELECT_MODS(ev->keycode) & MOD_LSFT));
+        if (c == '\b') {
+            len -= len > 0;
+        } else if (c != 0 && len + 1 < size) {
+            out[len++] = c;
+        }
+    }
+    out[len] = '\0';
+    return len;
+}
+
+int host_failures = 0;
+
+void host_check(bool ok, const char *file, int line, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+        host_failures++;
+    }
+}
+
+void host_check_text(const char *expected, const char *file, int line) {
+    char text[1024];
+    host_text(text, sizeof(text));
+    if (strcmp(text, expected) != 0) {
+        fprintf(stderr, "%s:%d: typed \"%s\", expected \"%s\"\n", file, line, text, expected);
+        host_failures++;
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+/*
+ * Kconfig defaults for the host tests (see Kconfig). A test can override one
+ * with -D before this header is read, e.g. -DCONFIG_NAGINATA_EMIT_BLE_ALIGN=1.
+ */
+
+#define CONFIG_NAGINATA 1
+#define CONFIG_ZMK_LOG_LEVEL 0
+#define CONFIG_KERNEL_INIT_PRIORITY_DEFAULT 40
+
+#ifndef CONFIG_NAGINATA_EMIT_QUEUE_SIZE
+#define CONFIG_NAGINATA_EMIT_QUEUE_SIZE 512
+#endif
+#ifndef CONFIG_NAGINATA_EMIT_PRIORITY_QUEUE_SIZE
+#define CONFIG_NAGINATA_EMIT_PRIORITY_QUEUE_SIZE 16
+#endif
+#ifndef CONFIG_NAGINATA_EMIT_PACK_KEYS
+#define CONFIG_NAGINATA_EMIT_PACK_KEYS 8
+#endif
+#ifndef CONFIG_NAGINATA_EMIT_PACK_HOLD_MS
+#define CONFIG_NAGINATA_EMIT_PACK_HOLD_MS 100
+#endif
+#ifndef CONFIG_NAGINATA_EMIT_BLE_REPORTS_PER_EVENT
+#define CONFIG_NAGINATA_EMIT_BLE_REPORTS_PER_EVENT 4
+#endif
+#ifndef CONFIG_NAGINATA_STROKE_QUEUE_SIZE
+#define CONFIG_NAGINATA_STROKE_QUEUE_SIZE 16
+#endif
+#ifndef CONFIG_NAGINATA_STROKE_QUEUE_TIMEOUT_MS
+#define CONFIG_NAGINATA_STROKE_QUEUE_TIMEOUT_MS 50
+#endif
+#ifndef CONFIG_NAGINATA_EMIT_STROKE_ROOM
+#define CONFIG_NAGINATA_EMIT_STROKE_ROOM 128
+#endif
+#ifndef CONFIG_NAGINATA_ROMA_INTRA_KANA_DELAY_MS
+#define CONFIG_NAGINATA_ROMA_INTRA_KANA_DELAY_MS 2
+#endif
+#ifndef CONFIG_NAGINATA_ROMA_INTER_KANA_DELAY_MS
+#define CONFIG_NAGINATA_ROMA_INTER_KANA_DELAY_MS 25
+#endif
+#ifndef CONFIG_NAGINATA_MEJIRO_REPEAT_MAX
+#define CONFIG_NAGINATA_MEJIRO_REPEAT_MAX 9
+#endif
+#ifndef CONFIG_NAGINATA_UNICODE_DIGIT_DELAY_MS
+#define CONFIG_NAGINATA_UNICODE_DIGIT_DELAY_MS 10
+#endif
+#ifndef CONFIG_NAGINATA_UNICODE_SESSION_DELAY_MS
+#define CONFIG_NAGINATA_UNICODE_SESSION_DELAY_MS 50
+#endif
+#ifndef CONFIG_NAGINATA_PACE_STEP_MS
+#define CONFIG_NAGINATA_PACE_STEP_MS 2
+#endif
+#ifndef CONFIG_NAGINATA_PACE_MAX_MS
+#define CONFIG_NAGINATA_PACE_MAX_MS 200
+#endif
+#ifndef CONFIG_NAGINATA_PACE_SAVE_DEBOUNCE_MS
+#define CONFIG_NAGINATA_PACE_SAVE_DEBOUNCE_MS 10000
+#endif
+#ifndef CONFIG_NAGINATA_MEJIRO_CACHE_SIZE
+#define CONFIG_NAGINATA_MEJIRO_CACHE_SIZE 64
+#endif
+#ifndef CONFIG_NAGINATA_MEJIRO_CACHE_KEYS
+#define CONFIG_NAGINATA_MEJIRO_CACHE_KEYS 24
+#endif
@@ -0,0 +1,148 @@
+#pragma once
+
+/*
+ * Host stand-in for the parts of the Zephyr kernel the module uses.
+ *
+ * Time only moves when a test runs the work queue (host_run) or something
+ * sleeps. Every caller is treated as the system work queue thread, which is
+ * where the module converts strokes and raises output in the firmware.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "host_config.h"
+
+/* IS_ENABLED as in zephyr/sys/util_macro.h: true when the option is defined to 1 */
+#define HOST_ENABLED_1 HOST_ENABLED_X,
+#define IS_ENABLED(option) HOST_IS_ENABLED1(option)
+#define HOST_IS_ENABLED1(value) HOST_IS_ENABLED2(HOST_ENABLED_##value)
+#define HOST_IS_ENABLED2(one_or_two_args) HOST_IS_ENABLED3(one_or_two_args 1, 0)
+#define HOST_IS_ENABLED3(ignore_this, val, ...) val
+
+#define BIT(n) (1UL << (n))
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define CLAMP(val, low, high) (((val) <= (low)) ? (low) : MIN(val, high))
+#define DIV_ROUND_UP(n, d) (((n) + (d) - 1) / (d))
+#define ARG_UNUSED(x) (void)(x)
+
+#define LOG_LEVEL_DBG 4
+#define LOG_MODULE_DECLARE(...)
+#define LOG_MODULE_REGISTER(...)
+#define LOG_DBG(...) ((void)0)
+#define LOG_INF(...) ((void)0)
+#define LOG_WRN(...) ((void)0)
+#define LOG_ERR(...) ((void)0)
+
+typedef long atomic_t;
+typedef long atomic_val_t;
+#define ATOMIC_INIT(i) (i)
+static inline atomic_val_t atomic_get(const atomic_t *target) { return *target; }
+static inline atomic_val_t atomic_set(atomic_t *target, atomic_val_t value) {
+    const atomic_val_t old = *target;
+    *target = value;
+    return old;
+}
+static inline atomic_val_t atomic_inc(atomic_t *target) { return (*target)++; }
+
+struct k_spinlock {
+    int unused;
+};
+typedef int k_spinlock_key_t;
+static inline k_spinlock_key_t k_spin_lock(struct k_spinlock *lock) {
+    (void)lock;
+    return 0;
+}
+static inline void k_spin_unlock(struct k_spinlock *lock, k_spinlock_key_t key) {
+    (void)lock;
+    (void)key;
+}
+
+typedef struct {
+    int64_t ms;
+} k_timeout_t;
+#define K_MSEC(ms) ((k_timeout_t){(int64_t)(ms)})
+#define K_SECONDS(s) K_MSEC((int64_t)(s) * 1000)
+#define K_NO_WAIT K_MSEC(0)
+#define K_FOREVER K_MSEC(-1)
+
+int64_t k_uptime_get(void);
+int32_t k_msleep(int32_t ms);
+
+struct k_work;
+typedef void (*k_work_handler_t)(struct k_work *work);
+
+struct k_work {
+    k_work_handler_t handler;
+    bool pending;
+    int64_t due;
+    uint64_t seq;
+};
+
+struct k_work_delayable {
+    struct k_work work;
+};
+
+#define K_WORK_DEFINE(name, work_handler) struct k_work name = {.handler = work_handler}
+#define K_WORK_DELAYABLE_DEFINE(name, work_handler)                                              \
+    struct k_work_delayable name = {.work = {.handler = work_handler}}
+
+void k_work_init(struct k_work *work, k_work_handler_t handler);
+void k_work_init_delayable(struct k_work_delayable *dwork, k_work_handler_t handler);
+int k_work_submit(struct k_work *work);
+int k_work_schedule(struct k_work_delayable *dwork, k_timeout_t delay);
+int k_work_reschedule(struct k_work_delayable *dwork, k_timeout_t delay);
+
+struct k_work_q {
+    int unused;
+};
+typedef int k_tid_t;
+extern struct k_work_q k_sys_work_q;
+static inline k_tid_t k_current_get(void) { return 1; }
+static inline k_tid_t k_work_queue_thread_get(struct k_work_q *queue) {
+    (void)queue;
+    return 1;
+}
+
+struct k_sem {
+    unsigned int count;
+    unsigned int limit;
+};
+#define K_SEM_DEFINE(name, initial, max) struct k_sem name = {(initial), (max)}
+void k_sem_give(struct k_sem *sem);
+int k_sem_take(struct k_sem *sem, k_timeout_t timeout);
+
+struct k_msgq {
+    size_t msg_size;
+    uint32_t max_msgs;
+    char *buffer;
+    uint32_t read;
+    uint32_t used;
+};
+#define K_MSGQ_DEFINE(name, size, count, align)                                                  \
+    static char host_msgq_buf_##name[(size) * (count)];                                         \
+    struct k_msgq name = {(size), (count), host_msgq_buf_##name, 0, 0}
+int k_msgq_put(struct k_msgq *msgq, const void *data, k_timeout_t timeout);
+int k_msgq_get(struct k_msgq *msgq, void *data, k_timeout_t timeout);
+uint32_t k_msgq_num_used_get(struct k_msgq *msgq);
+uint32_t k_msgq_num_free_get(struct k_msgq *msgq);
+
+struct device {
+    const char *name;
+    const void *config;
+    void *data;
+};
+
+#define SYS_INIT(init_fn, level, prio)
+
+/* Run queued and delayed work in due order until nothing is due by `until_ms`. */
+void host_run(int64_t until_ms);
+/* Run work until none is left, however far in the future it is due. */
+void host_run_all(void);
+/* Milliseconds slept (k_msleep) since the start, on the work queue thread by definition. */
+extern int64_t host_slept_ms;
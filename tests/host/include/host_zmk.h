@@ -0,0 +1,385 @@
+#pragma once
+
+/*
+ * Host stand-in for the ZMK APIs the module uses: keycodes, the event bus,
+ * the HID report and the endpoints. Raised events and sent reports are
+ * recorded in host_events (host_zmk.c) for the tests to check.
+ */
+
+#include "host_kernel.h"
+
+/* dt-bindings/zmk/hid_usage_pages.h, hid_usage.h, modifiers.h */
+#define HID_USAGE_KEY 0x07
+#define HID_USAGE_CONSUMER 0x0C
+
+#define ZMK_HID_USAGE(page, id) ((uint32_t)(((page) << 16) | (id)))
+#define ZMK_HID_USAGE_ID(usage) ((usage) & 0xFFFF)
+#define ZMK_HID_USAGE_PAGE(usage) (((usage) >> 16) & 0xFF)
+#define SELECT_MODS(keycode) (((keycode) >> 24) & 0xFF)
+#define APPLY_MODS(mods, keycode) ((uint32_t)(mods) << 24 | (keycode))
+
+#define MOD_LCTL 0x01
+#define MOD_LSFT 0x02
+#define MOD_LALT 0x04
+#define MOD_LGUI 0x08
+#define LC(key) APPLY_MODS(MOD_LCTL, key)
+#define LS(key) APPLY_MODS(MOD_LSFT, key)
+#define LA(key) APPLY_MODS(MOD_LALT, key)
+#define LG(key) APPLY_MODS(MOD_LGUI, key)
+
+enum {
+    HID_USAGE_KEY_KEYBOARD_A = 0x04,
+    HID_USAGE_KEY_KEYBOARD_B,
+    HID_USAGE_KEY_KEYBOARD_C,
+    HID_USAGE_KEY_KEYBOARD_D,
+    HID_USAGE_KEY_KEYBOARD_E,
+    HID_USAGE_KEY_KEYBOARD_F,
+    HID_USAGE_KEY_KEYBOARD_G,
+    HID_USAGE_KEY_KEYBOARD_H,
+    HID_USAGE_KEY_KEYBOARD_I,
+    HID_USAGE_KEY_KEYBOARD_J,
+    HID_USAGE_KEY_KEYBOARD_K,
+    HID_USAGE_KEY_KEYBOARD_L,
+    HID_USAGE_KEY_KEYBOARD_M,
+    HID_USAGE_KEY_KEYBOARD_N,
+    HID_USAGE_KEY_KEYBOARD_O,
+    HID_USAGE_KEY_KEYBOARD_P,
+    HID_USAGE_KEY_KEYBOARD_Q,
+    HID_USAGE_KEY_KEYBOARD_R,
+    HID_USAGE_KEY_KEYBOARD_S,
+    HID_USAGE_KEY_KEYBOARD_T,
+    HID_USAGE_KEY_KEYBOARD_U,
+    HID_USAGE_KEY_KEYBOARD_V,
+    HID_USAGE_KEY_KEYBOARD_W,
+    HID_USAGE_KEY_KEYBOARD_X,
+    HID_USAGE_KEY_KEYBOARD_Y,
+    HID_USAGE_KEY_KEYBOARD_Z,
+    HID_USAGE_KEY_KEYBOARD_1_AND_EXCLAMATION,
+    HID_USAGE_KEY_KEYBOARD_2_AND_AT,
+    HID_USAGE_KEY_KEYBOARD_3_AND_HASH,
+    HID_USAGE_KEY_KEYBOARD_4_AND_DOLLAR,
+    HID_USAGE_KEY_KEYBOARD_5_AND_PERCENT,
+    HID_USAGE_KEY_KEYBOARD_6_AND_CARET,
+    HID_USAGE_KEY_KEYBOARD_7_AND_AMPERSAND,
+    HID_USAGE_KEY_KEYBOARD_8_AND_ASTERISK,
+    HID_USAGE_KEY_KEYBOARD_9_AND_LEFT_PARENTHESIS,
+    HID_USAGE_KEY_KEYBOARD_0_AND_RIGHT_PARENTHESIS,
+    HID_USAGE_KEY_KEYBOARD_RETURN_ENTER,
+    HID_USAGE_KEY_KEYBOARD_ESCAPE,
+    HID_USAGE_KEY_KEYBOARD_DELETE_BACKSPACE,
+    HID_USAGE_KEY_KEYBOARD_TAB,
+    HID_USAGE_KEY_KEYBOARD_SPACEBAR,
+    HID_USAGE_KEY_KEYBOARD_MINUS_AND_UNDERSCORE,
+    HID_USAGE_KEY_KEYBOARD_EQUAL_AND_PLUS,
+    HID_USAGE_KEY_KEYBOARD_LEFT_BRACKET_AND_LEFT_BRACE,
+    HID_USAGE_KEY_KEYBOARD_RIGHT_BRACKET_AND_RIGHT_BRACE,
+    HID_USAGE_KEY_KEYBOARD_BACKSLASH_AND_PIPE,
+    HID_USAGE_KEY_KEYBOARD_NON_US_HASH_AND_TILDE,
+    HID_USAGE_KEY_KEYBOARD_SEMICOLON_AND_COLON,
+    HID_USAGE_KEY_KEYBOARD_APOSTROPHE_AND_QUOTE,
+    HID_USAGE_KEY_KEYBOARD_GRAVE_ACCENT_AND_TILDE,
+    HID_USAGE_KEY_KEYBOARD_COMMA_AND_LESS_THAN,
+    HID_USAGE_KEY_KEYBOARD_PERIOD_AND_GREATER_THAN,
+    HID_USAGE_KEY_KEYBOARD_SLASH_AND_QUESTION_MARK,
+    HID_USAGE_KEY_KEYBOARD_CAPS_LOCK,
+    HID_USAGE_KEY_KEYBOARD_F1,
+    HID_USAGE_KEY_KEYBOARD_F2,
+    HID_USAGE_KEY_KEYBOARD_F3,
+    HID_USAGE_KEY_KEYBOARD_F4,
+    HID_USAGE_KEY_KEYBOARD_F5,
+    HID_USAGE_KEY_KEYBOARD_F6,
+    HID_USAGE_KEY_KEYBOARD_F7,
+    HID_USAGE_KEY_KEYBOARD_F8,
+    HID_USAGE_KEY_KEYBOARD_F9,
+    HID_USAGE_KEY_KEYBOARD_F10,
+    HID_USAGE_KEY_KEYBOARD_F11,
+    HID_USAGE_KEY_KEYBOARD_F12,
+    HID_USAGE_KEY_KEYBOARD_PRINTSCREEN,
+    HID_USAGE_KEY_KEYBOARD_SCROLL_LOCK,
+    HID_USAGE_KEY_KEYBOARD_PAUSE,
+    HID_USAGE_KEY_KEYBOARD_INSERT,
+    HID_USAGE_KEY_KEYBOARD_HOME,
+    HID_USAGE_KEY_KEYBOARD_PAGE_UP,
+    HID_USAGE_KEY_KEYBOARD_DELETE_FORWARD,
+    HID_USAGE_KEY_KEYBOARD_END,
+    HID_USAGE_KEY_KEYBOARD_PAGE_DOWN,
+    HID_USAGE_KEY_KEYBOARD_RIGHTARROW,
+    HID_USAGE_KEY_KEYBOARD_LEFTARROW,
+    HID_USAGE_KEY_KEYBOARD_DOWNARROW,
+    HID_USAGE_KEY_KEYBOARD_UPARROW,
+    HID_USAGE_KEY_KEYBOARD_F13 = 0x68,
+    HID_USAGE_KEY_KEYBOARD_F14,
+    HID_USAGE_KEY_KEYBOARD_F15,
+    HID_USAGE_KEY_KEYBOARD_F16,
+    HID_USAGE_KEY_KEYBOARD_F17,
+    HID_USAGE_KEY_KEYBOARD_F18,
+    HID_USAGE_KEY_KEYBOARD_F19,
+    HID_USAGE_KEY_KEYBOARD_F20,
+    HID_USAGE_KEY_KEYBOARD_F21,
+    HID_USAGE_KEY_KEYBOARD_F22,
+    HID_USAGE_KEY_KEYBOARD_F23,
+    HID_USAGE_KEY_KEYBOARD_F24,
+    HID_USAGE_KEY_KEYBOARD_INTERNATIONAL1 = 0x87,
+    HID_USAGE_KEY_KEYBOARD_INTERNATIONAL2,
+    HID_USAGE_KEY_KEYBOARD_INTERNATIONAL3,
+    HID_USAGE_KEY_KEYBOARD_INTERNATIONAL4,
+    HID_USAGE_KEY_KEYBOARD_INTERNATIONAL5,
+    HID_USAGE_KEY_KEYBOARD_LANG1 = 0x90,
+    HID_USAGE_KEY_KEYBOARD_LANG2,
+    HID_USAGE_KEY_KEYBOARD_LEFTCONTROL = 0xE0,
+    HID_USAGE_KEY_KEYBOARD_LEFTSHIFT,
+    HID_USAGE_KEY_KEYBOARD_LEFTALT,
+    HID_USAGE_KEY_KEYBOARD_LEFT_GUI,
+    HID_USAGE_KEY_KEYBOARD_RIGHTCONTROL,
+    HID_USAGE_KEY_KEYBOARD_RIGHTSHIFT,
+    HID_USAGE_KEY_KEYBOARD_RIGHTALT,
+    HID_USAGE_KEY_KEYBOARD_RIGHT_GUI,
+};
+
+/* dt-bindings/zmk/keys.h */
+#define HOST_KEY(id) ZMK_HID_USAGE(HID_USAGE_KEY, HID_USAGE_KEY_KEYBOARD_##id)
+#define A HOST_KEY(A)
+#define B HOST_KEY(B)
+#define C HOST_KEY(C)
+#define D HOST_KEY(D)
+#define E HOST_KEY(E)
+#define F HOST_KEY(F)
+#define G HOST_KEY(G)
+#define H HOST_KEY(H)
+#define I HOST_KEY(I)
+#define J HOST_KEY(J)
+#define K HOST_KEY(K)
+#define L HOST_KEY(L)
+#define M HOST_KEY(M)
+#define N HOST_KEY(N)
+#define O HOST_KEY(O)
+#define P HOST_KEY(P)
+#define Q HOST_KEY(Q)
+#define R HOST_KEY(R)
+#define S HOST_KEY(S)
+#define T HOST_KEY(T)
+#define U HOST_KEY(U)
+#define V HOST_KEY(V)
+#define W HOST_KEY(W)
+#define X HOST_KEY(X)
+#define Y HOST_KEY(Y)
+#define Z HOST_KEY(Z)
+#define N1 HOST_KEY(1_AND_EXCLAMATION)
+#define N2 HOST_KEY(2_AND_AT)
+#define N3 HOST_KEY(3_AND_HASH)
+#define N4 HOST_KEY(4_AND_DOLLAR)
+#define N5 HOST_KEY(5_AND_PERCENT)
+#define N6 HOST_KEY(6_AND_CARET)
+#define N7 HOST_KEY(7_AND_AMPERSAND)
+#define N8 HOST_KEY(8_AND_ASTERISK)
+#define N9 HOST_KEY(9_AND_LEFT_PARENTHESIS)
+#define N0 HOST_KEY(0_AND_RIGHT_PARENTHESIS)
+#define ENTER HOST_KEY(RETURN_ENTER)
+#define ESC HOST_KEY(ESCAPE)
+#define BSPC HOST_KEY(DELETE_BACKSPACE)
+#define TAB HOST_KEY(TAB)
+#define SPACE HOST_KEY(SPACEBAR)
+#define MINUS HOST_KEY(MINUS_AND_UNDERSCORE)
+#define EQUAL HOST_KEY(EQUAL_AND_PLUS)
+#define LBKT HOST_KEY(LEFT_BRACKET_AND_LEFT_BRACE)
+#define RBKT HOST_KEY(RIGHT_BRACKET_AND_RIGHT_BRACE)
+#define BSLH HOST_KEY(BACKSLASH_AND_PIPE)
+#define NUHS HOST_KEY(NON_US_HASH_AND_TILDE)
+#define SEMI HOST_KEY(SEMICOLON_AND_COLON)
+#define SQT HOST_KEY(APOSTROPHE_AND_QUOTE)
+#define GRAVE HOST_KEY(GRAVE_ACCENT_AND_TILDE)
+#define COMMA HOST_KEY(COMMA_AND_LESS_THAN)
+#define DOT HOST_KEY(PERIOD_AND_GREATER_THAN)
+#define SLASH HOST_KEY(SLASH_AND_QUESTION_MARK)
+#define F1 HOST_KEY(F1)
+#define F2 HOST_KEY(F2)
+#define F3 HOST_KEY(F3)
+#define F4 HOST_KEY(F4)
+#define F5 HOST_KEY(F5)
+#define F6 HOST_KEY(F6)
+#define F7 HOST_KEY(F7)
+#define F8 HOST_KEY(F8)
+#define F9 HOST_KEY(F9)
+#define F10 HOST_KEY(F10)
+#define F11 HOST_KEY(F11)
+#define F12 HOST_KEY(F12)
+#define F13 HOST_KEY(F13)
+#define F14 HOST_KEY(F14)
+#define F15 HOST_KEY(F15)
+#define F16 HOST_KEY(F16)
+#define F17 HOST_KEY(F17)
+#define F18 HOST_KEY(F18)
+#define F19 HOST_KEY(F19)
+#define F20 HOST_KEY(F20)
+#define INS HOST_KEY(INSERT)
+#define HOME HOST_KEY(HOME)
+#define PG_UP HOST_KEY(PAGE_UP)
+#define DEL HOST_KEY(DELETE_FORWARD)
+#define END HOST_KEY(END)
+#define PG_DN HOST_KEY(PAGE_DOWN)
+#define RIGHT HOST_KEY(RIGHTARROW)
+#define LEFT HOST_KEY(LEFTARROW)
+#define DOWN HOST_KEY(DOWNARROW)
+#define UP HOST_KEY(UPARROW)
+#define INT1 HOST_KEY(INTERNATIONAL1)
+#define INT2 HOST_KEY(INTERNATIONAL2)
+#define INT3 HOST_KEY(INTERNATIONAL3)
+#define INT4 HOST_KEY(INTERNATIONAL4)
+#define INT5 HOST_KEY(INTERNATIONAL5)
+#define LANG1 HOST_KEY(LANG1)
+#define LANG2 HOST_KEY(LANG2)
+#define LCTRL HOST_KEY(LEFTCONTROL)
+#define LSHIFT HOST_KEY(LEFTSHIFT)
+#define LALT HOST_KEY(LEFTALT)
+#define LGUI HOST_KEY(LEFT_GUI)
+#define LEFT_ALT LALT
+#define RIGHT_ALT HOST_KEY(RIGHTALT)
+#define LEFT_WIN LGUI
+#define DELETE DEL
+
+typedef uint32_t zmk_key_t;
+typedef uint8_t zmk_mod_flags_t;
+
+/* zmk/event_manager.h: events are tagged with their type */
+enum host_event_type {
+    HOST_EV_KEYCODE_STATE_CHANGED,
+    HOST_EV_BLE_ACTIVE_PROFILE_CHANGED,
+};
+
+typedef struct {
+    enum host_event_type type;
+    const void *data;
+} zmk_event_t;
+
+#define ZMK_EV_EVENT_BUBBLE 0
+#define ZMK_EV_EVENT_HANDLED 1
+
+typedef int (*zmk_listener_callback_t)(const zmk_event_t *eh);
+#define ZMK_LISTENER(mod, cb) const zmk_listener_callback_t host_listener_##mod = cb
+#define ZMK_SUBSCRIPTION(mod, ev_type) extern const zmk_listener_callback_t host_listener_##mod
+
+/* zmk/events/keycode_state_changed.h */
+struct zmk_keycode_state_changed {
+    uint16_t usage_page;
+    uint32_t keycode;
+    uint8_t implicit_modifiers;
+    uint8_t explicit_modifiers;
+    bool state;
+    int64_t timestamp;
+};
+
+static inline const struct zmk_keycode_state_changed *
+as_zmk_keycode_state_changed(const zmk_event_t *eh) {
+    return eh->type == HOST_EV_KEYCODE_STATE_CHANGED ? eh->data : NULL;
+}
+
+int raise_zmk_keycode_state_changed_from_encoded(uint32_t encoded, bool pressed,
+                                                 int64_t timestamp);
+
+/* zmk/hid.h, zmk/endpoints.h */
+int zmk_hid_keyboard_release(zmk_key_t key);
+zmk_mod_flags_t zmk_hid_get_explicit_mods(void);
+int zmk_endpoints_send_report(uint16_t usage_page);
+
+enum zmk_transport {
+    ZMK_TRANSPORT_NONE,
+    ZMK_TRANSPORT_USB,
+    ZMK_TRANSPORT_BLE,
+};
+
+struct zmk_endpoint_instance {
+    enum zmk_transport transport;
+};
+
+struct zmk_endpoint_instance zmk_endpoints_selected(void);
+
+/* zmk/behavior.h, drivers/behavior.h */
+#define ZMK_BEHAVIOR_OPAQUE 0
+#define ZMK_BEHAVIOR_TRANSPARENT 1
+
+struct zmk_behavior_binding {
+    const char *behavior_dev;
+    uint32_t param1;
+    uint32_t param2;
+};
+
+struct zmk_behavior_binding_event {
+    int layer;
+    uint32_t position;
+    int64_t timestamp;
+};
+
+typedef int (*behavior_keymap_binding_callback_t)(struct zmk_behavior_binding *binding,
+                                                 struct zmk_behavior_binding_event event);
+
+struct behavior_driver_api {
+    behavior_keymap_binding_callback_t binding_pressed;
+    behavior_keymap_binding_callback_t binding_released;
+};
+
+/* One behavior instance (devicetree node 0); tests reach it through host_behavior. */
+#ifndef HOST_DT_FIRST_UP
+#define HOST_DT_FIRST_UP 0
+#endif
+#ifndef HOST_DT_ROLLOVER
+#define HOST_DT_ROLLOVER 0
+#endif
+#define DT_INST_FOREACH_STATUS_OKAY(fn) fn(0)
+#define DT_INST_PROP_OR(inst, prop, default_value) (default_value)
+#define DT_INST_PROP(inst, prop) DT_INST_PROP_##prop
+#define DT_INST_PROP_first_up HOST_DT_FIRST_UP
+#define DT_INST_PROP_rollover HOST_DT_ROLLOVER
+#define BEHAVIOR_DT_INST_DEFINE(inst, init_fn, pm, data_ptr, cfg_ptr, level, prio, api_ptr)      \
+    const struct device host_behavior = {.name = "naginata", .config = cfg_ptr};                 \
+    int (*const host_behavior_init)(const struct device *dev) = init_fn;                         \
+    const struct behavior_driver_api *const host_behavior_api = api_ptr
+
+/* zmk/ble.h, zmk/events/ble_active_profile_changed.h */
+typedef struct {
+    uint8_t type;
+    uint8_t a[6];
+} bt_addr_le_t;
+
+struct zmk_ble_active_profile_changed {
+    uint8_t index;
+};
+
+static inline const struct zmk_ble_active_profile_changed *
+as_zmk_ble_active_profile_changed(const zmk_event_t *eh) {
+    return eh->type == HOST_EV_BLE_ACTIVE_PROFILE_CHANGED ? eh->data : NULL;
+}
+
+bt_addr_le_t *zmk_ble_active_profile_addr(void);
+
+/* zephyr/bluetooth/conn.h */
+#define BT_ID_DEFAULT 0
+
+struct bt_conn;
+
+struct bt_conn_le_info {
+    uint16_t interval;
+    uint16_t latency;
+    uint16_t timeout;
+};
+
+struct bt_conn_info {
+    struct bt_conn_le_info le;
+};
+
+struct bt_conn_cb {
+    void (*connected)(struct bt_conn *conn, uint8_t err);
+    void (*disconnected)(struct bt_conn *conn, uint8_t reason);
+    void (*le_param_updated)(struct bt_conn *conn, uint16_t interval, uint16_t latency,
+                             uint16_t timeout);
+};
+
+#define BT_CONN_CB_DEFINE(name) const struct bt_conn_cb host_conn_cb
+
+static inline int bt_addr_le_cmp(const bt_addr_le_t *a, const bt_addr_le_t *b) {
+    return memcmp(a, b, sizeof(*a));
+}
+
+const bt_addr_le_t *bt_conn_get_dst(const struct bt_conn *conn);
+struct bt_conn *bt_conn_lookup_addr_le(uint8_t id, const bt_addr_le_t *peer);
+void bt_conn_unref(struct bt_conn *conn);
+int bt_conn_get_info(const struct bt_conn *conn, struct bt_conn_info *info);
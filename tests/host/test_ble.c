@@ -0,0 +1,185 @@
+/*
+ * BLE connection-event model for the emitter (CONFIG_NAGINATA_EMIT_BLE_ALIGN).
+ *
+ * The host gets the reports once per connection event, at most
+ * CONFIG_NAGINATA_EMIT_BLE_REPORTS_PER_EVENT of them per event. A stroke
+ * corpus is typed with the alignment off (output over USB, so the emitter
+ * does not see the link) and on, at a few connection intervals, and the
+ * reports are put into connection events. Peripheral latency lets the link
+ * skip events that carry nothing, so the radio is on for the events with
+ * reports only: MODEL_EVENT_US each plus MODEL_REPORT_US per report.
+ *
+ * Prints connection events, reports per stroke, radio-on time and how long
+ * the output took, and checks that the interval is cached (no connection
+ * lookup per event) and that aligned output never puts two kana in one event.
+ */
+#include <stdio.h>
+
+#include "host_ble.h"
+#include "host_test.h"
+
+#define STROKE_MS 120
+#define MODEL_EVENT_US 500
+#define MODEL_REPORT_US 150
+
+static const char *const corpus[] = {
+    "kyou", "ha",  "ii",     "tennki", "desu",  "ne",   "mejiro", "shiki", "de",     "nihonngo",
+    "wo",   "kai", "te",     "imasu",  "kono",  "bunn", "mo",     "sou",   "shite",  "utta",
+    "mono", "da",  "hayaku", "utsu",   "tame",  "ni",   "renn",   "shuu",  "shimasu", "yo",
+};
+
+struct model_result {
+    uint32_t events;  /* connection events that carry reports */
+    uint32_t reports;
+    uint32_t strokes;
+    uint32_t collapsed; /* kana that arrived in the same event as the kana before them */
+    int64_t radio_us;
+    int64_t end_ms; /* last connection event with a report, after the first stroke */
+};
+
+/* the kana that the press of usage starts, given the previous press */
+static bool starts_kana(char c, char prev) {
+    return prev == 0 || strchr("aiueo", prev) != NULL || (prev == 'n' && c != 'n' && c != 'y' &&
+                                                          strchr("aiueo", c) == NULL);
+}
+
+static struct model_result model_run(enum zmk_transport transport, uint16_t interval, char *text,
+                                     size_t text_size) {
+    struct model_result res = {0};
+    const int64_t interval_us = (int64_t)interval * 1250;
+
+    host_run_all();
+    host_reset_events();
+    host_transport = transport;
+
+    /* connection events at t0 + k * interval */
+    const int64_t t0 = k_uptime_get();
+    for (size_t i = 0; i < 3 * ARRAY_SIZE(corpus); i++) {
+        host_run(t0 + (int64_t)i * STROKE_MS);
+        host_tap_roma(corpus[i % ARRAY_SIZE(corpus)]);
+        res.strokes++;
+    }
+    host_run_all();
+    host_text(text, text_size);
+
+    int64_t slot = -1;
+    uint32_t slot_reports = 0;
+    int64_t kana_slot = -1;
+    char prev = 0;
+    for (size_t i = 0; i < host_event_count; i++) {
+        const struct host_event *ev = &host_events[i];
+        const bool new_report = i == 0 || ev->report != host_events[i - 1].report;
+        if (new_report) {
+            const int64_t due = DIV_ROUND_UP((ev->ms - t0) * 1000, interval_us);
+            if (due > slot) {
+                slot = due;
+                slot_reports = 0;
+                res.events++;
+                res.radio_us += MODEL_EVENT_US;
+            } else if (slot_reports == CONFIG_NAGINATA_EMIT_BLE_REPORTS_PER_EVENT) {
+                slot++;
+                slot_reports = 0;
+                res.events++;
+                res.radio_us += MODEL_EVENT_US;
+            }
+            slot_reports++;
+            res.reports++;
+            res.radio_us += MODEL_REPORT_US;
+        }
+        if (ev->pressed) {
+            const char c = (char)('a' + ZMK_HID_USAGE_ID(ev->keycode) - HID_USAGE_KEY_KEYBOARD_A);
+            if (starts_kana(c, prev)) {
+                res.collapsed += slot == kana_slot;
+                kana_slot = slot;
+            }
+            prev = c;
+        }
+    }
+    res.end_ms = slot * interval_us / 1000;
+    return res;
+}
+
+static void print_result(const char *mode, uint16_t interval, const struct model_result *res) {
+    printf("%-7s %5.2f ms  %5u events  %5.2f reports/stroke  %5.2f reports/event  radio %6.1f ms"
+           "  %2u kana sharing an event  done at %5lld ms\n",
+           mode, interval * 1.25, res->events, (double)res->reports / res->strokes,
+           (double)res->reports / res->events, res->radio_us / 1000.0, res->collapsed,
+           (long long)res->end_ms);
+}
+
+static void test_model(uint16_t interval) {
+    static char plain_text[2048];
+    static char aligned_text[2048];
+
+    host_ble_param_update(interval);
+    const uint32_t lookups = host_ble_lookups;
+    const struct model_result plain =
+        model_run(ZMK_TRANSPORT_USB, interval, plain_text, sizeof(plain_text));
+    const struct model_result aligned =
+        model_run(ZMK_TRANSPORT_BLE, interval, aligned_text, sizeof(aligned_text));
+    print_result("plain", interval, &plain);
+    print_result("aligned", interval, &aligned);
+
+    CHECK(strcmp(plain_text, aligned_text) == 0);
+    CHECK(host_keys_up());
+    /* the interval comes from the callbacks, not from a lookup per event */
+    CHECK(host_ble_lookups == lookups);
+    CHECK(aligned.events <= plain.events);
+    CHECK(aligned.radio_us <= plain.radio_us);
+    CHECK(aligned.collapsed == 0);
+}
+
+/* The intra-kana pace as seen by the host: from the press of k to the press of a. */
+static int64_t intra_kana_gap(void) {
+    host_run_all();
+    host_reset_events();
+    host_tap_roma("ka");
+    host_run_all();
+    return host_events[1].ms - host_events[0].ms;
+}
+
+static void test_interval_tracking(void) {
+    const struct zmk_ble_active_profile_changed changed = {.index = 1};
+    const zmk_event_t eh = {.type = HOST_EV_BLE_ACTIVE_PROFILE_CHANGED, .data = &changed};
+    const int64_t intra = CONFIG_NAGINATA_ROMA_INTRA_KANA_DELAY_MS;
+
+    host_transport = ZMK_TRANSPORT_BLE;
+
+    /* not connected: the Kconfig pace, unaligned */
+    CHECK(intra_kana_gap() == intra);
+
+    /* one lookup at connection: 30 ms, so the 2 ms intra-kana pace is dropped */
+    host_ble_connect(24);
+    CHECK(host_ble_lookups == 1);
+    CHECK(intra_kana_gap() == 0);
+
+    /* a profile switch looks the host up once more */
+    host_listener_naginata_emit(&eh);
+    CHECK(host_ble_lookups == 2);
+
+    /* the interval follows a parameter update: 2.5 ms rounds the 2 ms pace up */
+    host_ble_param_update(2);
+    CHECK(intra_kana_gap() == 3);
+    CHECK(host_ble_lookups == 2);
+
+    /* gone: the Kconfig pace again */
+    host_ble_disconnect();
+    CHECK(intra_kana_gap() == intra);
+    host_ble_connect(24);
+}
+
+int main(void) {
+    naginata_emit_init();
+
+    test_interval_tracking();
+    test_model(6);  /* 7.5 ms */
+    test_model(12); /* 15 ms */
+    test_model(24); /* 30 ms */
+
+    if (host_failures > 0) {
+        fprintf(stderr, "test_ble: %d failed\n", host_failures);
+        return 1;
+    }
+    printf("test_ble: ok\n");
+    return 0;
+}
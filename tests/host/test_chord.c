@@ -0,0 +1,256 @@
+/*
+ * Chord finalization replays (user-006, user-007).
+ *
+ * Press/release timelines of a stroke corpus go through the behavior's
+ * binding callbacks (host_behavior_api) as the keymap calls them, with
+ * behavior_naginata_init run again for each mode: last-up (the default),
+ * first-up, and first-up with rollover. The timelines are generated with a
+ * fixed seed and the shape of fast steno typing: a few milliseconds between
+ * the presses of a chord, a hold, then the keys lifted one by one over up to
+ * ~50 ms.
+ *
+ * Latency (user-006): the strokes typed apart. For each stroke, the time from
+ * its first release to the first key the host gets is printed per mode;
+ * first-up has to type the same text and be faster by the release spread.
+ *
+ * Throughput (user-007): the next chord is pressed 5-20 ms after the first
+ * release of the one before, while its other keys are still down. Rollover
+ * has to type the same text as the strokes typed apart; the strokes per
+ * second of both timelines are printed. Last-up merges the chords and first-up
+ * drops the early presses, so they type something else.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "behaviors/behavior_naginata.c"
+
+#include "host_test.h"
+
+#define KEYS_PER_CHORD 4
+#define TRACE_MAX 1024
+
+static const char *const corpus[] = {
+    "sfc", "ws", "sf", "aw", "df", "er", "dfg", "sr", "wr", "dr",
+    "sf",  "df", "ws", "er", "sfc", "dr", "aw", "wr", "dfg", "sr",
+};
+
+struct key_event {
+    int64_t ms;
+    char key;
+    bool pressed;
+};
+
+struct trace {
+    struct key_event ev[TRACE_MAX];
+    size_t count;
+    int64_t first_release[ARRAY_SIZE(corpus)];
+};
+
+enum pacing {
+    TYPED_APART, /* next chord a while after every key is up */
+    ROLLED,      /* next chord right after the first release */
+};
+
+static uint32_t seed;
+
+static int64_t rand_ms(int64_t lo, int64_t hi) {
+    seed = seed * 1103515245u + 12345u;
+    return lo + (int64_t)((seed >> 16) % (uint32_t)(hi - lo + 1));
+}
+
+static void trace_add(struct trace *t, int64_t ms, char key, bool pressed) {
+    t->ev[t->count++] = (struct key_event){.ms = ms, .key = key, .pressed = pressed};
+}
+
+static int trace_cmp(const void *a, const void *b) {
+    const struct key_event *x = a;
+    const struct key_event *y = b;
+    return x->ms != y->ms ? (x->ms < y->ms ? -1 : 1) : (int)x->pressed - (int)y->pressed;
+}
+
+static void trace_build(struct trace *t, enum pacing pacing, int64_t gap_lo, int64_t gap_hi) {
+    int64_t up_at[128] = {0}; /* when each key was last released */
+    int64_t start = 100;
+
+    seed = 2026;
+    t->count = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(corpus); i++) {
+        const char *chord = corpus[i];
+        const size_t n = strlen(chord);
+        int64_t down[KEYS_PER_CHORD];
+        int64_t peak = 0;
+
+        for (size_t k = 0; k < n; k++) {
+            /* a key still down from the chord before is pressed again only after it is up */
+            down[k] = MAX(start + rand_ms(0, 12), up_at[(int)chord[k]] + 5);
+            peak = MAX(peak, down[k]);
+        }
+        const int64_t first_up = peak + rand_ms(30, 60);
+        int64_t last_up = first_up;
+        for (size_t k = 0; k < n; k++) {
+            const int64_t up = k == 0 ? first_up : first_up + rand_ms(5, 50);
+            trace_add(t, down[k], chord[k], true);
+            trace_add(t, up, chord[k], false);
+            up_at[(int)chord[k]] = up;
+            last_up = MAX(last_up, up);
+        }
+        t->first_release[i] = first_up;
+        start = (pacing == ROLLED ? first_up : last_up) + rand_ms(gap_lo, gap_hi);
+    }
+    qsort(t->ev, t->count, sizeof(t->ev[0]), trace_cmp);
+}
+
+static uint32_t keycode_for(char c) {
+    switch (c) {
+    case ';': return SEMI;
+    case ',': return COMMA;
+    case '.': return DOT;
+    case '/': return SLASH;
+    default: return host_key(c);
+    }
+}
+
+static void mode_set(bool first_up, bool rollover) {
+    static struct behavior_naginata_config cfg;
+    static struct device dev;
+
+    cfg = behavior_naginata_config_0;
+    cfg.first_up = first_up;
+    cfg.rollover = rollover;
+    dev = host_behavior;
+    dev.config = &cfg;
+
+    host_run_all();
+    behavior_naginata_init(&dev);
+    g_mejiro_history_count = 0;
+    host_reset_events();
+}
+
+/* Replay the timeline at its own times; the text the host typed goes to text. */
+static void replay(const struct trace *t, char *text, size_t text_size) {
+    const int64_t t0 = k_uptime_get();
+
+    for (size_t i = 0; i < t->count; i++) {
+        const struct key_event *e = &t->ev[i];
+        struct zmk_behavior_binding binding = {.behavior_dev = "naginata",
+                                               .param1 = keycode_for(e->key)};
+        const struct zmk_behavior_binding_event event = {.position = (uint32_t)e->key,
+                                                         .timestamp = t0 + e->ms};
+        host_run(t0 + e->ms);
+        if (e->pressed) {
+            host_behavior_api->binding_pressed(&binding, event);
+        } else {
+            host_behavior_api->binding_released(&binding, event);
+        }
+    }
+    host_run_all();
+    host_text(text, text_size);
+    CHECK(host_keys_up());
+    CHECK(committed_keys == 0UL && pressed_keys == 0UL);
+}
+
+/* Per stroke typed apart, first release to the first key the host got for it. */
+static void latencies(const struct trace *t, int64_t t0, int64_t *out) {
+    size_t e = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(corpus); i++) {
+        while (e < host_event_count && host_events[e].ms < t0 + t->first_release[i]) {
+            e++;
+        }
+        out[i] = e < host_event_count ? host_events[e].ms - (t0 + t->first_release[i]) : -1;
+    }
+}
+
+static void test_latency(void) {
+    static struct trace t;
+    static char last_text[512];
+    static char first_text[512];
+    int64_t last_lat[ARRAY_SIZE(corpus)];
+    int64_t first_lat[ARRAY_SIZE(corpus)];
+
+    /* far enough apart that a stroke's output is done before the next one starts */
+    trace_build(&t, TYPED_APART, 200, 300);
+
+    mode_set(false, false);
+    int64_t t0 = k_uptime_get();
+    replay(&t, last_text, sizeof(last_text));
+    latencies(&t, t0, last_lat);
+
+    mode_set(true, false);
+    t0 = k_uptime_get();
+    replay(&t, first_text, sizeof(first_text));
+    latencies(&t, t0, first_lat);
+
+    CHECK(strcmp(last_text, first_text) == 0);
+    int64_t last_sum = 0, first_sum = 0, last_max = 0, first_max = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(corpus); i++) {
+        CHECK(last_lat[i] >= 0 && first_lat[i] >= 0);
+        CHECK(first_lat[i] <= last_lat[i]);
+        last_sum += last_lat[i];
+        first_sum += first_lat[i];
+        last_max = MAX(last_max, last_lat[i]);
+        first_max = MAX(first_max, first_lat[i]);
+    }
+    CHECK(first_sum < last_sum);
+    printf("latency, first release to output: last-up %.1f ms (max %lld), first-up %.1f ms "
+           "(max %lld), %.1f ms less\n",
+           (double)last_sum / ARRAY_SIZE(corpus), (long long)last_max,
+           (double)first_sum / ARRAY_SIZE(corpus), (long long)first_max,
+           (double)(last_sum - first_sum) / ARRAY_SIZE(corpus));
+}
+
+static double strokes_per_s(const struct trace *t) {
+    return ARRAY_SIZE(corpus) * 1000.0 / (double)(t->ev[t->count - 1].ms - t->ev[0].ms);
+}
+
+static void test_throughput(void) {
+    static struct trace apart;
+    static struct trace rolled;
+    static char want[512];
+    static char text[512];
+
+    /* typed apart as fast as last-up allows: the next chord soon after every key is up */
+    trace_build(&apart, TYPED_APART, 5, 20);
+    trace_build(&rolled, ROLLED, 5, 20);
+
+    mode_set(false, false);
+    replay(&apart, want, sizeof(want));
+
+    mode_set(true, true);
+    replay(&rolled, text, sizeof(text));
+    CHECK(strcmp(text, want) == 0);
+    CHECK(strokes_per_s(&rolled) > strokes_per_s(&apart));
+    printf("throughput: apart %.2f strokes/s, rolled with rollover %.2f strokes/s (%+.0f%%)\n",
+           strokes_per_s(&apart), strokes_per_s(&rolled),
+           100.0 * (strokes_per_s(&rolled) / strokes_per_s(&apart) - 1.0));
+
+    /* the rolled timeline needs rollover */
+    mode_set(false, false);
+    replay(&rolled, text, sizeof(text));
+    CHECK(strcmp(text, want) != 0);
+    mode_set(true, false);
+    replay(&rolled, text, sizeof(text));
+    CHECK(strcmp(text, want) != 0);
+}
+
+static void test_config(void) {
+    /* rollover without first-up is ignored */
+    mode_set(false, true);
+    CHECK(!first_up_mode && !rollover_mode);
+    mode_set(true, true);
+    CHECK(first_up_mode && rollover_mode);
+}
+
+int main(void) {
+    host_behavior_init(&host_behavior);
+
+    test_config();
+    test_latency();
+    test_throughput();
+
+    if (host_failures > 0) {
+        fprintf(stderr, "test_chord: %d failed\n", host_failures);
+        return 1;
+    }
+    printf("test_chord: ok\n");
+    return 0;
+}
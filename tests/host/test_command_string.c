@@ -0,0 +1,157 @@
+/*
+ * String commands, Shift held across runs (user-020).
+ *
+ * Built twice: against the last release (MEJIRO_TRANSFORM_OLD,
+ * behaviors/latestOKw36_262_20260413behavior_naginata.c), where every shifted
+ * character was its own Shift press and release, and against the current
+ * code. Each program sends every MJ_CMD_STRING entry of its table with
+ * send_mejiro_command_string and prints the keys the host typed (usage, and
+ * + when Shift was down) and how many events it took.
+ *
+ * The current build runs the old one (its path is the argument) and checks,
+ * entry by entry, that the host typed the same keys with no more events, and
+ * with fewer events in total. Shift is released at the end of every entry.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <zmk_naginata/mejiro_stroke.h>
+
+#ifdef MEJIRO_TRANSFORM_OLD
+/* the last release as it shipped, unused helpers and all */
+#pragma GCC diagnostic ignored "-Wunused-function"
+#include "behaviors/latestOKw36_262_20260413behavior_naginata.c"
+#else
+#include "behaviors/behavior_naginata.c"
+#endif
+
+#include "host_test.h"
+
+#define LINE_MAX_LEN 512
+
+/* "34+ 26+ 50": each key the host typed, + when Shift was down */
+static void typed_keys(char *out, size_t size) {
+    int shift = 0;
+    size_t len = 0;
+
+    out[0] = '\0';
+    for (size_t i = 0; i < host_event_count && len + 8 < size; i++) {
+        const struct host_event *ev = &host_events[i];
+        const uint16_t usage = ZMK_HID_USAGE_ID(ev->keycode);
+        if (usage == HID_USAGE_KEY_KEYBOARD_LEFTSHIFT || usage == HID_USAGE_KEY_KEYBOARD_RIGHTSHIFT) {
+            shift += ev->pressed ? 1 : -1;
+            continue;
+        }
+        if (ev->pressed) {
+            const bool shifted = shift > 0 || (SELECT_MODS(ev->keycode) & MOD_LSFT);
+            len += (size_t)snprintf(out + len, size - len, "%s%02x%s", len > 0 ? " " : "", usage,
+                                    shifted ? "+" : "");
+        }
+    }
+}
+
+/* One line per entry: stroke, events, keys typed. */
+static void print_entries(FILE *out) {
+    char keys[LINE_MAX_LEN];
+
+    for (size_t i = 0; i < ARRAY_SIZE(mejiro_commands_zmk); i++) {
+        const mj_cmd_t *cmd = &mejiro_commands_zmk[i];
+        if (cmd->kind != MJ_CMD_STRING || cmd->string == NULL) {
+            continue;
+        }
+        host_run_all();
+        host_reset_events();
+        send_mejiro_command_string(cmd->string);
+        host_run_all();
+        typed_keys(keys, sizeof(keys));
+        fprintf(out, "%s\t%zu\t%s\t%d\n", cmd->stroke, host_event_count, keys, host_keys_up());
+    }
+}
+
+#ifdef MEJIRO_TRANSFORM_OLD
+
+int main(void) {
+    print_entries(stdout);
+    return 0;
+}
+
+#else
+
+static bool split_line(char *line, char **stroke, size_t *events, char **keys, int *keys_up) {
+    char *save = NULL;
+    line[strcspn(line, "\n")] = '\0';
+    *stroke = strtok_r(line, "\t", &save);
+    const char *count = strtok_r(NULL, "\t", &save);
+    *keys = strtok_r(NULL, "\t", &save);
+    const char *up = strtok_r(NULL, "\t", &save);
+    if (*stroke == NULL || count == NULL || *keys == NULL || up == NULL) {
+        return false;
+    }
+    *events = strtoul(count, NULL, 10);
+    *keys_up = atoi(up);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    mejiro_tables_init();
+    naginata_emit_init();
+
+    if (argc < 2) {
+        print_entries(stdout);
+        return 0;
+    }
+
+    char cmdline[LINE_MAX_LEN];
+    snprintf(cmdline, sizeof(cmdline), "'%s'", argv[1]);
+    FILE *old = popen(cmdline, "r");
+    FILE *cur = tmpfile();
+    if (old == NULL || cur == NULL) {
+        fprintf(stderr, "test_command_string: cannot run %s\n", argv[1]);
+        return 1;
+    }
+    print_entries(cur);
+    rewind(cur);
+
+    char old_line[LINE_MAX_LEN];
+    char cur_line[LINE_MAX_LEN];
+    size_t entries = 0;
+    size_t old_total = 0;
+    size_t cur_total = 0;
+    while (fgets(cur_line, sizeof(cur_line), cur) != NULL) {
+        char *cur_stroke, *cur_keys, *old_stroke, *old_keys;
+        size_t cur_events, old_events;
+        int cur_up, old_up;
+
+        CHECK(fgets(old_line, sizeof(old_line), old) != NULL);
+        if (!split_line(cur_line, &cur_stroke, &cur_events, &cur_keys, &cur_up) ||
+            !split_line(old_line, &old_stroke, &old_events, &old_keys, &old_up)) {
+            CHECK(!"malformed line");
+            break;
+        }
+        if (strcmp(cur_stroke, old_stroke) != 0 || strcmp(cur_keys, old_keys) != 0) {
+            fprintf(stderr, "%s: typed %s, the last release %s (%s)\n", cur_stroke, cur_keys,
+                    old_keys, old_stroke);
+            host_failures++;
+        }
+        CHECK(cur_events <= old_events);
+        CHECK(cur_up && old_up);
+        entries++;
+        old_total += old_events;
+        cur_total += cur_events;
+    }
+    CHECK(fgets(old_line, sizeof(old_line), old) == NULL);
+    CHECK(pclose(old) == 0);
+    CHECK(entries > 0);
+    CHECK(cur_total < old_total);
+    printf("%zu string commands: %zu events, %zu in the last release (%.1f%% fewer)\n", entries,
+           cur_total, old_total, old_total > 0 ? 100.0 * (old_total - cur_total) / old_total : 0.0);
+
+    if (host_failures > 0) {
+        fprintf(stderr, "test_command_string: %d failed\n", host_failures);
+        return 1;
+    }
+    printf("test_command_string: ok\n");
+    return 0;
+}
+
+#endif
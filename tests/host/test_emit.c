@@ -0,0 +1,232 @@
+/*
+ * Emitter sequences (src/naginata_emit.c): report packing, undo of queued
+ * kana and the priority lane, checked on the events the host receives.
+ */
+#include <stdio.h>
+
+#include <zmk_naginata/naginata_emit.h>
+
+#include "host_test.h"
+
+/* the emitter's own count of synthesized reports */
+uint32_t naginata_emit_report_count(void);
+
+static void start(void) {
+    host_run_all();
+    host_reset_events();
+}
+
+static size_t count_events(uint32_t keycode, bool pressed, bool packed) {
+    size_t n = 0;
+    for (size_t i = 0; i < host_event_count; i++) {
+        n += host_events[i].keycode == keycode && host_events[i].pressed == pressed &&
+             host_events[i].packed == packed;
+    }
+    return n;
+}
+
+/* user-019: presses keep their own reports, releases of a run share one */
+static void test_pack_run(void) {
+    start();
+    host_tap_roma("kyo");
+    host_run_all();
+    CHECK_TEXT("kyo");
+    CHECK(host_keys_up());
+    CHECK(host_report_count == 4);
+    CHECK(count_events(host_key('k'), false, true) == 1);
+    CHECK(count_events(host_key('o'), false, true) == 1);
+}
+
+/* user-019: the same key twice in a row is released in between */
+static void test_pack_repeat(void) {
+    start();
+    host_tap_roma("kka");
+    host_run_all();
+    CHECK_TEXT("kka");
+    CHECK(host_keys_up());
+    CHECK(host_events[1].keycode == host_key('k') && !host_events[1].pressed);
+    CHECK(host_events[2].keycode == host_key('k') && host_events[2].pressed);
+}
+
+/* user-019: nothing is packed while an explicit modifier is down */
+static void test_pack_explicit_mod(void) {
+    const uint32_t lshift = ZMK_HID_USAGE(HID_USAGE_KEY, HID_USAGE_KEY_KEYBOARD_LEFTSHIFT);
+
+    start();
+    naginata_emit_press(lshift);
+    host_tap_roma("ka");
+    naginata_emit_release(lshift);
+    host_run_all();
+    CHECK_TEXT("KA");
+    CHECK(host_keys_up());
+    for (size_t i = 0; i < host_event_count; i++) {
+        CHECK(!host_events[i].packed);
+    }
+    CHECK(host_report_count == 6);
+    CHECK(naginata_emit_report_count() > 0);
+}
+
+/* user-022: undo drops the kana that have not started and counts them */
+static void test_cancel_unsent(void) {
+    start();
+    naginata_emit_entry_begin();
+    host_tap_roma("kannji");
+    naginata_emit_entry_end();
+    /* k, a and the pace after a */
+    host_run(k_uptime_get() + CONFIG_NAGINATA_ROMA_INTRA_KANA_DELAY_MS);
+    CHECK_TEXT("ka");
+    CHECK(naginata_emit_cancel_entry() == 2);
+    host_run_all();
+    CHECK_TEXT("ka");
+    CHECK(host_keys_up());
+}
+
+/* user-022: a kana that has started is finished, and ん is one unit */
+static void test_cancel_started(void) {
+    start();
+    naginata_emit_entry_begin();
+    host_tap_roma("kannji");
+    naginata_emit_entry_end();
+    /* up to the first n of ん */
+    while (host_event_count < 5) {
+        host_run(k_uptime_get() + 1);
+    }
+    CHECK(naginata_emit_cancel_entry() == 1);
+    host_run_all();
+    CHECK_TEXT("kann");
+    CHECK(host_keys_up());
+}
+
+/* user-022: an entry that has not started at all is dropped whole */
+static void test_cancel_whole(void) {
+    start();
+    host_tap_roma("a");
+    naginata_emit_entry_begin();
+    host_tap_roma("shi");
+    naginata_emit_entry_end();
+    CHECK(naginata_emit_cancel_entry() == 1);
+    host_run_all();
+    CHECK_TEXT("a");
+    /* the entry is gone: a second cancel does nothing */
+    CHECK(naginata_emit_cancel_entry() == 0);
+}
+
+/* user-022: every dropped press takes its release along, however many keys are down */
+static void test_cancel_many_held(void) {
+    const char keys[] = "bcdfghjklmpqrst";
+
+    start();
+    host_tap_roma("a");
+    naginata_emit_entry_begin();
+    for (const char *k = keys; *k != '\0'; k++) {
+        naginata_emit_press(host_key(*k));
+    }
+    for (const char *k = keys; *k != '\0'; k++) {
+        naginata_emit_release(host_key(*k));
+    }
+    naginata_emit_entry_end();
+    naginata_emit_cancel_entry();
+    host_run_all();
+    CHECK_TEXT("a");
+    CHECK(host_keys_up());
+}
+
+/* user-024: priority events skip the pacing of the events before them, in order */
+static void test_priority_order(void) {
+    const uint32_t left = ZMK_HID_USAGE(HID_USAGE_KEY, HID_USAGE_KEY_KEYBOARD_LEFTARROW);
+
+    start();
+    host_tap_roma("ka");
+    /* more than the lane holds: the caller waits instead of sending around it */
+    for (int i = 0; i < CONFIG_NAGINATA_EMIT_PRIORITY_QUEUE_SIZE; i++) {
+        naginata_emit_priority(left, true);
+        naginata_emit_priority(left, false);
+    }
+    host_tap_roma("i");
+    host_run_all();
+    CHECK_TEXT("kai");
+    CHECK(host_keys_up());
+    CHECK(count_events(left, true, false) == CONFIG_NAGINATA_EMIT_PRIORITY_QUEUE_SIZE);
+
+    bool down = false;
+    size_t last_a = 0, first_left = host_event_count, last_left = 0, first_i = host_event_count;
+    for (size_t i = 0; i < host_event_count; i++) {
+        const struct host_event *ev = &host_events[i];
+        if (ev->keycode == left) {
+            CHECK(ev->pressed != down);
+            down = ev->pressed;
+            first_left = MIN(first_left, i);
+            last_left = i;
+        } else if (ev->keycode == host_key('a') && ev->pressed) {
+            last_a = i;
+        } else if (ev->keycode == host_key('i') && ev->pressed) {
+            first_i = MIN(first_i, i);
+        }
+    }
+    CHECK(last_a < first_left && last_left < first_i);
+    /* not held back by the inter-kana pace after "ka" */
+    CHECK(host_events[first_left].ms - host_events[last_a].ms <
+          CONFIG_NAGINATA_ROMA_INTER_KANA_DELAY_MS);
+}
+
+/* user-024: a priority event queued after a canceled entry still goes out */
+static void test_priority_after_cancel(void) {
+    const uint32_t right = ZMK_HID_USAGE(HID_USAGE_KEY, HID_USAGE_KEY_KEYBOARD_RIGHTARROW);
+
+    start();
+    host_tap_roma("ka");
+    naginata_emit_entry_begin();
+    host_tap_roma("su");
+    naginata_emit_entry_end();
+    CHECK(naginata_emit_cancel_entry() == 1);
+    naginata_emit_priority(right, true);
+    naginata_emit_priority(right, false);
+    host_tap_roma("o");
+    host_run_all();
+    CHECK_TEXT("kao");
+    CHECK(count_events(right, true, false) == 1);
+    CHECK(count_events(right, false, false) == 1);
+    CHECK(host_keys_up());
+}
+
+/* user-024: a priority event between two entries survives a cancel of the second */
+static void test_priority_before_cancel(void) {
+    const uint32_t right = ZMK_HID_USAGE(HID_USAGE_KEY, HID_USAGE_KEY_KEYBOARD_RIGHTARROW);
+
+    start();
+    naginata_emit_entry_begin();
+    host_tap_roma("ka");
+    naginata_emit_entry_end();
+    naginata_emit_priority(right, true);
+    naginata_emit_priority(right, false);
+    naginata_emit_entry_begin();
+    host_tap_roma("su");
+    naginata_emit_entry_end();
+    CHECK(naginata_emit_cancel_entry() == 1);
+    host_run_all();
+    CHECK_TEXT("ka");
+    CHECK(count_events(right, true, false) == 1);
+    CHECK(host_keys_up());
+}
+
+int main(void) {
+    naginata_emit_init();
+
+    test_pack_run();
+    test_pack_repeat();
+    test_pack_explicit_mod();
+    test_cancel_unsent();
+    test_cancel_started();
+    test_cancel_whole();
+    test_cancel_many_held();
+    test_priority_order();
+    test_priority_after_cancel();
+    test_priority_before_cancel();
+
+    if (host_failures > 0) {
+        fprintf(stderr, "test_emit: %d failed\n", host_failures);
+        return 1;
+    }
+    printf("test_emit: ok\n");
+    return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * Repeat and # doubling replay (user-021).
+ *
+ * Strokes go through process_mejiro_stroke_local as the stroke work runs
+ * them, with the hepburn table, and the text the host sees is checked after
+ * each one: #-St sends the next stroke once more (a # stroke 2 + n times), up
+ * to CONFIG_NAGINATA_MEJIRO_REPEAT_MAX; #- replays the last stroke; a stroke
+ * sent several times is one history entry, so -U sends one backspace per kana
+ * of all of it, and #-U still undoes one entry. A repeated stroke is compiled
+ * once: every send presses the keys of the first.
+ */
+#include <stdio.h>
+
+#include "behaviors/behavior_naginata.c"
+
+#include "host_test.h"
+
+static void stroke(const char *id) {
+    process_mejiro_stroke_local(mejiro_stroke_from_string(id));
+    host_run_all();
+}
+
+static void session_begin(void) {
+    host_run_all();
+    host_reset_events();
+    g_mejiro_history_count = 0;
+}
+
+/* s repeated times times */
+static const char *repeated(const char *s, int times) {
+    static char buf[256];
+    buf[0] = '\0';
+    for (int i = 0; i < times; i++) {
+        strcat(buf, s);
+    }
+    return buf;
+}
+
+/* The presses since first are the same per_send presses times times. */
+static bool sends_alike(size_t first, int per_send, int times) {
+    uint32_t keys[256];
+    int n = 0;
+    for (size_t i = first; i < host_event_count && n < (int)ARRAY_SIZE(keys); i++) {
+        if (host_events[i].pressed) {
+            keys[n++] = host_events[i].keycode;
+        }
+    }
+    if (n != per_send * times) {
+        return false;
+    }
+    for (int i = per_send; i < n; i++) {
+        if (keys[i] != keys[i % per_send]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int presses(uint16_t usage) {
+    int n = 0;
+    for (size_t i = 0; i < host_event_count; i++) {
+        n += host_events[i].pressed && ZMK_HID_USAGE_ID(host_events[i].keycode) == usage;
+    }
+    return n;
+}
+
+/* Backspaces an undo stroke sent: one per kana. */
+static int undo(const char *id) {
+    host_reset_events();
+    stroke(id);
+    return presses(HID_USAGE_KEY_KEYBOARD_DELETE_BACKSPACE);
+}
+
+static void test_hash_doubles(void) {
+    session_begin();
+    stroke("K-A");
+    CHECK_TEXT("kaa");
+
+    const size_t first = host_event_count;
+    stroke("#K-A");
+    CHECK_TEXT("kaakaakaa");
+    CHECK(sends_alike(first, 3, 2));
+
+    /* one entry for both sends: かあかあ */
+    CHECK(undo("-U") == 4);
+    CHECK(undo("-U") == 2);
+    CHECK(undo("-U") == 0);
+    CHECK(host_keys_up());
+}
+
+static void test_repeat_count(void) {
+    session_begin();
+    stroke("#-St");
+    CHECK(host_event_count == 0);
+    stroke("K-A");
+    CHECK_TEXT("kaakaa");
+
+    /* two #-St on a # stroke: 2 + 2 */
+    stroke("#-St");
+    stroke("#-St");
+    const size_t first = host_event_count;
+    stroke("#TK-");
+    CHECK_TEXT("kaakaahahahaha");
+    CHECK(sends_alike(first, 2, 4));
+
+    /* the count is used up by the stroke after it */
+    stroke("TK-");
+    CHECK_TEXT("kaakaahahahahaha");
+
+    CHECK(undo("-U") == 1);
+    CHECK(undo("-U") == 4);
+    CHECK(undo("-U") == 4);
+    CHECK(host_keys_up());
+}
+
+static void test_repeat_max(void) {
+    const int max = CONFIG_NAGINATA_MEJIRO_REPEAT_MAX;
+
+    /* more #-St than the cap: a plain stroke goes out max times */
+    session_begin();
+    for (int i = 0; i < max + 2; i++) {
+        stroke("#-St");
+    }
+    stroke("TK-");
+    CHECK_TEXT(repeated("ha", max));
+
+    /* and a # stroke too, not 2 + max */
+    session_begin();
+    for (int i = 0; i < max; i++) {
+        stroke("#-St");
+    }
+    stroke("#TK-");
+    CHECK_TEXT(repeated("ha", max));
+    CHECK(undo("-U") == max);
+}
+
+static void test_replay(void) {
+    session_begin();
+    stroke("TK-");
+    stroke("#-");
+    CHECK_TEXT("haha");
+
+    /* #-St on the replay stroke */
+    stroke("#-St");
+    stroke("#-");
+    CHECK_TEXT("hahahaha");
+
+    /* #-U undoes one entry, not two */
+    CHECK(undo("#-U") == 2);
+    CHECK(undo("-U") == 1);
+    CHECK(undo("-U") == 1);
+
+    /* a command is repeated by #-St as well */
+    host_reset_events();
+    stroke("#-St");
+    stroke("-A");
+    CHECK(presses(HID_USAGE_KEY_KEYBOARD_LEFTARROW) == 2);
+    CHECK(host_keys_up());
+}
+
+int main(void) {
+    mejiro_tables_init();
+    naginata_emit_init();
+
+    test_hash_doubles();
+    test_repeat_count();
+    test_repeat_max();
+    test_replay();
+
+    if (host_failures > 0) {
+        fprintf(stderr, "test_repeat: %d failed\n", host_failures);
+        return 1;
+    }
+    printf("test_repeat: ok\n");
+    return 0;
+}
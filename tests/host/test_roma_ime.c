@@ -0,0 +1,283 @@
+/*
+ * Per-IME romaji (user-015).
+ *
+ * Built once per IME profile table (HOST_ROMA_IME, -DHOST_ROMA_IME=IME_MS with
+ * the msime table, and so on; the hepburn table is checked against what all
+ * three accept). The romaji kana_to_roma_zmk sends is typed into a model of the
+ * IME: the spellings it accepts (ime_spellings, written from the IMEs' romaji
+ * tables, not from src/mejiro_roma_rules.c), a doubled consonant for っ, and n
+ * before a consonant other than y and n for ん. The kana that come out must be
+ * the kana that went in, for every kana, every pair, and っ and ん between
+ * any two. A kana the IME has no spelling for is skipped.
+ *
+ * A corpus written in the hepburn spelling of the default table is typed with
+ * the profile, and the keys saved are printed. The hepburn build checks that
+ * it sends the corpus as written.
+ */
+#include <stdio.h>
+
+#include "behaviors/behavior_naginata.c"
+
+#include "host_test.h"
+
+#define IME_MS 0x1
+#define IME_GO 0x2
+#define IME_MAC 0x4
+#define IME_ALL (IME_MS | IME_GO | IME_MAC)
+
+#ifndef HOST_ROMA_IME
+#define HOST_ROMA_IME IME_ALL
+#endif
+
+static const struct ime_spelling {
+    uint8_t ime;
+    const char *roma;
+    const char *kana;
+} ime_spellings[] = {
+    {IME_ALL, "a", "あ"}, {IME_ALL, "i", "い"}, {IME_ALL, "u", "う"}, {IME_ALL, "e", "え"},
+    {IME_ALL, "o", "お"},
+    {IME_ALL, "ka", "か"}, {IME_ALL, "ki", "き"}, {IME_ALL, "ku", "く"}, {IME_ALL, "ke", "け"},
+    {IME_ALL, "ko", "こ"},
+    {IME_ALL, "sa", "さ"}, {IME_ALL, "si", "し"}, {IME_ALL, "shi", "し"}, {IME_ALL, "su", "す"},
+    {IME_ALL, "se", "せ"}, {IME_ALL, "so", "そ"},
+    {IME_ALL, "ta", "た"}, {IME_ALL, "ti", "ち"}, {IME_ALL, "chi", "ち"}, {IME_ALL, "tu", "つ"},
+    {IME_ALL, "tsu", "つ"}, {IME_ALL, "te", "て"}, {IME_ALL, "to", "と"},
+    {IME_ALL, "na", "な"}, {IME_ALL, "ni", "に"}, {IME_ALL, "nu", "ぬ"}, {IME_ALL, "ne", "ね"},
+    {IME_ALL, "no", "の"},
+    {IME_ALL, "ha", "は"}, {IME_ALL, "hi", "ひ"}, {IME_ALL, "hu", "ふ"}, {IME_ALL, "fu", "ふ"},
+    {IME_ALL, "he", "へ"}, {IME_ALL, "ho", "ほ"},
+    {IME_ALL, "ma", "ま"}, {IME_ALL, "mi", "み"}, {IME_ALL, "mu", "む"}, {IME_ALL, "me", "め"},
+    {IME_ALL, "mo", "も"},
+    {IME_ALL, "ya", "や"}, {IME_ALL, "yu", "ゆ"}, {IME_ALL, "yo", "よ"},
+    {IME_ALL, "ra", "ら"}, {IME_ALL, "ri", "り"}, {IME_ALL, "ru", "る"}, {IME_ALL, "re", "れ"},
+    {IME_ALL, "ro", "ろ"},
+    {IME_ALL, "wa", "わ"}, {IME_ALL, "wo", "を"}, {IME_ALL, "nn", "ん"},
+    {IME_MS | IME_GO, "wyi", "ゐ"}, {IME_MS | IME_GO, "wye", "ゑ"},
+    {IME_ALL, "ga", "が"}, {IME_ALL, "gi", "ぎ"}, {IME_ALL, "gu", "ぐ"}, {IME_ALL, "ge", "げ"},
+    {IME_ALL, "go", "ご"},
+    {IME_ALL, "za", "ざ"}, {IME_ALL, "zi", "じ"}, {IME_ALL, "ji", "じ"}, {IME_ALL, "zu", "ず"},
+    {IME_ALL, "ze", "ぜ"}, {IME_ALL, "zo", "ぞ"},
+    {IME_ALL, "da", "だ"}, {IME_ALL, "di", "ぢ"}, {IME_ALL, "du", "づ"}, {IME_ALL, "de", "で"},
+    {IME_ALL, "do", "ど"},
+    {IME_ALL, "ba", "ば"}, {IME_ALL, "bi", "び"}, {IME_ALL, "bu", "ぶ"}, {IME_ALL, "be", "べ"},
+    {IME_ALL, "bo", "ぼ"},
+    {IME_ALL, "pa", "ぱ"}, {IME_ALL, "pi", "ぴ"}, {IME_ALL, "pu", "ぷ"}, {IME_ALL, "pe", "ぺ"},
+    {IME_ALL, "po", "ぽ"},
+    {IME_ALL, "kya", "きゃ"}, {IME_ALL, "kyu", "きゅ"}, {IME_ALL, "kyo", "きょ"},
+    {IME_ALL, "sya", "しゃ"}, {IME_ALL, "syu", "しゅ"}, {IME_ALL, "syo", "しょ"},
+    {IME_ALL, "sha", "しゃ"}, {IME_ALL, "shu", "しゅ"}, {IME_ALL, "sho", "しょ"},
+    {IME_ALL, "tya", "ちゃ"}, {IME_ALL, "tyu", "ちゅ"}, {IME_ALL, "tyo", "ちょ"},
+    {IME_ALL, "cha", "ちゃ"}, {IME_ALL, "chu", "ちゅ"}, {IME_ALL, "cho", "ちょ"},
+    {IME_ALL, "nya", "にゃ"}, {IME_ALL, "nyu", "にゅ"}, {IME_ALL, "nyo", "にょ"},
+    {IME_ALL, "hya", "ひゃ"}, {IME_ALL, "hyu", "ひゅ"}, {IME_ALL, "hyo", "ひょ"},
+    {IME_ALL, "mya", "みゃ"}, {IME_ALL, "myu", "みゅ"}, {IME_ALL, "myo", "みょ"},
+    {IME_ALL, "rya", "りゃ"}, {IME_ALL, "ryu", "りゅ"}, {IME_ALL, "ryo", "りょ"},
+    {IME_ALL, "gya", "ぎゃ"}, {IME_ALL, "gyu", "ぎゅ"}, {IME_ALL, "gyo", "ぎょ"},
+    {IME_ALL, "zya", "じゃ"}, {IME_ALL, "zyu", "じゅ"}, {IME_ALL, "zyo", "じょ"},
+    {IME_ALL, "ja", "じゃ"}, {IME_ALL, "ju", "じゅ"}, {IME_ALL, "jo", "じょ"},
+    {IME_ALL, "dya", "ぢゃ"}, {IME_ALL, "dyu", "ぢゅ"}, {IME_ALL, "dyo", "ぢょ"},
+    {IME_ALL, "bya", "びゃ"}, {IME_ALL, "byu", "びゅ"}, {IME_ALL, "byo", "びょ"},
+    {IME_ALL, "pya", "ぴゃ"}, {IME_ALL, "pyu", "ぴゅ"}, {IME_ALL, "pyo", "ぴょ"},
+    {IME_ALL, "vu", "ゔ"}, {IME_ALL, "va", "ゔぁ"}, {IME_ALL, "vi", "ゔぃ"},
+    {IME_ALL, "ve", "ゔぇ"}, {IME_ALL, "vo", "ゔぉ"}, {IME_ALL, "vyu", "ゔゅ"},
+    {IME_ALL, "wha", "うぁ"}, {IME_ALL, "wi", "うぃ"}, {IME_ALL, "we", "うぇ"},
+    {IME_ALL, "who", "うぉ"},
+    {IME_ALL, "fa", "ふぁ"}, {IME_ALL, "fi", "ふぃ"}, {IME_ALL, "fe", "ふぇ"}, {IME_ALL, "fo", "ふぉ"},
+    {IME_ALL, "fya", "ふゃ"}, {IME_ALL, "fyu", "ふゅ"}, {IME_ALL, "fyo", "ふょ"},
+    {IME_ALL, "qa", "くぁ"}, {IME_ALL, "qi", "くぃ"}, {IME_ALL, "qe", "くぇ"}, {IME_ALL, "qo", "くぉ"},
+    {IME_ALL, "kwa", "くぁ"}, {IME_ALL, "kwi", "くぃ"}, {IME_ALL, "kwe", "くぇ"},
+    {IME_ALL, "kwo", "くぉ"},
+    {IME_ALL, "ye", "いぇ"}, {IME_ALL, "she", "しぇ"}, {IME_ALL, "je", "じぇ"}, {IME_ALL, "che", "ちぇ"},
+    {IME_ALL, "thi", "てぃ"}, {IME_ALL, "dhi", "でぃ"}, {IME_ALL, "dhu", "でゅ"},
+    {IME_ALL, "twu", "とぅ"}, {IME_ALL, "dwu", "どぅ"},
+    {IME_ALL, "xa", "ぁ"}, {IME_ALL, "xi", "ぃ"}, {IME_ALL, "xu", "ぅ"}, {IME_ALL, "xe", "ぇ"},
+    {IME_ALL, "xo", "ぉ"},
+    {IME_ALL, "xya", "ゃ"}, {IME_ALL, "xyu", "ゅ"}, {IME_ALL, "xyo", "ょ"},
+    {IME_ALL, "xtu", "っ"}, {IME_ALL, "xwa", "ゎ"},
+    {IME_ALL, "-", "ー"}, {IME_ALL, ",", "、"}, {IME_ALL, ".", "。"},
+};
+
+/* romaji and kana codes of the spellings HOST_ROMA_IME accepts */
+static struct {
+    const char *roma;
+    char kana[4];
+} accepted[ARRAY_SIZE(ime_spellings)];
+static size_t accepted_count;
+
+static void accepted_init(void) {
+    for (size_t i = 0; i < ARRAY_SIZE(ime_spellings); i++) {
+        if ((ime_spellings[i].ime & HOST_ROMA_IME) == HOST_ROMA_IME) {
+            accepted[accepted_count].roma = ime_spellings[i].roma;
+            mejiro_kana_encode(ime_spellings[i].kana, accepted[accepted_count].kana,
+                               sizeof(accepted[0].kana));
+            accepted_count++;
+        }
+    }
+}
+
+static bool typeable(mejiro_kana_t k) {
+    for (size_t i = 0; i < accepted_count; i++) {
+        if ((mejiro_kana_t)accepted[i].kana[0] == k && accepted[i].kana[1] == '\0') {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* The kana the IME makes of roma, false if some of it stays unconverted. */
+static bool ime_type(const char *roma, char *kana, size_t size) {
+    size_t n = 0;
+
+    for (const char *p = roma; *p != '\0';) {
+        if (n + 3 >= size) {
+            return false;
+        }
+        if (p[0] == p[1] && strchr("bcdfghjklmpqrstvwxyz", p[0]) != NULL) {
+            kana[n++] = (char)MK_SOKUON;
+            p++;
+            continue;
+        }
+        if (p[0] == 'n' && p[1] >= 'a' && p[1] <= 'z' && strchr("aiueoyn", p[1]) == NULL) {
+            kana[n++] = (char)MK_NN;
+            p++;
+            continue;
+        }
+        size_t best = 0;
+        const char *best_kana = NULL;
+        for (size_t i = 0; i < accepted_count; i++) {
+            const size_t len = strlen(accepted[i].roma);
+            if (len > best && strncmp(p, accepted[i].roma, len) == 0) {
+                best = len;
+                best_kana = accepted[i].kana;
+            }
+        }
+        if (best_kana == NULL) {
+            return false;
+        }
+        for (const char *k = best_kana; *k != '\0'; k++) {
+            kana[n++] = *k;
+        }
+        p += best;
+    }
+    kana[n] = '\0';
+    return true;
+}
+
+static void roma_of(const char *kana, char *roma, size_t size) {
+    uint8_t pace[128];
+    kana_to_roma_zmk(kana, roma, pace, size);
+}
+
+static uint32_t checked;
+static uint32_t skipped;
+
+static void check_kana(const char *kana) {
+    char roma[128];
+    char typed[64];
+
+    for (const char *k = kana; *k != '\0'; k++) {
+        if ((mejiro_kana_t)*k != MK_SOKUON && (mejiro_kana_t)*k != MK_NN && !typeable(*k)) {
+            skipped++;
+            return;
+        }
+    }
+    roma_of(kana, roma, sizeof(roma));
+    const bool ok = ime_type(roma, typed, sizeof(typed)) && strcmp(typed, kana) == 0;
+    if (!ok) {
+        char utf8[32] = "";
+        for (const char *k = kana; *k != '\0'; k++) {
+            const uint16_t cp = mejiro_kana_codepoint((mejiro_kana_t)*k);
+            sprintf(utf8 + strlen(utf8), "%s%04x", k == kana ? "" : " ", cp);
+        }
+        fprintf(stderr, "U+%s sent as \"%s\", not typed back\n", utf8, roma);
+        host_failures++;
+    }
+    checked++;
+}
+
+/* a full-size kana: っ doubles its consonant */
+static bool full_size(mejiro_kana_t k) {
+    return MK_ROW(k) != MK_ROW_SMALL && !(MK_ROW(k) == MK_ROW_Y && (MK_COL(k) & 1)) &&
+           k != MK_NN && MK_ROW(k) != MK_ROW_A;
+}
+
+static void test_acceptance(void) {
+    static mejiro_kana_t kana[128];
+    size_t count = 0;
+
+    for (unsigned c = 0x80; c <= 0xFF; c++) {
+        if (mejiro_kana_codepoint((mejiro_kana_t)c) != 0) {
+            kana[count++] = (mejiro_kana_t)c;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        const char one[2] = {(char)kana[i], '\0'};
+        check_kana(one);
+        for (size_t j = 0; j < count; j++) {
+            const char two[3] = {(char)kana[i], (char)kana[j], '\0'};
+            const char nn[4] = {(char)kana[i], (char)MK_NN, (char)kana[j], '\0'};
+            check_kana(two);
+            check_kana(nn);
+            /* っ before a vowel is xtu; before a consonant it is doubled */
+            if (full_size(kana[j]) || (MK_ROW(kana[j]) == MK_ROW_A && MK_COL(kana[j]) <= MK_DAN_O)) {
+                const char tsu[4] = {(char)kana[i], (char)MK_SOKUON, (char)kana[j], '\0'};
+                check_kana(tsu);
+            }
+        }
+    }
+    printf("%u kana strings typed back, %u skipped (no spelling on this IME)\n", checked, skipped);
+}
+
+/* in the hepburn spelling of the default table */
+static const char corpus[] =
+    "kyou ha ii tennki desu ne mejiroshiki de nihonngo wo utte imasu kono bunnshou ha chotto "
+    "nagai node ikkini utsu to shouryaku ga kiite kuru hazu desu kitto shuuchuu shite "
+    "rennshuu sureba juubunn hayaku narimasu gyaku ni yukkuri utsu hito mo iru deshou ryokou "
+    "no junnbi wo shite shuppatsu shimashita channto kippu wo motte itta ka shinnpai desu "
+    "sakki no dennsha ni noriokure mashitakke pyonnpyonn haneru usagi to nyaanyaa naku neko "
+    "ga issho ni hirune wo shiteimasu fairu wo hiraite webu no pe-ji wo miru vaiorinn no "
+    "ennsou kai ni shoutai saremashita arigatou gozaimasu, mata raishuu oai shimashou. ";
+
+static void test_corpus(void) {
+    uint32_t hepburn_keys = 0;
+    uint32_t keys = 0;
+    uint32_t kana_count = 0;
+
+    for (const char *p = corpus; *p != '\0';) {
+        const char *end = strchr(p, ' ');
+        char word[64] = "";
+        char kana[64];
+        char typed[64];
+        char roma[128];
+
+        memcpy(word, p, MIN((size_t)(end - p), sizeof(word) - 1));
+        p = end + 1;
+        CHECK(ime_type(word, kana, sizeof(kana)));
+        roma_of(kana, roma, sizeof(roma));
+        CHECK(ime_type(roma, typed, sizeof(typed)) && strcmp(typed, kana) == 0);
+        CHECK(strlen(roma) <= strlen(word));
+        if (!MEJIRO_ROMA_SINGLE_N) {
+            CHECK(strcmp(roma, word) == 0);
+        }
+        hepburn_keys += strlen(word);
+        keys += strlen(roma);
+        kana_count += strlen(kana);
+    }
+    printf("corpus: %u kana, hepburn %u keys, this profile %u keys, %u saved (%.1f%%)\n",
+           kana_count, hepburn_keys, keys, hepburn_keys - keys,
+           100.0 * (hepburn_keys - keys) / hepburn_keys);
+}
+
+int main(void) {
+    accepted_init();
+
+    test_acceptance();
+    test_corpus();
+
+    if (host_failures > 0) {
+        fprintf(stderr, "test_roma_ime: %d failed\n", host_failures);
+        return 1;
+    }
+    printf("test_roma_ime: ok\n");
+    return 0;
+}
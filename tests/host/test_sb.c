@@ -0,0 +1,161 @@
+/*
+ * Bounded string builder on the transform path (user-012).
+ *
+ * mejiro_sb_t never writes past its capacity: every buffer here is followed
+ * by canary bytes that have to survive. An append that does not fit is cut,
+ * stays NUL-terminated and sets truncated, which stays set until the builder
+ * is initialized again. The transform steps that fill a builder
+ * (convert_to_kana for every half stroke, transform_joshi for every particle
+ * pair) are run into a builder too small for their output: the result is
+ * what fits of the full output, and truncated is set exactly when something
+ * was cut. kana_to_roma_zmk keeps the romaji and the pace inside output_size.
+ */
+#include <stdio.h>
+
+#include "behaviors/behavior_naginata.c"
+
+#include "host_test.h"
+
+#define CANARY 0x5A
+#define CANARY_LEN 8
+
+static char buf[64 + CANARY_LEN];
+
+static void buf_reset(void) { memset(buf, CANARY, sizeof(buf)); }
+
+static bool canary_ok(const char *p, size_t cap) {
+    for (size_t i = cap; i < cap + CANARY_LEN; i++) {
+        if ((unsigned char)p[i] != CANARY) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_builder(void) {
+    mejiro_sb_t sb;
+
+    buf_reset();
+    mejiro_sb_init(&sb, buf, 8);
+    mejiro_sb_append(&sb, "abc");
+    mejiro_sb_push(&sb, 'd');
+    CHECK(sb.len == 4 && mejiro_sb_equals(&sb, "abcd") && !sb.truncated);
+    CHECK(mejiro_sb_ends_with(&sb, "cd") && !mejiro_sb_ends_with(&sb, "abcde"));
+
+    /* cut at the capacity, NUL included */
+    mejiro_sb_append(&sb, "efghij");
+    CHECK(sb.len == 7 && mejiro_sb_equals(&sb, "abcdefg") && sb.truncated);
+    mejiro_sb_push(&sb, 'x');
+    CHECK(sb.len == 7 && buf[7] == '\0');
+    CHECK(canary_ok(buf, 8));
+
+    /* the flag is for the caller to check once at the end */
+    mejiro_sb_set(&sb, "ab");
+    CHECK(mejiro_sb_equals(&sb, "ab") && sb.truncated);
+    mejiro_sb_truncate(&sb, 1);
+    mejiro_sb_truncate(&sb, 5);
+    CHECK(sb.len == 1 && mejiro_sb_equals(&sb, "a"));
+    mejiro_sb_init(&sb, buf, 8);
+    CHECK(sb.len == 0 && !sb.truncated);
+
+    /* a one-byte buffer holds the NUL only */
+    buf_reset();
+    mejiro_sb_init(&sb, buf, 1);
+    mejiro_sb_append(&sb, "a");
+    mejiro_sb_push(&sb, 'b');
+    CHECK(sb.len == 0 && buf[0] == '\0' && sb.truncated && canary_ok(buf, 1));
+}
+
+/* The output cut to small_cap is the prefix of the full one, flagged when cut. */
+static bool cut_ok(const mejiro_sb_t *full, const mejiro_sb_t *small, size_t small_cap) {
+    const bool cut = full->len > small_cap - 1;
+    return small->truncated == cut && small->len == MIN(full->len, small_cap - 1) &&
+           memcmp(small->buf, full->buf, small->len) == 0 && small->buf[small->len] == '\0' &&
+           canary_ok(small->buf, small_cap);
+}
+
+static void test_convert_to_kana(void) {
+    char full_buf[64];
+    int cut = 0;
+
+    for (uint16_t half = 0; half <= MJ_HALF_MASK; half++) {
+        for (int extra = 0; extra <= 1; extra++) {
+            mejiro_sb_t full, small;
+            mejiro_sb_init(&full, full_buf, sizeof(full_buf));
+            convert_to_kana(half, extra, &full);
+            CHECK(!full.truncated);
+
+            buf_reset();
+            mejiro_sb_init(&small, buf, 3);
+            convert_to_kana(half, extra, &small);
+            if (!cut_ok(&full, &small, 3)) {
+                fprintf(stderr, "convert_to_kana %03x/%d: cut wrong\n", half, extra);
+                host_failures++;
+            }
+            cut += small.truncated;
+        }
+    }
+    CHECK(cut > 0);
+}
+
+static void test_transform_joshi(void) {
+    char full_buf[64];
+    int cut = 0;
+
+    for (uint8_t left = 0; left < 8; left++) {
+        for (uint8_t right = 0; right < 8; right++) {
+            mejiro_sb_t full, small;
+            mejiro_sb_init(&full, full_buf, sizeof(full_buf));
+            transform_joshi(left, right, &full);
+            CHECK(!full.truncated);
+
+            buf_reset();
+            mejiro_sb_init(&small, buf, 2);
+            transform_joshi(left, right, &small);
+            if (!cut_ok(&full, &small, 2)) {
+                fprintf(stderr, "transform_joshi %u/%u: cut wrong\n", left, right);
+                host_failures++;
+            }
+            cut += small.truncated;
+        }
+    }
+    CHECK(cut > 0);
+}
+
+static void test_kana_to_roma(void) {
+    char kana[128];
+    char roma[128];
+    uint8_t roma_pace[128];
+    uint8_t pace[24 + CANARY_LEN];
+
+    CHECK(mejiro_kana_encode("しゅっぱつしんこうりょこうのじゅんびはできました", kana,
+                             sizeof(kana)) > 0);
+    kana_to_roma_zmk(kana, roma, roma_pace, sizeof(roma));
+    const size_t full_len = strlen(roma);
+
+    /* every size from the smallest the loop runs with up */
+    for (size_t size = 11; size <= 24; size++) {
+        buf_reset();
+        memset(pace, CANARY, sizeof(pace));
+        kana_to_roma_zmk(kana, buf, pace, size);
+        const size_t len = strlen(buf);
+        CHECK(len < size && len < full_len && strncmp(buf, roma, len) == 0);
+        CHECK(canary_ok(buf, size) && canary_ok((const char *)pace, size));
+    }
+}
+
+int main(void) {
+    mejiro_tables_init();
+
+    test_builder();
+    test_convert_to_kana();
+    test_transform_joshi();
+    test_kana_to_roma();
+
+    if (host_failures > 0) {
+        fprintf(stderr, "test_sb: %d failed\n", host_failures);
+        return 1;
+    }
+    printf("test_sb: ok\n");
+    return 0;
+}
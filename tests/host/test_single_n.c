@@ -0,0 +1,150 @@
+/*
+ * ん across queued strokes (user-023).
+ *
+ * Chords go into the stroke queue as the release callback puts them there and
+ * the stroke work drains it. With a table that spells ん before a consonant
+ * as a single n (MEJIRO_ROMA_SINGLE_N, the IME profiles), a stroke ending in ん
+ * is held while another stroke is queued: before a plain consonant it goes
+ * out as "n", before a vowel, y or n, or with nothing queued behind it, as
+ * "nn". The single n still ends a kana (the inter-kana pace follows it), and
+ * each stroke stays its own undo entry. The hepburn build always sends "nn".
+ */
+#include <stdio.h>
+
+#include "behaviors/behavior_naginata.c"
+
+#include "host_test.h"
+
+/* left hand: かん, は, あ, や; right hand: -n (Enter) */
+#define CHORD_KAN (B_S | B_F | B_C)
+#define CHORD_HA (B_W | B_S)
+#define CHORD_A (B_F)
+#define CHORD_YA (B_E | B_F)
+#define CHORD_ENTER (B_COMMA)
+
+#if MEJIRO_ROMA_SINGLE_N
+#define N_BEFORE_CONSONANT "n"
+#else
+#define N_BEFORE_CONSONANT "nn"
+#endif
+
+static void session_begin(void) {
+    host_run_all();
+    host_reset_events();
+    g_mejiro_history_count = 0;
+}
+
+/* Queue the chords together, as when they are finalized faster than sent. */
+static void type_queued(const uint32_t *chords, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        mejiro_stroke_enqueue(chords[i]);
+    }
+    host_run_all();
+}
+
+/* Each chord sent on its own, the queue empty behind it. */
+static void type_apart(const uint32_t *chords, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        mejiro_stroke_enqueue(chords[i]);
+        host_run_all();
+    }
+}
+
+static int undo_backspaces(void) {
+    host_reset_events();
+    process_mejiro_stroke_local(mejiro_stroke_from_string("-U"));
+    host_run_all();
+    int n = 0;
+    for (size_t i = 0; i < host_event_count; i++) {
+        n += host_events[i].pressed &&
+             ZMK_HID_USAGE_ID(host_events[i].keycode) == HID_USAGE_KEY_KEYBOARD_DELETE_BACKSPACE;
+    }
+    return n;
+}
+
+/* Time from the last press of key a to the next press of key b. */
+static int64_t press_gap(char a, char b) {
+    int64_t at = -1;
+    for (size_t i = 0; i < host_event_count; i++) {
+        if (!host_events[i].pressed) {
+            continue;
+        }
+        if (host_events[i].keycode == host_key(a)) {
+            at = host_events[i].ms;
+        } else if (at >= 0 && host_events[i].keycode == host_key(b)) {
+            return host_events[i].ms - at;
+        }
+    }
+    return -1;
+}
+
+static void test_before_consonant(void) {
+    const uint32_t chords[] = {CHORD_KAN, CHORD_HA};
+
+    session_begin();
+    type_queued(chords, ARRAY_SIZE(chords));
+    CHECK_TEXT("ka" N_BEFORE_CONSONANT "ha");
+    /* the kana boundary is where it was: after the last n */
+    CHECK(press_gap('n', 'h') >= CONFIG_NAGINATA_ROMA_INTER_KANA_DELAY_MS);
+    CHECK(host_keys_up());
+
+    /* one entry per stroke: は, then かん */
+    CHECK(undo_backspaces() == 1);
+    CHECK(undo_backspaces() == 2);
+
+    /* three in a row: each ん is planned against the stroke after it */
+    const uint32_t three[] = {CHORD_KAN, CHORD_KAN, CHORD_HA};
+    session_begin();
+    type_queued(three, ARRAY_SIZE(three));
+    CHECK_TEXT("ka" N_BEFORE_CONSONANT "ka" N_BEFORE_CONSONANT "ha");
+}
+
+static void test_before_vowel_and_y(void) {
+    const uint32_t vowel[] = {CHORD_KAN, CHORD_A};
+    const uint32_t y[] = {CHORD_KAN, CHORD_YA};
+
+    session_begin();
+    type_queued(vowel, ARRAY_SIZE(vowel));
+    CHECK_TEXT("kanna");
+
+    session_begin();
+    type_queued(y, ARRAY_SIZE(y));
+    CHECK_TEXT("kannya");
+}
+
+static void test_nothing_queued(void) {
+    const uint32_t chords[] = {CHORD_KAN, CHORD_HA};
+
+    /* a stroke ending in ん with the queue empty is not held */
+    session_begin();
+    mejiro_stroke_enqueue(CHORD_KAN);
+    host_run_all();
+    CHECK_TEXT("kann");
+
+    session_begin();
+    type_apart(chords, ARRAY_SIZE(chords));
+    CHECK_TEXT("kannha");
+
+    /* a command behind it (-n, Enter): the held stroke goes out as is first */
+    const uint32_t command[] = {CHORD_KAN, CHORD_ENTER};
+    session_begin();
+    type_queued(command, ARRAY_SIZE(command));
+    CHECK_TEXT("kann\n");
+    CHECK(host_keys_up());
+}
+
+int main(void) {
+    mejiro_tables_init();
+    naginata_emit_init();
+
+    test_before_consonant();
+    test_before_vowel_and_y();
+    test_nothing_queued();
+
+    if (host_failures > 0) {
+        fprintf(stderr, "test_single_n: %d failed\n", host_failures);
+        return 1;
+    }
+    printf("test_single_n: ok\n");
+    return 0;
+}
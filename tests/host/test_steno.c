@@ -0,0 +1,200 @@
+/*
+ * Steno packets (user-018).
+ *
+ * Every stroke bit alone, all of them together and the empty stroke are
+ * encoded in both protocols and compared byte by byte with packets written
+ * out from Plover's charts: Gemini PR is 6 bytes of 7 keys, the first flagged
+ * by 0x80 (Fn #1-#6 / S1 S2 T K P W H / R A O *1 *2 res res / pwr *3 *4 E U F R /
+ * P B L G T S D / #7-#C Z); TX Bolt is the groups with keys, group number in
+ * the top two bits (S T K P W H / R A O * E U / F R P B L G / T S D Z #), and a
+ * 0 byte. Each packet decodes back to its stroke, and so do random strokes.
+ *
+ * The argument is the host build of scripts/mejiro_steno_decode.c: the
+ * packets of all strokes go through it as one stream per protocol, and it
+ * has to print the strokes back, one per line.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <zmk_naginata/mejiro_steno.h>
+
+#include "host_test.h"
+
+struct known_packet {
+    const char *key; /* steno key of the bit */
+    uint8_t gemini[6];
+    uint8_t txbolt[MEJIRO_STENO_PACKET_MAX];
+    size_t txbolt_len;
+};
+
+/* one per stroke bit, mejiro_stroke.h order */
+static const struct known_packet known[24] = {
+    {"S1-", {0x80, 0x40, 0x00, 0x00, 0x00, 0x00}, {0x01, 0x00}, 2}, /* S- */
+    {"T-", {0x80, 0x10, 0x00, 0x00, 0x00, 0x00}, {0x02, 0x00}, 2},  /* T- */
+    {"P-", {0x80, 0x04, 0x00, 0x00, 0x00, 0x00}, {0x08, 0x00}, 2},  /* K- */
+    {"H-", {0x80, 0x01, 0x00, 0x00, 0x00, 0x00}, {0x20, 0x00}, 2},  /* N- */
+    {"S2-", {0x80, 0x20, 0x00, 0x00, 0x00, 0x00}, {0xD0, 0x00}, 2}, /* Y-: TX Bolt # */
+    {"K-", {0x80, 0x08, 0x00, 0x00, 0x00, 0x00}, {0x04, 0x00}, 2},  /* I- */
+    {"W-", {0x80, 0x02, 0x00, 0x00, 0x00, 0x00}, {0x10, 0x00}, 2},  /* A- */
+    {"R-", {0x80, 0x00, 0x40, 0x00, 0x00, 0x00}, {0x41, 0x00}, 2},  /* U- */
+    {"A", {0x80, 0x00, 0x20, 0x00, 0x00, 0x00}, {0x42, 0x00}, 2},   /* n- */
+    {"O", {0x80, 0x00, 0x10, 0x00, 0x00, 0x00}, {0x44, 0x00}, 2},   /* t- */
+    {"*1", {0x80, 0x00, 0x08, 0x00, 0x00, 0x00}, {0x48, 0x00}, 2},  /* k- */
+    {"#1", {0xA0, 0x00, 0x00, 0x00, 0x00, 0x00}, {0xE0, 0x00}, 2},  /* #: TX Bolt sixth bit */
+    {"-T", {0x80, 0x00, 0x00, 0x00, 0x04, 0x00}, {0xC1, 0x00}, 2},  /* -S */
+    {"-L", {0x80, 0x00, 0x00, 0x00, 0x10, 0x00}, {0x90, 0x00}, 2},  /* -T */
+    {"-P", {0x80, 0x00, 0x00, 0x00, 0x40, 0x00}, {0x84, 0x00}, 2},  /* -K */
+    {"-F", {0x80, 0x00, 0x00, 0x02, 0x00, 0x00}, {0x81, 0x00}, 2},  /* -N */
+    {"-S", {0x80, 0x00, 0x00, 0x00, 0x02, 0x00}, {0xC2, 0x00}, 2},  /* -Y */
+    {"-G", {0x80, 0x00, 0x00, 0x00, 0x08, 0x00}, {0xA0, 0x00}, 2},  /* -I */
+    {"-B", {0x80, 0x00, 0x00, 0x00, 0x20, 0x00}, {0x88, 0x00}, 2},  /* -A */
+    {"-R", {0x80, 0x00, 0x00, 0x01, 0x00, 0x00}, {0x82, 0x00}, 2},  /* -U */
+    {"E", {0x80, 0x00, 0x00, 0x08, 0x00, 0x00}, {0x50, 0x00}, 2},   /* -n */
+    {"U", {0x80, 0x00, 0x00, 0x04, 0x00, 0x00}, {0x60, 0x00}, 2},   /* -t */
+    {"*4", {0x80, 0x00, 0x00, 0x10, 0x00, 0x00}, {0xC4, 0x00}, 2},  /* -k: TX Bolt -D */
+    {"*2", {0x80, 0x00, 0x04, 0x00, 0x00, 0x00}, {0xC8, 0x00}, 2},  /* *: TX Bolt -Z */
+};
+
+static const struct known_packet all_keys = {
+    "all", {0xA0, 0x7F, 0x7C, 0x1F, 0x7E, 0x00}, {0x3F, 0x7F, 0xBF, 0xFF, 0x00}, 5};
+static const struct known_packet no_keys = {
+    "none", {0x80, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x00}, 1};
+
+#define RANDOM_STROKES 512
+
+static mejiro_stroke_t strokes[ARRAY_SIZE(known) + 1 + RANDOM_STROKES];
+
+static bool packet_is(const char *what, const uint8_t *got, size_t got_len, const uint8_t *want,
+                      size_t want_len) {
+    if (got_len == want_len && memcmp(got, want, want_len) == 0) {
+        return true;
+    }
+    fprintf(stderr, "%s:", what);
+    for (size_t i = 0; i < got_len; i++) {
+        fprintf(stderr, " %02x", got[i]);
+    }
+    fprintf(stderr, ", want");
+    for (size_t i = 0; i < want_len; i++) {
+        fprintf(stderr, " %02x", want[i]);
+    }
+    fprintf(stderr, "\n");
+    return false;
+}
+
+static void check_known(mejiro_stroke_t stroke, const struct known_packet *want) {
+    uint8_t packet[MEJIRO_STENO_PACKET_MAX];
+    char what[64];
+
+    size_t n = mejiro_steno_encode(MEJIRO_STENO_GEMINIPR, stroke, packet);
+    snprintf(what, sizeof(what), "Gemini PR %s", want->key);
+    CHECK(packet_is(what, packet, n, want->gemini, sizeof(want->gemini)));
+    CHECK(mejiro_steno_decode(MEJIRO_STENO_GEMINIPR, packet, n) == stroke);
+
+    n = mejiro_steno_encode(MEJIRO_STENO_TXBOLT, stroke, packet);
+    snprintf(what, sizeof(what), "TX Bolt %s", want->key);
+    CHECK(packet_is(what, packet, n, want->txbolt, want->txbolt_len));
+    CHECK(mejiro_steno_decode(MEJIRO_STENO_TXBOLT, packet, n) == stroke);
+}
+
+static void test_known_packets(void) {
+    for (int bit = 0; bit < (int)ARRAY_SIZE(known); bit++) {
+        check_known((mejiro_stroke_t)1 << bit, &known[bit]);
+    }
+    check_known(MJ_STROKE_ALL, &all_keys);
+    check_known(0, &no_keys);
+}
+
+/* every bit, all bits, then random strokes; none is empty (no packet in a TX Bolt stream) */
+static void strokes_init(void) {
+    uint32_t seed = 2026;
+    size_t n = 0;
+
+    for (int bit = 0; bit < (int)ARRAY_SIZE(known); bit++) {
+        strokes[n++] = (mejiro_stroke_t)1 << bit;
+    }
+    strokes[n++] = MJ_STROKE_ALL;
+    while (n < ARRAY_SIZE(strokes)) {
+        seed = seed * 1103515245u + 12345u;
+        const mejiro_stroke_t s = (seed >> 4) & MJ_STROKE_ALL;
+        if (s != 0) {
+            strokes[n++] = s;
+        }
+    }
+}
+
+static void test_round_trip(void) {
+    uint8_t packet[MEJIRO_STENO_PACKET_MAX];
+
+    for (size_t i = 0; i < ARRAY_SIZE(strokes); i++) {
+        for (int p = MEJIRO_STENO_GEMINIPR; p <= MEJIRO_STENO_TXBOLT; p++) {
+            const size_t n = mejiro_steno_encode((enum mejiro_steno_protocol)p, strokes[i], packet);
+            CHECK(n <= MEJIRO_STENO_PACKET_MAX);
+            CHECK(mejiro_steno_decode((enum mejiro_steno_protocol)p, packet, n) == strokes[i]);
+        }
+    }
+}
+
+/* All strokes as one stream through the decoder tool, read back line by line. */
+static void test_decoder_tool(const char *decoder, enum mejiro_steno_protocol protocol,
+                              const char *name) {
+    char path[] = "/tmp/test_steno_XXXXXX";
+    const int fd = mkstemp(path);
+    FILE *stream = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (stream == NULL) {
+        CHECK(!"cannot write the packet stream");
+        return;
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(strokes); i++) {
+        uint8_t packet[MEJIRO_STENO_PACKET_MAX];
+        const size_t n = mejiro_steno_encode(protocol, strokes[i], packet);
+        fwrite(packet, 1, n, stream);
+    }
+    fclose(stream);
+
+    char cmdline[512];
+    snprintf(cmdline, sizeof(cmdline), "'%s' %s '%s'", decoder, name, path);
+    FILE *out = popen(cmdline, "r");
+    if (out == NULL) {
+        CHECK(!"cannot run the decoder");
+        unlink(path);
+        return;
+    }
+    char line[64];
+    size_t i = 0;
+    while (fgets(line, sizeof(line), out) != NULL) {
+        char want[MEJIRO_STROKE_STR_MAX];
+        line[strcspn(line, "\n")] = '\0';
+        if (i >= ARRAY_SIZE(strokes)) {
+            CHECK(!"more strokes than were sent");
+            break;
+        }
+        mejiro_stroke_to_string(strokes[i], want, sizeof(want));
+        if (strcmp(line, want) != 0) {
+            fprintf(stderr, "%s stroke %zu: decoded %s, sent %s\n", name, i, line, want);
+            host_failures++;
+        }
+        i++;
+    }
+    CHECK(pclose(out) == 0);
+    CHECK(i == ARRAY_SIZE(strokes));
+    unlink(path);
+}
+
+int main(int argc, char **argv) {
+    test_known_packets();
+    strokes_init();
+    test_round_trip();
+    if (argc > 1) {
+        test_decoder_tool(argv[1], MEJIRO_STENO_GEMINIPR, "geminipr");
+        test_decoder_tool(argv[1], MEJIRO_STENO_TXBOLT, "txbolt");
+    }
+
+    if (host_failures > 0) {
+        fprintf(stderr, "test_steno: %d failed\n", host_failures);
+        return 1;
+    }
+    printf("%zu strokes round-tripped in both protocols\n", ARRAY_SIZE(strokes));
+    printf("test_steno: ok\n");
+    return 0;
+}
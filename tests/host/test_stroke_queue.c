@@ -0,0 +1,122 @@
+/*
+ * Stroke queue backpressure (user-001).
+ *
+ * Built with an output queue of 64 events and strokes that wait for 16 free
+ * slots. Strokes queued faster than they are typed out stay in the stroke
+ * queue until the emitter has room, and the emitter runs the stroke work
+ * again once it has: nothing sleeps on the work queue, every stroke is typed
+ * in order and every pace delay is kept. With both queues full, a stroke
+ * finalized on the work queue is dropped and counted rather than waited for.
+ */
+#include <stdio.h>
+
+#include "behaviors/behavior_naginata.c"
+
+#include "host_test.h"
+
+/* かん: "kann", 8 events */
+#define CHORD_KAN (B_S | B_F | B_C)
+
+static void session_begin(void) {
+    host_run_all();
+    host_reset_events();
+    mejiro_stats_reset();
+    g_mejiro_history_count = 0;
+}
+
+static const char *kann_times(int n) {
+    static char buf[256];
+    buf[0] = '\0';
+    for (int i = 0; i < n; i++) {
+        strcat(buf, "kann");
+    }
+    return buf;
+}
+
+/* Every press at least the intra-kana delay after the one before, a kana after "nn" the inter-kana one. */
+static bool paced(void) {
+    int64_t last = -1;
+    uint32_t last_key = 0;
+    for (size_t i = 0; i < host_event_count; i++) {
+        const struct host_event *ev = &host_events[i];
+        if (!ev->pressed) {
+            continue;
+        }
+        if (last >= 0) {
+            const int64_t want = last_key == host_key('n') && ev->keycode == host_key('k')
+                                     ? CONFIG_NAGINATA_ROMA_INTER_KANA_DELAY_MS
+                                     : CONFIG_NAGINATA_ROMA_INTRA_KANA_DELAY_MS;
+            if (ev->ms - last < want) {
+                fprintf(stderr, "press %zu: %lld ms after the one before\n", i,
+                        (long long)(ev->ms - last));
+                return false;
+            }
+        }
+        last = ev->ms;
+        last_key = ev->keycode;
+    }
+    return true;
+}
+
+static void test_waits_for_room(void) {
+    const int strokes = CONFIG_NAGINATA_STROKE_QUEUE_SIZE;
+    struct mejiro_stats stats;
+
+    session_begin();
+    const int64_t slept = host_slept_ms;
+    for (int i = 0; i < strokes; i++) {
+        mejiro_stroke_enqueue(CHORD_KAN);
+    }
+    /* what runs now: only as many strokes as leave room for one more */
+    host_run(k_uptime_get());
+    CHECK(k_msgq_num_used_get(&mejiro_stroke_msgq) > 0);
+
+    host_run_all();
+    CHECK_TEXT(kann_times(strokes));
+    CHECK(paced());
+    CHECK(host_keys_up());
+    CHECK(host_slept_ms == slept);
+    mejiro_stats_get(&stats);
+    CHECK(stats.stroke_queue_overflows == 0);
+}
+
+static void test_both_full(void) {
+    const int strokes = CONFIG_NAGINATA_STROKE_QUEUE_SIZE;
+    struct mejiro_stats stats;
+
+    session_begin();
+    const int64_t slept = host_slept_ms;
+    for (int i = 0; i < strokes; i++) {
+        mejiro_stroke_enqueue(CHORD_KAN);
+    }
+    host_run(k_uptime_get());
+    /* fill the stroke queue again behind the strokes the output has taken */
+    int queued = strokes;
+    while (k_msgq_num_free_get(&mejiro_stroke_msgq) > 0) {
+        mejiro_stroke_enqueue(CHORD_KAN);
+        queued++;
+    }
+    mejiro_stroke_enqueue(CHORD_KAN);
+
+    host_run_all();
+    CHECK_TEXT(kann_times(queued));
+    CHECK(paced());
+    CHECK(host_slept_ms == slept);
+    mejiro_stats_get(&stats);
+    CHECK(stats.stroke_queue_overflows == 1);
+}
+
+int main(void) {
+    mejiro_tables_init();
+    naginata_emit_init();
+
+    test_waits_for_room();
+    test_both_full();
+
+    if (host_failures > 0) {
+        fprintf(stderr, "test_stroke_queue: %d failed\n", host_failures);
+        return 1;
+    }
+    printf("test_stroke_queue: ok\n");
+    return 0;
+}
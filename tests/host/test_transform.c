@@ -0,0 +1,295 @@
+/*
+ * Old-versus-new transform equivalence (user-009/010/013/014/015).
+ *
+ * Built twice: against the string-keyed transform of the last release
+ * (MEJIRO_TRANSFORM_OLD, behaviors/latestOKw36_262_20260413behavior_naginata.c)
+ * and against the current one with the hepburn table. Every stroke without #
+ * is transformed from the default state, and every seventh one again from YU
+ * with a pending っ. Each program prints one digest per 65536 strokes of the
+ * romaji, the kana count, the success flag and the state left behind; the
+ * test passes when the two outputs are the same.
+ *
+ * A right-hand stroke with a carried っ left its kana unconverted in the old
+ * result; send_mejiro_roma typed nothing for it, so only the characters the
+ * old code typed are compared.
+ *
+ * The old code also doubled the next character for っ before a な-row kana,
+ * ん, a small kana or a symbol, which no IME reads as っ ("nna" is んあ); the
+ * new one sends xtu there. The new romaji is mapped back to the old spelling
+ * for the comparison.
+ *
+ * With a block number as argument, one digest per stroke of that block is
+ * printed instead, to find the stroke that differs.
+ *
+ * "bench" times kana_to_roma_zmk on a corpus split into stroke-sized words
+ * (user-014): the table scan of the last release against the generated trie.
+ * The new side encodes the corpus to kana codes first, as the transform
+ * hands it codes. It then times a whole stroke (user-012), from the stroke to
+ * its romaji, on every 61st stroke: the string-keyed transform of the last
+ * release with its strcpy/strcat chains, against the transform into
+ * length-tracked builders followed by kana_to_roma_zmk.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <zmk_naginata/mejiro_kana_code.h>
+#include <zmk_naginata/mejiro_stroke.h>
+
+#ifdef MEJIRO_TRANSFORM_OLD
+/* the last release as it shipped, unused helpers and all */
+#pragma GCC diagnostic ignored "-Wunused-function"
+#include "behaviors/latestOKw36_262_20260413behavior_naginata.c"
+#else
+#include "behaviors/behavior_naginata.c"
+#endif
+
+static uint64_t digest;
+
+static void digest_add(const void *data, size_t n) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < n; i++) {
+        digest = (digest ^ p[i]) * 1099511628211ULL;
+    }
+}
+
+#ifdef MEJIRO_TRANSFORM_OLD
+
+static void state_set(const char *vowel, bool tsu) {
+    strcpy(last_vowel_stroke, vowel);
+    pending_tsu = tsu;
+}
+
+static void state_add(void) {
+    digest_add(last_vowel_stroke, strlen(last_vowel_stroke) + 1);
+    digest_add(&pending_tsu, 1);
+}
+
+static void transform_add(mejiro_stroke_t stroke) {
+    char id[MEJIRO_STROKE_STR_MAX];
+    mejiro_stroke_to_string(stroke, id, sizeof(id));
+    const mejiro_result_t_zmk r = mejiro_transform_zmk(id);
+    const uint32_t kana_length = (uint32_t)r.kana_length;
+
+    if (r.success) {
+        for (const char *p = r.output; *p != '\0'; p++) {
+            if ((unsigned char)*p < 0x80) {
+                digest_add(p, 1);
+            }
+        }
+        digest_add("", 1);
+    }
+    digest_add(&kana_length, sizeof(kana_length));
+    digest_add(&r.success, 1);
+}
+
+#else
+
+static void state_set(const char *vowel, bool tsu) {
+    last_vowel_stroke = (uint8_t)MJ_HALF_VOWEL(mejiro_half_from_string(vowel));
+    pending_tsu = tsu;
+}
+
+/* the vowel as the old state string, e.g. "YU" */
+static void state_add(void) {
+    char vowel[8];
+    mejiro_stroke_to_string(MJ_HALF(0, last_vowel_stroke, 0), vowel, sizeof(vowel));
+    vowel[strlen(vowel) - 1] = '\0'; /* the hyphen */
+    digest_add(vowel, strlen(vowel) + 1);
+    digest_add(&pending_tsu, 1);
+}
+
+/*
+ * xtu before n, x or a symbol back to the doubled character of the old code.
+ * Before a doubled consonant it stands for っっ, where the old code doubled
+ * the x of the second っ.
+ */
+static void roma_old_sokuon(char *roma) {
+    for (char *p = strstr(roma, "xtu"); p != NULL; p = strstr(p + 1, "xtu")) {
+        const char c = p[3] == p[4] && p[3] != '\0' && strchr("aiueon", p[3]) == NULL ? 'x' : p[3];
+        if (c != '\0' && (c < 'a' || c > 'z' || c == 'n' || c == 'x')) {
+            p[0] = c;
+            memmove(p + 1, p + 3, strlen(p + 3) + 1);
+        }
+    }
+}
+
+static void transform_add(mejiro_stroke_t stroke) {
+    const mejiro_result_t_zmk r = mejiro_transform_zmk(stroke);
+    const uint32_t kana_length = (uint32_t)r.kana_length;
+    char roma[128] = "";
+    uint8_t pace[128];
+
+    if (r.success && r.kana[0] != '\0') {
+        kana_to_roma_zmk(r.kana, roma, pace, sizeof(roma));
+        roma_old_sokuon(roma);
+    }
+    if (r.success) {
+        digest_add(roma, strlen(roma) + 1);
+    }
+    digest_add(&kana_length, sizeof(kana_length));
+    digest_add(&r.success, 1);
+}
+
+#endif
+
+static const char roma_corpus[] =
+    "きょう は いい てんき です ね めじろしき で にほんご を うって います "
+    "この ぶんしょう は ちょっと ながい ので いっきに うつ と しょうりゃく が "
+    "きいて くる はず です きっと しゅうちゅう して れんしゅう すれば "
+    "じゅうぶん はやく なります ぎゃく に ゆっくり うつ ひと も いる でしょう "
+    "りょこう の じゅんび を して しゅっぱつ しました ちゃんと きっぷ を "
+    "もって いった か しんぱい です さっき の でんしゃ に のりおくれ ましたっけ "
+    "ぴょんぴょん はねる うさぎ と にゃあにゃあ なく ねこ が いっしょ に "
+    "ひるね を しています ふぁいる を ひらいて うぇぶ の ぺーじ を みる "
+    "ゔぁいおりん の えんそう かい に しょうたい されました ありがとう "
+    "ございます、 また らいしゅう おあい しましょう。 ";
+
+#ifndef MEJIRO_TRANSFORM_OLD
+static void roma_convert(const char *word, char *roma, size_t roma_size) {
+    uint8_t pace[128];
+    kana_to_roma_zmk(word, roma, pace, roma_size);
+}
+#else
+static void roma_convert(const char *word, char *roma, size_t roma_size) {
+    kana_to_roma_zmk(word, roma, roma_size);
+}
+#endif
+
+static void roma_bench(void) {
+    static char words[128][64];
+    size_t word_count = 0;
+    size_t kana_count = 0;
+
+    for (const char *p = roma_corpus; *p != '\0' && word_count < ARRAY_SIZE(words);) {
+        const char *end = strchr(p, ' ');
+        char utf8[64] = "";
+        memcpy(utf8, p, MIN((size_t)(end - p), sizeof(utf8) - 1));
+#ifdef MEJIRO_TRANSFORM_OLD
+        strcpy(words[word_count], utf8);
+        for (const char *q = utf8; *q != '\0';) {
+            kana_count += mejiro_kana_from_utf8(&q) != 0;
+        }
+#else
+        kana_count += mejiro_kana_encode(utf8, words[word_count], sizeof(words[0]));
+#endif
+        word_count++;
+        p = end + 1;
+    }
+
+    const int rounds = 20000;
+    char roma[128];
+    digest = 1469598103934665603ULL;
+    const clock_t start = clock();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < word_count; i++) {
+            roma_convert(words[i], roma, sizeof(roma));
+            digest_add(roma, strlen(roma) + 1);
+        }
+    }
+    const double ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC;
+    printf("kana_to_roma_zmk (%s): %zu words, %zu kana, %.1f ns/kana, %.1f ns/word, %016llx\n",
+#ifdef MEJIRO_TRANSFORM_OLD
+           "table scan",
+#else
+           "trie",
+#endif
+           word_count, kana_count, ns / ((double)rounds * kana_count),
+           ns / ((double)rounds * word_count), (unsigned long long)digest);
+}
+
+#define BENCH_STROKE_STEP 61
+
+static void transform_bench(void) {
+    static mejiro_stroke_t strokes[MJ_STROKE_ALL / BENCH_STROKE_STEP / 2 + 1];
+    size_t count = 0;
+
+    for (mejiro_stroke_t stroke = 0; stroke <= MJ_STROKE_ALL; stroke += BENCH_STROKE_STEP) {
+        if ((stroke & MJ_HASH) == 0 && count < ARRAY_SIZE(strokes)) {
+            strokes[count++] = stroke;
+        }
+    }
+#ifdef MEJIRO_TRANSFORM_OLD
+    /* the old entry point takes the stroke as a string; converting it is not timed */
+    char (*ids)[MEJIRO_STROKE_STR_MAX] = malloc(count * sizeof(*ids));
+    for (size_t i = 0; i < count; i++) {
+        mejiro_stroke_to_string(strokes[i], ids[i], sizeof(ids[i]));
+    }
+#endif
+
+    const int rounds = 3;
+    digest = 1469598103934665603ULL;
+    const clock_t start = clock();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            state_set("A", false);
+#ifdef MEJIRO_TRANSFORM_OLD
+            const mejiro_result_t_zmk res = mejiro_transform_zmk(ids[i]);
+            digest_add(res.output, 1);
+#else
+            const mejiro_result_t_zmk res = mejiro_transform_zmk(strokes[i]);
+            char roma[128] = "";
+            uint8_t pace[128];
+            if (res.success && res.kana[0] != '\0') {
+                kana_to_roma_zmk(res.kana, roma, pace, sizeof(roma));
+            }
+            digest_add(roma, 1);
+#endif
+        }
+    }
+    const double ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC;
+    printf("stroke to romaji (%s): %zu strokes, %.0f ns/stroke\n",
+#ifdef MEJIRO_TRANSFORM_OLD
+           "string-keyed, strcat",
+#else
+           "builders, trie",
+#endif
+           count, ns / ((double)rounds * count));
+#ifdef MEJIRO_TRANSFORM_OLD
+    free(ids);
+#endif
+}
+
+static uint64_t transform_block(mejiro_stroke_t block, bool per_stroke) {
+    digest = 1469598103934665603ULL;
+    for (mejiro_stroke_t stroke = block; stroke < block + 0x10000; stroke++) {
+        if (stroke & MJ_HASH) {
+            continue;
+        }
+        state_set("A", false);
+        transform_add(stroke);
+        state_add();
+        if (stroke % 7 == 0) {
+            state_set("YU", true);
+            transform_add(stroke);
+            state_add();
+        }
+        if (per_stroke) {
+            char id[MEJIRO_STROKE_STR_MAX];
+            mejiro_stroke_to_string(stroke, id, sizeof(id));
+            printf("%06x %-26s %016llx\n", (unsigned)stroke, id, (unsigned long long)digest);
+            digest = 1469598103934665603ULL;
+        }
+    }
+    return digest;
+}
+
+int main(int argc, char **argv) {
+#ifndef MEJIRO_TRANSFORM_OLD
+    mejiro_tables_init();
+#endif
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        roma_bench();
+        transform_bench();
+        return 0;
+    }
+    if (argc > 1) {
+        transform_block((mejiro_stroke_t)strtoul(argv[1], NULL, 16) & ~0xFFFFu, true);
+        return 0;
+    }
+    for (mejiro_stroke_t block = 0; block <= MJ_STROKE_ALL; block += 0x10000) {
+        printf("%06x %016llx\n", (unsigned)block, (unsigned long long)transform_block(block, false));
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Unicode input sessions (user-017).
+ *
+ * The #-IAUt and #-TKNYt commands send "……" and "――" through
+ * input_unicode_string. For each OS mode the keys the host gets are compared
+ * press by press with one session for the whole string: macOS switches to
+ * Unicode Hex Input once and holds Option across every digit, Linux chains
+ * Ctrl+Shift+U (the next one commits the code point before it), Windows
+ * (WinCompose) still needs one compose per code point. iOS sends nothing.
+ * Outside the BMP macOS types a surrogate pair and the others the code point.
+ * Digits are paced by CONFIG_NAGINATA_UNICODE_DIGIT_DELAY_MS.
+ */
+#include <stdio.h>
+
+#include "behaviors/behavior_naginata.c"
+
+#include "host_test.h"
+
+#define CSU LC(LS(U))
+
+static void session_begin(uint8_t os) {
+    host_run_all();
+    host_reset_events();
+    naginata_config.os = os;
+}
+
+static void run(uint8_t os, const char *stroke) {
+    session_begin(os);
+    process_mejiro_stroke_local(mejiro_stroke_from_string(stroke));
+    host_run_all();
+}
+
+static bool presses_are(const uint32_t *want, size_t n) {
+    size_t k = 0;
+    for (size_t i = 0; i < host_event_count; i++) {
+        if (!host_events[i].pressed) {
+            continue;
+        }
+        if (k >= n || host_events[i].keycode != want[k]) {
+            fprintf(stderr, "press %zu: %08x, want %08x\n", k, host_events[i].keycode,
+                    k < n ? want[k] : 0);
+            return false;
+        }
+        k++;
+    }
+    if (k != n) {
+        fprintf(stderr, "%zu presses, want %zu\n", k, n);
+        return false;
+    }
+    return true;
+}
+
+static bool is_digit(uint32_t keycode) {
+    const uint16_t usage = ZMK_HID_USAGE_ID(keycode);
+    return SELECT_MODS(keycode) == 0 &&
+           ((usage >= HID_USAGE_KEY_KEYBOARD_1_AND_EXCLAMATION &&
+             usage <= HID_USAGE_KEY_KEYBOARD_0_AND_RIGHT_PARENTHESIS) ||
+            (usage >= HID_USAGE_KEY_KEYBOARD_A && usage <= HID_USAGE_KEY_KEYBOARD_F));
+}
+
+/* Digits of one code point at least the digit delay apart. */
+static bool digits_paced(void) {
+    int64_t last = -1;
+    for (size_t i = 0; i < host_event_count; i++) {
+        if (!host_events[i].pressed) {
+            continue;
+        }
+        if (!is_digit(host_events[i].keycode)) {
+            last = -1;
+            continue;
+        }
+        if (last >= 0 && host_events[i].ms - last < CONFIG_NAGINATA_UNICODE_DIGIT_DELAY_MS) {
+            return false;
+        }
+        last = host_events[i].ms;
+    }
+    return true;
+}
+
+/* Option goes down once, before the first digit, and up after the last one. */
+static bool option_held_across_digits(void) {
+    int downs = 0;
+    int64_t down = -1, up = -1, first = -1, last = -1;
+    for (size_t i = 0; i < host_event_count; i++) {
+        const struct host_event *ev = &host_events[i];
+        if (ev->keycode == LEFT_ALT) {
+            downs += ev->pressed;
+            if (ev->pressed) {
+                down = (int64_t)i;
+            } else {
+                up = (int64_t)i;
+            }
+        } else if (ev->pressed && is_digit(ev->keycode)) {
+            first = first < 0 ? (int64_t)i : first;
+            last = (int64_t)i;
+        }
+    }
+    return downs == 1 && down >= 0 && down < first && up > last;
+}
+
+static void test_macos(void) {
+    const uint32_t leaders[] = {LANG2, LC(F20), LEFT_ALT, N2, N0, N2, N6,
+                                N2,    N0,      N2,       N6, LS(LANG1), LANG1};
+    const uint32_t bars[] = {LANG2, LC(F20), LEFT_ALT, N2, N0, N1, N5,
+                             N2,    N0,      N1,       N5, LS(LANG1), LANG1};
+    /* U+20BB7 as D842 DFB7 */
+    const uint32_t astral[] = {LANG2, LC(F20), LEFT_ALT, D, N8, N4, N2,
+                               D,     F,       B,        N7, LS(LANG1), LANG1};
+
+    run(NG_MACOS, "#-IAUt");
+    CHECK(presses_are(leaders, ARRAY_SIZE(leaders)));
+    CHECK(option_held_across_digits());
+    CHECK(digits_paced());
+    CHECK(host_keys_up());
+
+    run(NG_MACOS, "#-TKNYt");
+    CHECK(presses_are(bars, ARRAY_SIZE(bars)));
+
+    session_begin(NG_MACOS);
+    input_unicode_string("\xF0\xA0\xAE\xB7");
+    host_run_all();
+    CHECK(presses_are(astral, ARRAY_SIZE(astral)));
+    CHECK(option_held_across_digits());
+}
+
+static void test_linux(void) {
+    const uint32_t leaders[] = {CSU, N2, N0, N2, N6, CSU, N2, N0, N2, N6, CSU, ENTER};
+    const uint32_t astral[] = {CSU, N2, N0, B, B, N7, CSU, ENTER};
+
+    run(NG_LINUX, "#-IAUt");
+    CHECK(presses_are(leaders, ARRAY_SIZE(leaders)));
+    CHECK(digits_paced());
+    CHECK(host_keys_up());
+
+    session_begin(NG_LINUX);
+    input_unicode_string("\xF0\xA0\xAE\xB7");
+    host_run_all();
+    CHECK(presses_are(astral, ARRAY_SIZE(astral)));
+}
+
+static void test_windows(void) {
+    const uint32_t leaders[] = {RIGHT_ALT, U, N2, N0, N2, N6, ENTER,
+                                RIGHT_ALT, U, N2, N0, N2, N6, ENTER, ENTER};
+
+    run(NG_WINDOWS, "#-IAUt");
+    CHECK(presses_are(leaders, ARRAY_SIZE(leaders)));
+    CHECK(digits_paced());
+    CHECK(host_keys_up());
+}
+
+static void test_ios(void) {
+    run(NG_IOS, "#-IAUt");
+    CHECK(host_event_count == 0);
+}
+
+int main(void) {
+    mejiro_tables_init();
+    naginata_emit_init();
+
+    test_macos();
+    test_linux();
+    test_windows();
+    test_ios();
+
+    if (host_failures > 0) {
+        fprintf(stderr, "test_unicode: %d failed\n", host_failures);
+        return 1;
+    }
+    printf("test_unicode: ok\n");
+    return 0;
+}